@@ -0,0 +1,217 @@
+#ifndef BACKUP_H
+#define BACKUP_H
+
+#include "Journal.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace BLL {
+
+// The students and groups of one journal frozen at the same instant.
+struct JournalSnapshot {
+    std::string name;
+    std::vector<Student> students;
+    std::vector<Group> groups;
+};
+
+struct BackupResult {
+    std::string path;
+    size_t journals = 0;
+    size_t students = 0;
+    size_t groups = 0;
+    uint64_t bytes = 0;
+    double snapshotMilliseconds = 0.0;
+    double writeMilliseconds = 0.0;
+};
+
+// Online backup of every journal in a set. The snapshot copies the
+// in-memory collections between two requests, which is a consistent point
+// across students and groups because the services are only modified from
+// the thread that takes it. Serializing, writing and fsyncing the copy run
+// on a background thread, but the copy itself is a deep copy of every
+// student and group, O(n) in the size of all journals, and blocks the
+// caller (the console, or the server's poll loop) until it is done;
+// BackupResult::snapshotMilliseconds reports how long that was.
+//
+// A backup file is one JSON document:
+//   {"format":"gradejournal-backup","version":2,"createdAt":<unix seconds>,
+//    "journals":[{"name":..,"groups":[..],"students":[..]}]}
+// written to "<path>.tmp" and renamed into place once it is on disk.
+// Students refer to their group by id; version 1 files, where they named
+// it, are still read and given ids the same way a journal's files are.
+class OnlineBackup {
+private:
+    std::mutex mutex;
+    std::thread writer;
+    std::shared_future<BackupResult> current;
+
+    static bool IsPending(const std::shared_future<BackupResult>& backup) {
+        return backup.valid() && backup.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+    }
+
+    template<typename T>
+    static void WriteArray(std::ostream& out, const std::vector<T>& items) {
+        out << '[';
+        for (size_t i = 0; i < items.size(); ++i) {
+            if (i > 0) out << ',';
+            out << '\n' << items[i].ToJson().dump();
+        }
+        out << ']';
+    }
+
+public:
+    static constexpr const char* Format = "gradejournal-backup";
+    static constexpr int Version = 2;
+
+    OnlineBackup() = default;
+    OnlineBackup(const OnlineBackup&) = delete;
+    OnlineBackup& operator=(const OnlineBackup&) = delete;
+
+    ~OnlineBackup() {
+        if (writer.joinable()) {
+            writer.join();
+        }
+    }
+
+    static std::vector<JournalSnapshot> Snapshot(const JournalSet& journals) {
+        static Diagnostics::OperationSite site("bll.backup.snapshot");
+        Diagnostics::ScopedOperation operation(site);
+        std::vector<JournalSnapshot> snapshot;
+        for (const auto& name : journals.GetNames()) {
+            auto journal = journals.Get(name);
+            snapshot.push_back(JournalSnapshot{name, journal->students->View(), journal->groups->View()});
+        }
+        return snapshot;
+    }
+
+    static BackupResult Write(const std::vector<JournalSnapshot>& snapshot, const std::string& path) {
+        static Diagnostics::OperationSite site("bll.backup.write");
+        Diagnostics::ScopedOperation operation(site);
+        auto start = std::chrono::steady_clock::now();
+        std::string temporary = path + ".tmp";
+        BackupResult result;
+        result.path = path;
+        {
+            std::ofstream out(temporary, std::ios::trunc);
+            if (!out.is_open()) {
+                throw BusinessLogicException("Cannot open backup file for writing: " + temporary);
+            }
+            auto createdAt = std::chrono::duration_cast<std::chrono::seconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            out << "{\"format\":\"" << Format << "\",\"version\":" << Version
+                << ",\"createdAt\":" << createdAt << ",\"journals\":[";
+            for (size_t j = 0; j < snapshot.size(); ++j) {
+                const JournalSnapshot& journal = snapshot[j];
+                out << (j > 0 ? "," : "") << "\n{\"name\":" << json(journal.name).dump() << ",\"groups\":";
+                WriteArray(out, journal.groups);
+                out << ",\"students\":";
+                WriteArray(out, journal.students);
+                out << '}';
+                result.students += journal.students.size();
+                result.groups += journal.groups.size();
+            }
+            out << "]}\n";
+            result.bytes = static_cast<uint64_t>(out.tellp());
+            if (!out.good()) {
+                throw BusinessLogicException("Error writing backup file: " + temporary);
+            }
+        }
+        try {
+            DAL::SyncFile(temporary);
+            DAL::IoStats::AddBytesWritten(result.bytes);
+            std::filesystem::rename(temporary, path);
+        } catch (const std::exception& e) {
+            throw BusinessLogicException("Failed to complete backup " + path + ": " + e.what());
+        }
+        result.journals = snapshot.size();
+        result.writeMilliseconds = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+
+    static std::vector<JournalSnapshot> Read(const std::string& path) {
+        std::ifstream in(path);
+        if (!in.is_open()) {
+            throw BusinessLogicException("Cannot open backup file: " + path);
+        }
+        json document;
+        try {
+            in >> document;
+        } catch (const json::exception& e) {
+            throw BusinessLogicException("Invalid backup file " + path + ": " + e.what());
+        }
+        int version = document.value("version", 0);
+        if (document.value("format", "") != Format || version < 1 || version > Version) {
+            throw BusinessLogicException(path + " is not a version 1 to " + std::to_string(Version) + " backup");
+        }
+        std::vector<JournalSnapshot> snapshot;
+        for (const auto& entry : document.at("journals")) {
+            JournalSnapshot journal{entry.at("name").get<std::string>(), {}, {}};
+            for (const auto& group : entry.at("groups")) {
+                journal.groups.push_back(Group::FromJson(group));
+            }
+            for (const auto& student : entry.at("students")) {
+                journal.students.push_back(Student::FromJson(student));
+            }
+            if (version == 1) {
+                auto groups = std::make_shared<GroupService>(
+                    std::make_shared<DAL::MemoryStorage<Group>>(std::move(journal.groups)));
+                StudentService students(std::make_shared<DAL::MemoryStorage<Student>>(std::move(journal.students)),
+                                        groups);
+                journal.students = students.GetAll();
+                journal.groups = groups->GetAll();
+            }
+            snapshot.push_back(std::move(journal));
+        }
+        return snapshot;
+    }
+
+    // Takes the snapshot on the calling thread, blocking it for the whole
+    // copy, and returns once it is taken; the returned future completes when
+    // the file is on disk. Only one backup runs at a time.
+    std::shared_future<BackupResult> Start(const JournalSet& journals, const std::string& path) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (IsPending(current)) {
+            throw BusinessLogicException("A backup is already running");
+        }
+        if (writer.joinable()) {
+            writer.join();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        auto snapshot = std::make_shared<std::vector<JournalSnapshot>>(Snapshot(journals));
+        double snapshotMilliseconds = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+
+        std::packaged_task<BackupResult()> task([snapshot, path, snapshotMilliseconds]() {
+            BackupResult result = Write(*snapshot, path);
+            result.snapshotMilliseconds = snapshotMilliseconds;
+            return result;
+        });
+        current = task.get_future().share();
+        writer = std::thread(std::move(task));
+        return current;
+    }
+
+    bool Running() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return IsPending(current);
+    }
+
+    // The most recent backup, finished or not; invalid before the first one.
+    std::shared_future<BackupResult> Last() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return current;
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,154 @@
+#ifndef GROUPREPORT_H
+#define GROUPREPORT_H
+
+#include "Services.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <future>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace BLL {
+
+enum class GroupAttribute {
+    Name,
+    Specialization,
+    Year
+};
+
+inline const char* GroupAttributeName(GroupAttribute attribute) {
+    switch (attribute) {
+        case GroupAttribute::Specialization: return "specialization";
+        case GroupAttribute::Year: return "year";
+        default: return "group";
+    }
+}
+
+// Students whose group has no record in the GroupService are reported
+// under this key instead of being dropped.
+inline const std::string UnknownGroupKey = "(no group record)";
+
+struct GroupReportRow {
+    std::string key;
+    size_t groups = 0;
+    size_t students = 0;
+    size_t grades = 0;
+    // Mean of the students' average grades, students without grades counting
+    // as 0, the same definition as StudentService::CalculateGroupAverageGrade.
+    double averageGrade = 0.0;
+};
+
+// Joins students to their groups and aggregates per group attribute in one
+// pass. The build side maps every group id to a dense key index; since
+// GroupService hands out ids sequentially from 1 the "hash table" is a
+// plain array indexed by id. The probe side scans the students in one
+// chunk per pool worker, each filling its own accumulators, which are
+// summed at the end.
+class GroupReport {
+private:
+    struct Accumulator {
+        size_t students = 0;
+        size_t grades = 0;
+        double averageSum = 0.0;
+    };
+
+    static std::string KeyOf(const Group& group, GroupAttribute attribute) {
+        switch (attribute) {
+            case GroupAttribute::Specialization: return group.GetSpecialization();
+            case GroupAttribute::Year: return std::to_string(group.GetYear());
+            default: return group.GetName();
+        }
+    }
+
+    static std::vector<Accumulator> Probe(const std::vector<Student>& students, size_t begin, size_t end,
+                                          const std::vector<int>& keyOfGroup, size_t keyCount) {
+        std::vector<Accumulator> totals(keyCount + 1);
+        for (size_t i = begin; i < end; ++i) {
+            const Student& student = students[i];
+            size_t groupId = static_cast<size_t>(student.GetGroupId());
+            size_t key = groupId < keyOfGroup.size() && keyOfGroup[groupId] >= 0
+                ? static_cast<size_t>(keyOfGroup[groupId]) : keyCount;
+            Accumulator& total = totals[key];
+            ++total.students;
+            total.grades += student.GetGradeCount();
+            total.averageSum += student.CalculateAverageGrade();
+        }
+        return totals;
+    }
+
+public:
+    // Rows are sorted by key, with the unknown-group row last; the pool may
+    // be null for a single-threaded scan.
+    static std::vector<GroupReportRow> Build(const StudentService& studentService, const GroupService& groupService,
+                                             GroupAttribute attribute, ThreadPool* pool = nullptr) {
+        static Diagnostics::OperationSite site("bll.report.by_group");
+        Diagnostics::ScopedOperation operation(site);
+
+        std::vector<GroupReportRow> rows;
+        std::unordered_map<std::string, int> keys;
+        std::vector<int> keyOfGroup;
+        for (const Group& group : groupService.View()) {
+            std::string key = KeyOf(group, attribute);
+            auto inserted = keys.emplace(key, static_cast<int>(rows.size()));
+            if (inserted.second) {
+                rows.push_back(GroupReportRow{key});
+            }
+            size_t id = static_cast<size_t>(group.GetId());
+            if (id >= keyOfGroup.size()) {
+                keyOfGroup.resize(id + 1, -1);
+            }
+            keyOfGroup[id] = inserted.first->second;
+            ++rows[static_cast<size_t>(inserted.first->second)].groups;
+        }
+
+        const std::vector<Student>& students = studentService.View();
+        size_t keyCount = rows.size();
+        size_t chunks = pool ? std::min(pool->Size(), std::max<size_t>(1, students.size() / 4096)) : 1;
+        std::vector<Accumulator> totals;
+        if (chunks <= 1) {
+            totals = Probe(students, 0, students.size(), keyOfGroup, keyCount);
+        } else {
+            std::vector<std::future<std::vector<Accumulator>>> pending;
+            size_t step = (students.size() + chunks - 1) / chunks;
+            for (size_t begin = 0; begin < students.size(); begin += step) {
+                size_t end = std::min(students.size(), begin + step);
+                pending.push_back(pool->Submit([&students, &keyOfGroup, begin, end, keyCount]() {
+                    return Probe(students, begin, end, keyOfGroup, keyCount);
+                }));
+            }
+            totals.assign(keyCount + 1, Accumulator{});
+            for (auto& future : pending) {
+                auto partial = future.get();
+                for (size_t k = 0; k <= keyCount; ++k) {
+                    totals[k].students += partial[k].students;
+                    totals[k].grades += partial[k].grades;
+                    totals[k].averageSum += partial[k].averageSum;
+                }
+            }
+        }
+
+        for (size_t k = 0; k < keyCount; ++k) {
+            rows[k].students = totals[k].students;
+            rows[k].grades = totals[k].grades;
+            rows[k].averageGrade = totals[k].students == 0 ? 0.0 : totals[k].averageSum / totals[k].students;
+        }
+        std::sort(rows.begin(), rows.end(), [attribute](const GroupReportRow& a, const GroupReportRow& b) {
+            if (attribute == GroupAttribute::Year) {
+                return std::stoi(a.key) < std::stoi(b.key);
+            }
+            return a.key < b.key;
+        });
+
+        const Accumulator& unknown = totals[keyCount];
+        if (unknown.students > 0) {
+            rows.push_back(GroupReportRow{UnknownGroupKey, 0, unknown.students, unknown.grades,
+                                          unknown.averageSum / unknown.students});
+        }
+        return rows;
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,210 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include "Services.h"
+#include "ThreadPool.h"
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace BLL {
+
+class JournalNotFoundException : public BusinessLogicException {
+public:
+    explicit JournalNotFoundException(const std::string& message)
+        : BusinessLogicException(message) {}
+};
+
+struct Journal {
+    std::string name;
+    std::shared_ptr<StudentService> students;
+    std::shared_ptr<GroupService> groups;
+};
+
+struct JournalStudent {
+    std::string journal;
+    Student student;
+    std::string groupName;
+};
+
+template<typename T>
+using StorageProvider = std::function<std::shared_ptr<DAL::IDataStorage<T>>(const std::string& path)>;
+
+// A named set of independent journals sharing one worker pool. Each journal
+// lives in its own subdirectory with students.json and groups.json.
+class JournalSet {
+private:
+    std::map<std::string, std::shared_ptr<Journal>> journals;
+    std::shared_ptr<ThreadPool> pool;
+
+    template<typename F>
+    auto FanOut(F perJournal) const -> std::vector<decltype(perJournal(std::declval<const Journal&>()))> {
+        using Result = decltype(perJournal(std::declval<const Journal&>()));
+        std::vector<std::future<Result>> pending;
+        pending.reserve(journals.size());
+        for (const auto& entry : journals) {
+            const Journal* journal = entry.second.get();
+            pending.push_back(pool->Submit([journal, &perJournal]() { return perJournal(*journal); }));
+        }
+
+        for (auto& future : pending) {
+            future.wait();
+        }
+
+        std::vector<Result> results;
+        results.reserve(pending.size());
+        for (auto& future : pending) {
+            results.push_back(future.get());
+        }
+        return results;
+    }
+
+    template<typename F>
+    std::vector<JournalStudent> Gather(F query) const {
+        auto perJournal = FanOut([&query](const Journal& journal) {
+            std::vector<JournalStudent> found;
+            for (auto& student : query(*journal.students)) {
+                std::string groupName = journal.students->GroupName(student);
+                found.push_back(JournalStudent{journal.name, std::move(student), std::move(groupName)});
+            }
+            return found;
+        });
+
+        std::vector<JournalStudent> result;
+        for (auto& found : perJournal) {
+            std::move(found.begin(), found.end(), std::back_inserter(result));
+        }
+        return result;
+    }
+
+public:
+    explicit JournalSet(std::shared_ptr<ThreadPool> workers = std::make_shared<ThreadPool>())
+        : pool(std::move(workers)) {}
+
+    // Loads every subdirectory of `directory` as a journal. Journals are
+    // loaded concurrently on the pool, each one's groups before its students.
+    static std::shared_ptr<JournalSet> Open(const std::string& directory,
+                                            StorageProvider<Student> studentStorage,
+                                            StorageProvider<Group> groupStorage,
+                                            std::shared_ptr<ThreadPool> workers = std::make_shared<ThreadPool>()) {
+        Diagnostics::TraceSpan span("bll.journals.open");
+        namespace fs = std::filesystem;
+        std::error_code error;
+        if (!fs::is_directory(directory, error)) {
+            throw BusinessLogicException("Journal directory '" + directory + "' does not exist");
+        }
+
+        std::vector<fs::path> paths;
+        for (const auto& entry : fs::directory_iterator(directory)) {
+            if (entry.is_directory()) {
+                paths.push_back(entry.path());
+            }
+        }
+        if (paths.empty()) {
+            throw BusinessLogicException("No journals found in '" + directory + "'");
+        }
+
+        auto set = std::make_shared<JournalSet>(workers);
+        std::vector<std::future<std::shared_ptr<StudentService>>> students;
+        for (const auto& path : paths) {
+            std::string studentsPath = (path / "students.json").string();
+            std::string groupsPath = (path / "groups.json").string();
+            students.push_back(workers->Submit([studentStorage, groupStorage, studentsPath, groupsPath]() {
+                auto groups = std::make_shared<GroupService>(groupStorage(groupsPath));
+                return std::make_shared<StudentService>(studentStorage(studentsPath), groups);
+            }));
+        }
+
+        std::string failures;
+        for (size_t i = 0; i < paths.size(); ++i) {
+            std::string name = paths[i].filename().string();
+            try {
+                set->Add(name, students[i].get());
+            } catch (const std::exception& e) {
+                failures += "\n  " + name + ": " + e.what();
+            }
+        }
+        if (!failures.empty()) {
+            throw BusinessLogicException("Failed to open journals:" + failures);
+        }
+        return set;
+    }
+
+    // The journal's groups are the ones the student service resolves its
+    // group ids through.
+    void Add(const std::string& name, std::shared_ptr<StudentService> students) {
+        if (journals.count(name) > 0) {
+            throw DuplicateEntityException("Journal '" + name + "' already exists");
+        }
+        auto groups = students->Groups();
+        journals[name] = std::make_shared<Journal>(Journal{name, std::move(students), std::move(groups)});
+    }
+
+    std::shared_ptr<Journal> Get(const std::string& name) const {
+        auto it = journals.find(name);
+        if (it == journals.end()) {
+            throw JournalNotFoundException("Journal '" + name + "' not found");
+        }
+        return it->second;
+    }
+
+    std::shared_ptr<Journal> First() const {
+        if (journals.empty()) {
+            throw JournalNotFoundException("No journals are open");
+        }
+        return journals.begin()->second;
+    }
+
+    std::vector<std::string> GetNames() const {
+        std::vector<std::string> names;
+        for (const auto& entry : journals) {
+            names.push_back(entry.first);
+        }
+        return names;
+    }
+
+    size_t Count() const {
+        return journals.size();
+    }
+
+    ThreadPool& Pool() const {
+        return *pool;
+    }
+
+    std::vector<JournalStudent> FindByName(const std::string& firstName,
+                                           const std::string& lastName) const {
+        return Gather([&](const StudentService& service) {
+            return service.FindByName(firstName, lastName);
+        });
+    }
+
+    std::vector<JournalStudent> FindByGroup(const std::string& groupName) const {
+        return Gather([&](const StudentService& service) {
+            return service.FindByGroup(groupName);
+        });
+    }
+
+    std::vector<JournalStudent> FindByAverageGrade(double minAverage, double maxAverage) const {
+        return Gather([&](const StudentService& service) {
+            return service.FindByAverageGrade(minAverage, maxAverage);
+        });
+    }
+
+    size_t TotalStudents() const {
+        size_t total = 0;
+        for (size_t count : FanOut([](const Journal& journal) { return journal.students->Count(); })) {
+            total += count;
+        }
+        return total;
+    }
+};
+
+}
+
+#endif
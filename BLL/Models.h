@@ -1,10 +1,15 @@
 #ifndef MODELS_H
 #define MODELS_H
 
+#include <deque>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
 #include <nlohmann/json.hpp>
 
 using json = nlohmann::json;
@@ -45,6 +50,12 @@ public:
     std::string GetSubject() const { return subject; }
     int GetScore() const { return score; }
 
+    // Heap bytes beyond sizeof(Grade); short subjects fit the string's
+    // inline buffer.
+    size_t HeapBytes() const {
+        return subject.capacity() >= sizeof(std::string) ? subject.capacity() + 1 : 0;
+    }
+
     void SetScore(int sc) {
         ValidateScore(sc);
         score = sc;
@@ -57,6 +68,8 @@ public:
         };
     }
 
+    bool operator==(const Grade& other) const = default;
+
     static Grade FromJson(const json& j) {
         return Grade(
             j.value("subject", ""),
@@ -65,12 +78,58 @@ public:
     }
 };
 
+// Group names read from student records written before groups had ids.
+// Student::FromJson gives each such name a provisional negative id, which
+// StudentService replaces with its GroupService's id for the name when it
+// loads the records and then rewrites them. Nothing else uses these ids.
+class LegacyGroupNames {
+private:
+    mutable std::shared_mutex mutex;
+    std::deque<std::string> names;
+    std::unordered_map<std::string_view, int> ids;
+
+public:
+    static LegacyGroupNames& Instance() {
+        static LegacyGroupNames table;
+        return table;
+    }
+
+    static bool IsProvisional(int groupId) {
+        return groupId < 0;
+    }
+
+    // 0, the "no group" id, for an empty name.
+    int Provisional(const std::string& name) {
+        if (name.empty()) {
+            return 0;
+        }
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        auto it = ids.find(name);
+        if (it != ids.end()) {
+            return it->second;
+        }
+        int id = -static_cast<int>(names.size()) - 1;
+        names.push_back(name);
+        ids.emplace(names.back(), id);
+        return id;
+    }
+
+    std::string Name(int groupId) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        size_t index = static_cast<size_t>(-static_cast<int64_t>(groupId) - 1);
+        if (groupId >= 0 || index >= names.size()) {
+            throw std::out_of_range("Unknown provisional group id " + std::to_string(groupId));
+        }
+        return names[index];
+    }
+};
+
 class Student : public IIdentifiable, public IGradeCalculator {
 private:
     int id;
     std::string firstName;
     std::string lastName;
-    std::string groupName;
+    int groupId;
     std::vector<Grade> grades;
 
     void ValidateName(const std::string& name, const std::string& fieldName) const {
@@ -80,11 +139,12 @@ private:
     }
 
 public:
-    Student() : id(0), firstName(""), lastName(""), groupName("") {}
+    Student() : id(0), firstName(""), lastName(""), groupId(0) {}
 
-    Student(int studentId, const std::string& first, const std::string& last,
-            const std::string& group)
-        : id(studentId), firstName(first), lastName(last), groupName(group) {
+    // `group` is the id GroupService assigned to the student's group; 0 is
+    // no group.
+    Student(int studentId, const std::string& first, const std::string& last, int group = 0)
+        : id(studentId), firstName(first), lastName(last), groupId(group) {
         ValidateName(first, "First name");
         ValidateName(last, "Last name");
     }
@@ -92,13 +152,38 @@ public:
     int GetId() const override { return id; }
     std::string GetFirstName() const { return firstName; }
     std::string GetLastName() const { return lastName; }
-    std::string GetGroupName() const { return groupName; }
+    int GetGroupId() const { return groupId; }
     std::vector<Grade> GetGrades() const { return grades; }
+    size_t GetGradeCount() const { return grades.size(); }
 
     std::string GetFullName() const {
         return firstName + " " + lastName;
     }
 
+    // What StudentService treats as a duplicate: the same name in the same
+    // group.
+    static std::string DuplicateKey(const std::string& first, const std::string& last, int group) {
+        return first + '\x1f' + last + '\x1f' + std::to_string(group);
+    }
+
+    std::string DuplicateKey() const {
+        return DuplicateKey(firstName, lastName, groupId);
+    }
+
+    // Approximate bytes held by this student, for storage memory budgets.
+    size_t MemoryUsage() const {
+        size_t bytes = sizeof(Student) + grades.capacity() * sizeof(Grade);
+        for (const std::string* name : {&firstName, &lastName}) {
+            if (name->capacity() >= sizeof(std::string)) {
+                bytes += name->capacity() + 1;
+            }
+        }
+        for (const auto& grade : grades) {
+            bytes += grade.HeapBytes();
+        }
+        return bytes;
+    }
+
     void SetFirstName(const std::string& name) {
         ValidateName(name, "First name");
         firstName = name;
@@ -109,8 +194,8 @@ public:
         lastName = name;
     }
 
-    void SetGroupName(const std::string& group) {
-        groupName = group;
+    void SetGroupId(int group) {
+        groupId = group;
     }
 
     void AddGrade(const Grade& grade) {
@@ -167,7 +252,7 @@ public:
             {"id", id},
             {"firstName", firstName},
             {"lastName", lastName},
-            {"groupName", groupName},
+            {"groupId", groupId},
             {"grades", json::array()}
         };
         for (const auto& grade : grades) {
@@ -176,12 +261,20 @@ public:
         return j;
     }
 
+    bool operator==(const Student& other) const {
+        return id == other.id && groupId == other.groupId && firstName == other.firstName &&
+               lastName == other.lastName && grades == other.grades;
+    }
+
     static Student FromJson(const json& j) {
+        int group = j.contains("groupId")
+            ? j.value("groupId", 0)
+            : LegacyGroupNames::Instance().Provisional(j.value("groupName", ""));
         Student student(
             j.value("id", 0),
             j.value("firstName", ""),
             j.value("lastName", ""),
-            j.value("groupName", "")
+            group
         );
         if (j.contains("grades") && j["grades"].is_array()) {
             for (const auto& gradeJson : j["grades"]) {
@@ -194,6 +287,7 @@ public:
 
 class Group {
 private:
+    int id;
     std::string name;
     std::string specialization;
     int year;
@@ -211,20 +305,36 @@ private:
     }
 
 public:
-    Group() : name(""), specialization(""), year(0) {}
+    Group() : id(0), name(""), specialization(""), year(0) {}
 
+    // Id 0 until GroupService assigns one.
     Group(const std::string& groupName, const std::string& spec, int y)
-        : name(groupName), specialization(spec), year(y) {
+        : Group(0, groupName, spec, y) {}
+
+    Group(int groupId, const std::string& groupName, const std::string& spec, int y)
+        : id(groupId), name(groupName), specialization(spec), year(y) {
         ValidateName(groupName);
         if (y > 0) {
             ValidateYear(y);
         }
     }
 
-    std::string GetName() const { return name; }
+    // Assigned by GroupService and stored by its students; stays the same
+    // when the group is renamed.
+    int GetId() const { return id; }
+    const std::string& GetName() const { return name; }
     std::string GetSpecialization() const { return specialization; }
     int GetYear() const { return year; }
 
+    void SetId(int groupId) {
+        id = groupId;
+    }
+
+    void SetName(const std::string& groupName) {
+        ValidateName(groupName);
+        name = groupName;
+    }
+
     void SetSpecialization(const std::string& spec) {
         specialization = spec;
     }
@@ -238,14 +348,21 @@ public:
 
     json ToJson() const {
         return json{
+            {"id", id},
             {"name", name},
             {"specialization", specialization},
             {"year", year}
         };
     }
 
+    bool operator==(const Group& other) const {
+        return id == other.id && name == other.name && specialization == other.specialization &&
+               year == other.year;
+    }
+
     static Group FromJson(const json& j) {
         return Group(
+            j.value("id", 0),
             j.value("name", ""),
             j.value("specialization", ""),
             j.value("year", 0)
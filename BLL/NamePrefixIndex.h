@@ -0,0 +1,181 @@
+#ifndef NAMEPREFIXINDEX_H
+#define NAMEPREFIXINDEX_H
+
+#include "Models.h"
+#include <algorithm>
+#include <stop_token>
+#include <string>
+#include <vector>
+
+namespace BLL {
+
+// Lower-cases ASCII and the Cyrillic block (including Ukrainian Ґ, Є, І, Ї)
+// in a UTF-8 string. Other bytes are copied unchanged.
+inline std::string FoldName(const std::string& text) {
+    std::string folded;
+    folded.reserve(text.size());
+    for (size_t i = 0; i < text.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c >= 'A' && c <= 'Z') {
+            folded.push_back(static_cast<char>(c + ('a' - 'A')));
+            continue;
+        }
+        if (i + 1 < text.size()) {
+            unsigned char next = static_cast<unsigned char>(text[i + 1]);
+            if (c == 0xD0 && next >= 0x80 && next <= 0x8F) {
+                folded.push_back(static_cast<char>(0xD1));
+                folded.push_back(static_cast<char>(next + 0x10));
+                ++i;
+                continue;
+            }
+            if (c == 0xD0 && next >= 0x90 && next <= 0x9F) {
+                folded.push_back(static_cast<char>(0xD0));
+                folded.push_back(static_cast<char>(next + 0x20));
+                ++i;
+                continue;
+            }
+            if (c == 0xD0 && next >= 0xA0 && next <= 0xAF) {
+                folded.push_back(static_cast<char>(0xD1));
+                folded.push_back(static_cast<char>(next - 0x20));
+                ++i;
+                continue;
+            }
+            if (c == 0xD2 && next == 0x90) {
+                folded.push_back(static_cast<char>(0xD2));
+                folded.push_back(static_cast<char>(0x91));
+                ++i;
+                continue;
+            }
+        }
+        folded.push_back(static_cast<char>(c));
+    }
+    return folded;
+}
+
+// Sorted arrays of folded first and last names. A prefix maps to a contiguous
+// range found with two binary searches, so a lookup costs O(log n) plus the
+// number of entries actually returned. Positions refer to the vector the
+// index was built from and are invalidated by any change to it.
+class NamePrefixIndex {
+private:
+    struct Entry {
+        std::string key;
+        std::string otherKey;
+        size_t position;
+    };
+
+    std::vector<Entry> byFirstName;
+    std::vector<Entry> byLastName;
+
+    using Iterator = std::vector<Entry>::const_iterator;
+
+    static std::pair<Iterator, Iterator> PrefixRange(const std::vector<Entry>& entries,
+                                                     const std::string& prefix) {
+        auto less = [](const Entry& e, const std::string& key) { return e.key < key; };
+        auto begin = std::lower_bound(entries.begin(), entries.end(), prefix, less);
+        if (prefix.empty()) {
+            return {begin, entries.end()};
+        }
+
+        std::string upper = prefix;
+        while (!upper.empty() && static_cast<unsigned char>(upper.back()) == 0xFF) {
+            upper.pop_back();
+        }
+        if (upper.empty()) {
+            return {begin, entries.end()};
+        }
+        upper.back() = static_cast<char>(static_cast<unsigned char>(upper.back()) + 1);
+        auto end = std::lower_bound(begin, entries.end(), upper, less);
+        return {begin, end};
+    }
+
+    static bool StartsWith(const std::string& text, const std::string& prefix) {
+        return text.compare(0, prefix.size(), prefix) == 0;
+    }
+
+public:
+    struct Match {
+        std::vector<size_t> positions;
+        size_t candidates = 0;
+    };
+
+    void Build(const std::vector<Student>& students) {
+        byFirstName.clear();
+        byLastName.clear();
+        byFirstName.reserve(students.size());
+        byLastName.reserve(students.size());
+        for (size_t i = 0; i < students.size(); ++i) {
+            std::string first = FoldName(students[i].GetFirstName());
+            std::string last = FoldName(students[i].GetLastName());
+            byFirstName.push_back(Entry{first, last, i});
+            byLastName.push_back(Entry{std::move(last), std::move(first), i});
+        }
+        auto order = [](const Entry& a, const Entry& b) {
+            return a.key != b.key ? a.key < b.key : a.position < b.position;
+        };
+        std::sort(byFirstName.begin(), byFirstName.end(), order);
+        std::sort(byLastName.begin(), byLastName.end(), order);
+    }
+
+    size_t Size() const { return byFirstName.size(); }
+
+    // Same matching rules as Find, for a single already-folded student name.
+    static bool Matches(const std::string& first, const std::string& last, const std::string& foldedQuery) {
+        size_t space = foldedQuery.find(' ');
+        if (space == std::string::npos) {
+            return StartsWith(first, foldedQuery) || StartsWith(last, foldedQuery);
+        }
+        std::string head = foldedQuery.substr(0, space);
+        std::string tail = foldedQuery.substr(space + 1);
+        return (StartsWith(first, head) && StartsWith(last, tail)) ||
+               (StartsWith(last, head) && StartsWith(first, tail));
+    }
+
+    // "jo" matches first or last names starting with "jo"; "john d" matches
+    // first name "john*" with last name "d*" (or the reverse order).
+    Match Find(const std::string& query, size_t limit, std::stop_token stop = {}) const {
+        Match match;
+        std::string folded = FoldName(query);
+        size_t space = folded.find(' ');
+
+        std::vector<size_t>& out = match.positions;
+        auto seen = [&out](size_t position) {
+            return std::find(out.begin(), out.end(), position) != out.end();
+        };
+
+        if (space == std::string::npos) {
+            auto first = PrefixRange(byFirstName, folded);
+            auto last = PrefixRange(byLastName, folded);
+            match.candidates = static_cast<size_t>((first.second - first.first) + (last.second - last.first));
+            for (auto it = first.first; it != first.second && out.size() < limit; ++it) {
+                if (stop.stop_requested()) return match;
+                out.push_back(it->position);
+            }
+            for (auto it = last.first; it != last.second && out.size() < limit; ++it) {
+                if (stop.stop_requested()) return match;
+                if (!seen(it->position)) {
+                    out.push_back(it->position);
+                }
+            }
+            return match;
+        }
+
+        std::string head = folded.substr(0, space);
+        std::string tail = folded.substr(space + 1);
+        for (const auto* entries : {&byFirstName, &byLastName}) {
+            auto range = PrefixRange(*entries, head);
+            match.candidates += static_cast<size_t>(range.second - range.first);
+            for (auto it = range.first; it != range.second && out.size() < limit; ++it) {
+                if (stop.stop_requested()) return match;
+                if (StartsWith(it->otherKey, tail) && !seen(it->position)) {
+                    out.push_back(it->position);
+                }
+            }
+        }
+        return match;
+    }
+};
+
+}
+
+#endif
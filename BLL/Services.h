@@ -3,10 +3,18 @@
 
 #include "Models.h"
 #include "DataAccess.h"
+#include "NamePrefixIndex.h"
 #include <algorithm>
+#include <atomic>
+#include <functional>
+#include <iterator>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <stdexcept>
 #include <set>
+#include <unordered_map>
+#include <utility>
 
 namespace BLL {
 
@@ -61,14 +69,20 @@ protected:
     std::vector<T> items;
 
     void LoadData() {
+        static Diagnostics::OperationSite site("bll.load");
+        Diagnostics::ScopedOperation operation(site);
         try {
             items = storage->Load();
         } catch (const DAL::DataAccessException& e) {
             throw BusinessLogicException("Failed to load data: " + std::string(e.what()));
         }
+        OnItemsChanged();
     }
 
     void SaveData() {
+        static Diagnostics::OperationSite site("bll.save");
+        Diagnostics::ScopedOperation operation(site);
+        OnItemsChanged();
         try {
             storage->Save(items);
         } catch (const DAL::DataAccessException& e) {
@@ -76,8 +90,44 @@ protected:
         }
     }
 
+    // Persists only `changes`; `items` must already contain them.
+    void SaveChanges(const DAL::ChangeSet<T>& changes) {
+        static Diagnostics::OperationSite site("bll.save_changes");
+        Diagnostics::ScopedOperation operation(site);
+        OnItemsChanged();
+        try {
+            storage->SaveChanges(items, changes);
+        } catch (const DAL::DataAccessException& e) {
+            throw BusinessLogicException("Failed to save data: " + std::string(e.what()));
+        }
+    }
+
+    // Single-record mutations persist only that record, so a WAL storage
+    // appends one entry instead of rewriting its data file.
+    void SaveUpsert(const T& item) {
+        DAL::ChangeSet<T> changes;
+        changes.upserts.push_back(item);
+        SaveChanges(changes);
+    }
+
+    void SaveRemoval(int id) {
+        DAL::ChangeSet<T> changes;
+        changes.removals.push_back(id);
+        SaveChanges(changes);
+    }
+
     virtual void ValidateBeforeSave() {}
 
+    // Called by UpdateWhere for every updated item before anything is
+    // applied; throws to reject the whole update.
+    virtual void ValidateUpdate(const T& before, const T& after) const {
+        if (after.GetId() != before.GetId()) {
+            throw ValidationException("A bulk update cannot change an item's key");
+        }
+    }
+
+    virtual void OnItemsChanged() {}
+
 public:
     explicit BaseService(std::shared_ptr<DAL::IDataStorage<T>> dataStorage)
         : storage(dataStorage) {
@@ -90,6 +140,12 @@ public:
         return items;
     }
 
+    // Read-only access for scans that should not copy every item. The
+    // reference is only valid until the service is next modified.
+    const std::vector<T>& View() const {
+        return items;
+    }
+
     void ClearAll() override {
         items.clear();
         SaveData();
@@ -98,6 +154,92 @@ public:
     size_t Count() const {
         return items.size();
     }
+
+    // Removes every item matching the predicate in one pass, compacting the
+    // container once, and persists the removals as one change set. On a
+    // failed save the removed items are put back in their old places.
+    template<typename Predicate>
+    size_t RemoveWhere(Predicate matches) {
+        static Diagnostics::OperationSite site("bll.remove_where");
+        Diagnostics::ScopedOperation operation(site);
+        std::vector<size_t> positions;
+        std::vector<T> removed;
+        DAL::ChangeSet<T> changes;
+        size_t kept = 0;
+        for (size_t i = 0; i < items.size(); ++i) {
+            if (matches(static_cast<const T&>(items[i]))) {
+                positions.push_back(i);
+                changes.removals.push_back(items[i].GetId());
+                removed.push_back(std::move(items[i]));
+            } else {
+                if (kept != i) {
+                    items[kept] = std::move(items[i]);
+                }
+                ++kept;
+            }
+        }
+        if (removed.empty()) {
+            return 0;
+        }
+        items.resize(kept);
+
+        try {
+            SaveChanges(changes);
+        } catch (...) {
+            items.resize(kept + removed.size());
+            size_t source = kept;
+            size_t next = removed.size();
+            for (size_t target = items.size(); target-- > 0 && next > 0;) {
+                if (positions[next - 1] == target) {
+                    items[target] = std::move(removed[--next]);
+                } else {
+                    items[target] = std::move(items[--source]);
+                }
+            }
+            OnItemsChanged();
+            throw;
+        }
+        return removed.size();
+    }
+
+    // Applies `update` to every item matching the predicate and persists
+    // them as one change set. Every updated copy is validated before the
+    // first one is applied, so an invalid update changes nothing.
+    template<typename Predicate, typename Update>
+    size_t UpdateWhere(Predicate matches, Update update) {
+        static Diagnostics::OperationSite site("bll.update_where");
+        Diagnostics::ScopedOperation operation(site);
+        std::vector<size_t> positions;
+        DAL::ChangeSet<T> changes;
+        for (size_t i = 0; i < items.size(); ++i) {
+            if (matches(static_cast<const T&>(items[i]))) {
+                T updated = items[i];
+                update(updated);
+                ValidateUpdate(items[i], updated);
+                positions.push_back(i);
+                changes.upserts.push_back(std::move(updated));
+            }
+        }
+        if (positions.empty()) {
+            return 0;
+        }
+
+        std::vector<T> previous;
+        previous.reserve(positions.size());
+        for (size_t k = 0; k < positions.size(); ++k) {
+            previous.push_back(std::exchange(items[positions[k]], changes.upserts[k]));
+        }
+        try {
+            SaveChanges(changes);
+        } catch (...) {
+            for (size_t k = 0; k < positions.size(); ++k) {
+                items[positions[k]] = std::move(previous[k]);
+            }
+            OnItemsChanged();
+            throw;
+        }
+        return positions.size();
+    }
 };
 
 class IIdGenerator {
@@ -147,6 +289,215 @@ public:
     }
 };
 
+class IGroupValidator {
+public:
+    virtual ~IGroupValidator() = default;
+    virtual void ValidateGroup(const std::string& name) const = 0;
+};
+
+class GroupValidator : public IGroupValidator {
+public:
+    void ValidateGroup(const std::string& name) const override {
+        if (name.empty()) {
+            throw ValidationException("Group name cannot be empty");
+        }
+        if (name.length() > 20) {
+            throw ValidationException("Group name too long (max 20 characters)");
+        }
+    }
+};
+
+// Owns the groups of a journal and the ids their students refer to. Ids
+// are assigned here, saved with each group and never change, so renaming a
+// group rewrites only its own record.
+class GroupService : public BaseService<Group> {
+private:
+    std::unique_ptr<IGroupValidator> validator;
+    // Name -> id and id -> position in items. Groups are few, so both are
+    // rebuilt whenever items change.
+    std::unordered_map<std::string, int> idsByName;
+    std::unordered_map<int, size_t> positionsById;
+    int nextId = 1;
+    // Set by the StudentService bound to this service, so a group that
+    // still has students is not removed from under them.
+    std::function<size_t(int)> memberCount;
+
+    void RebuildIndex() {
+        idsByName.clear();
+        positionsById.clear();
+        for (size_t i = 0; i < items.size(); ++i) {
+            idsByName[items[i].GetName()] = items[i].GetId();
+            positionsById[items[i].GetId()] = i;
+            nextId = std::max(nextId, items[i].GetId() + 1);
+        }
+    }
+
+    bool IsDuplicate(const std::string& name) const {
+        return idsByName.count(name) > 0;
+    }
+
+    Group& Require(const std::string& name) {
+        auto it = idsByName.find(name);
+        if (it == idsByName.end()) {
+            throw GroupNotFoundException("Group '" + name + "' not found");
+        }
+        return items[positionsById.at(it->second)];
+    }
+
+protected:
+    void OnItemsChanged() override {
+        RebuildIndex();
+    }
+
+public:
+    explicit GroupService(std::shared_ptr<DAL::IDataStorage<Group>> dataStorage)
+        : BaseService(dataStorage),
+          validator(std::make_unique<GroupValidator>()) {
+        // Groups saved before they had ids get one now, written back so it
+        // stays the same on the next load.
+        RebuildIndex();
+        bool assigned = false;
+        for (auto& group : items) {
+            if (group.GetId() <= 0) {
+                group.SetId(nextId++);
+                assigned = true;
+            }
+        }
+        if (assigned) {
+            SaveData();
+        }
+    }
+
+    Group AddGroup(const std::string& name, const std::string& specialization, int year) {
+        static Diagnostics::OperationSite site("bll.group.add");
+        Diagnostics::ScopedOperation operation(site);
+        validator->ValidateGroup(name);
+
+        if (IsDuplicate(name)) {
+            throw DuplicateEntityException("Group with name '" + name + "' already exists");
+        }
+
+        Group group(nextId++, name, specialization, year);
+        items.push_back(group);
+        try {
+            SaveUpsert(group);
+        } catch (...) {
+            items.pop_back();
+            RebuildIndex();
+            throw;
+        }
+        return group;
+    }
+
+    // The id of the group with this name, adding a group without a
+    // specialization or year if there is none. Students may name any group,
+    // so unlike AddGroup the name is not length-checked. 0 for no name.
+    int EnsureGroup(const std::string& name) {
+        if (name.empty()) {
+            return 0;
+        }
+        int id = FindId(name);
+        if (id >= 0) {
+            return id;
+        }
+        Group group(nextId++, name, "", 0);
+        items.push_back(group);
+        try {
+            SaveUpsert(group);
+        } catch (...) {
+            items.pop_back();
+            RebuildIndex();
+            throw;
+        }
+        return group.GetId();
+    }
+
+    // Throws if students are still in the group.
+    void RemoveGroup(const std::string& name) {
+        static Diagnostics::OperationSite site("bll.group.remove");
+        Diagnostics::ScopedOperation operation(site);
+        int groupId = Require(name).GetId();
+        size_t members = memberCount ? memberCount(groupId) : 0;
+        if (members > 0) {
+            throw BusinessLogicException("Group '" + name + "' still has " + std::to_string(members) +
+                                         " students");
+        }
+
+        items.erase(items.begin() + static_cast<std::ptrdiff_t>(positionsById.at(groupId)));
+        SaveRemoval(groupId);
+    }
+
+    void UpdateGroup(const std::string& name, const std::string& specialization, int year) {
+        static Diagnostics::OperationSite site("bll.group.update");
+        Diagnostics::ScopedOperation operation(site);
+        Group& group = Require(name);
+
+        if (!specialization.empty()) {
+            group.SetSpecialization(specialization);
+        }
+        if (year > 0) {
+            group.SetYear(year);
+        }
+
+        SaveUpsert(group);
+    }
+
+    // Students refer to the group by id, so only the group's own record is
+    // written: a crash leaves either the old or the new name, never a
+    // renamed group with students still pointing at the old one.
+    void RenameGroup(const std::string& name, const std::string& newName) {
+        static Diagnostics::OperationSite site("bll.group.rename");
+        Diagnostics::ScopedOperation operation(site);
+        validator->ValidateGroup(newName);
+        Group& group = Require(name);
+        if (newName == name) {
+            return;
+        }
+        if (IsDuplicate(newName)) {
+            throw DuplicateEntityException("Group with name '" + newName + "' already exists");
+        }
+
+        group.SetName(newName);
+        try {
+            SaveUpsert(group);
+        } catch (...) {
+            group.SetName(name);
+            RebuildIndex();
+            throw;
+        }
+    }
+
+    // -1 if no group has this name; 0, no group, for an empty name.
+    int FindId(const std::string& name) const {
+        if (name.empty()) {
+            return 0;
+        }
+        auto it = idsByName.find(name);
+        return it == idsByName.end() ? -1 : it->second;
+    }
+
+    // Empty for no group or an id without a group record.
+    const std::string& NameOf(int groupId) const {
+        static const std::string none;
+        auto it = positionsById.find(groupId);
+        return it == positionsById.end() ? none : items[it->second].GetName();
+    }
+
+    void SetMemberCount(std::function<size_t(int)> count) {
+        memberCount = std::move(count);
+    }
+
+    Group* GetGroupById(int groupId) {
+        auto it = positionsById.find(groupId);
+        return it == positionsById.end() ? nullptr : &items[it->second];
+    }
+
+    Group* GetGroupByName(const std::string& name) {
+        int id = FindId(name);
+        return id <= 0 ? nullptr : GetGroupById(id);
+    }
+};
+
 class IStudentSearchService {
 public:
     virtual ~IStudentSearchService() = default;
@@ -158,8 +509,95 @@ public:
 
 class StudentService : public BaseService<Student>, public IStudentSearchService {
 private:
+    std::shared_ptr<GroupService> groups;
     std::unique_ptr<IIdGenerator> idGenerator;
     std::unique_ptr<IStudentValidator> validator;
+    // Built lazily on the first prefix search after a change. Concurrent
+    // readers may race to build it, so the build is guarded; once built it
+    // is only read until the next (exclusive) write.
+    mutable NamePrefixIndex prefixIndex;
+    mutable std::atomic<bool> prefixIndexStale{true};
+    mutable std::mutex prefixIndexMutex;
+    bool prefixIndexEnabled = true;
+    // Group id -> ascending positions in items. Single-record writes patch
+    // it; loads and bulk writes rebuild it. Const readers, which may run
+    // concurrently, only read it.
+    std::unordered_map<int, std::vector<size_t>> membersByGroup;
+    bool keepMembership = false;
+
+    void EnsurePrefixIndex() const {
+        if (!prefixIndexStale.load(std::memory_order_acquire)) {
+            return;
+        }
+        std::lock_guard lock(prefixIndexMutex);
+        if (prefixIndexStale.load(std::memory_order_relaxed)) {
+            Diagnostics::TraceSpan span("bll.student.build_name_index");
+            prefixIndex.Build(items);
+            prefixIndexStale.store(false, std::memory_order_release);
+        }
+    }
+
+    void RebuildMembership() {
+        membersByGroup.clear();
+        for (size_t i = 0; i < items.size(); ++i) {
+            membersByGroup[items[i].GetGroupId()].push_back(i);
+        }
+    }
+
+    void AddMember(int groupId, size_t position) {
+        auto& members = membersByGroup[groupId];
+        members.insert(std::lower_bound(members.begin(), members.end(), position), position);
+    }
+
+    void RemoveMember(int groupId, size_t position) {
+        auto it = membersByGroup.find(groupId);
+        if (it == membersByGroup.end()) {
+            return;
+        }
+        auto& members = it->second;
+        auto found = std::lower_bound(members.begin(), members.end(), position);
+        if (found != members.end() && *found == position) {
+            members.erase(found);
+        }
+        if (members.empty()) {
+            membersByGroup.erase(it);
+        }
+    }
+
+    // For an item erased from items: later positions move down by one.
+    void EraseMember(int groupId, size_t position) {
+        RemoveMember(groupId, position);
+        for (auto& entry : membersByGroup) {
+            auto& members = entry.second;
+            for (auto it = std::upper_bound(members.begin(), members.end(), position); it != members.end(); ++it) {
+                --*it;
+            }
+        }
+    }
+
+    // Persists changes whose membership the caller has already patched.
+    void SaveKeepingMembership(const DAL::ChangeSet<Student>& changes) {
+        keepMembership = true;
+        try {
+            SaveChanges(changes);
+        } catch (...) {
+            keepMembership = false;
+            throw;
+        }
+        keepMembership = false;
+    }
+
+    void SaveUpsertKeepingMembership(const Student& student) {
+        DAL::ChangeSet<Student> changes;
+        changes.upserts.push_back(student);
+        SaveKeepingMembership(changes);
+    }
+
+    const std::vector<size_t>& Members(int groupId) const {
+        static const std::vector<size_t> none;
+        auto it = membersByGroup.find(groupId);
+        return it == membersByGroup.end() ? none : it->second;
+    }
 
     int GenerateId() {
         if (items.empty()) {
@@ -181,12 +619,22 @@ private:
         return idGenerator->GenerateNext();
     }
 
-    bool IsDuplicate(const std::string& firstName, const std::string& lastName,
-                     const std::string& groupName) const {
+    // Asks the storage first: an indexed backend answers without a scan of
+    // the students.
+    bool IsDuplicate(const std::string& firstName, const std::string& lastName, int groupId) const {
+        std::optional<bool> stored;
+        try {
+            stored = storage->ContainsKey(Student::DuplicateKey(firstName, lastName, groupId));
+        } catch (const DAL::DataAccessException& e) {
+            throw BusinessLogicException("Failed to check for duplicates: " + std::string(e.what()));
+        }
+        if (stored) {
+            return *stored;
+        }
         for (const auto& s : items) {
-            if (s.GetFirstName() == firstName &&
-                s.GetLastName() == lastName &&
-                s.GetGroupName() == groupName) {
+            if (s.GetGroupId() == groupId &&
+                s.GetFirstName() == firstName &&
+                s.GetLastName() == lastName) {
                 return true;
             }
         }
@@ -194,6 +642,21 @@ private:
     }
 
 protected:
+    void OnItemsChanged() override {
+        prefixIndexStale = true;
+        if (!keepMembership) {
+            RebuildMembership();
+        }
+    }
+
+    void ValidateUpdate(const Student& before, const Student& after) const override {
+        BaseService::ValidateUpdate(before, after);
+        validator->ValidateStudent(after.GetFirstName(), after.GetLastName());
+        for (const auto& grade : after.GetGrades()) {
+            validator->ValidateGrade(grade.GetScore());
+        }
+    }
+
     void ValidateBeforeSave() override {
         std::set<int> ids;
         for (const auto& student : items) {
@@ -205,26 +668,69 @@ protected:
     }
 
 public:
-    explicit StudentService(std::shared_ptr<DAL::IDataStorage<Student>> dataStorage)
+    // Group names are resolved through `groupService`, which should be the
+    // same journal's; without one the service keeps its groups in memory.
+    explicit StudentService(std::shared_ptr<DAL::IDataStorage<Student>> dataStorage,
+                            std::shared_ptr<GroupService> groupService = nullptr)
         : BaseService(dataStorage),
+          groups(groupService ? std::move(groupService)
+                              : std::make_shared<GroupService>(std::make_shared<DAL::MemoryStorage<Group>>())),
           idGenerator(std::make_unique<SequentialIdGenerator>()),
-          validator(std::make_unique<StudentValidator>()) {}
+          validator(std::make_unique<StudentValidator>()) {
+        // Records written before groups had ids name their group; they are
+        // moved onto the GroupService's ids and written back.
+        DAL::ChangeSet<Student> migrated;
+        for (auto& student : items) {
+            if (LegacyGroupNames::IsProvisional(student.GetGroupId())) {
+                student.SetGroupId(groups->EnsureGroup(LegacyGroupNames::Instance().Name(student.GetGroupId())));
+                migrated.upserts.push_back(student);
+            }
+        }
+        // The base constructor's load ran before this override existed.
+        RebuildMembership();
+        if (!migrated.Empty()) {
+            SaveKeepingMembership(migrated);
+        }
+        groups->SetMemberCount([this](int groupId) { return Members(groupId).size(); });
+    }
+
+    ~StudentService() override {
+        groups->SetMemberCount(nullptr);
+    }
+
+    const std::shared_ptr<GroupService>& Groups() const {
+        return groups;
+    }
+
+    const std::string& GroupName(const Student& student) const {
+        return groups->NameOf(student.GetGroupId());
+    }
+
+    size_t CountInGroup(int groupId) const {
+        return Members(groupId).size();
+    }
 
     Student AddStudent(const std::string& firstName, const std::string& lastName,
                       const std::string& groupName) {
+        static Diagnostics::OperationSite site("bll.student.add");
+        Diagnostics::ScopedOperation operation(site);
         validator->ValidateStudent(firstName, lastName);
 
-        if (IsDuplicate(firstName, lastName, groupName)) {
+        int groupId = groups->FindId(groupName);
+        if (groupId >= 0 && IsDuplicate(firstName, lastName, groupId)) {
             throw DuplicateEntityException("Student already exists in this group");
         }
 
-        Student student(GenerateId(), firstName, lastName, groupName);
+        Student student(GenerateId(), firstName, lastName, groupId >= 0 ? groupId : groups->EnsureGroup(groupName));
         items.push_back(student);
-        SaveData();
+        AddMember(student.GetGroupId(), items.size() - 1);
+        SaveUpsertKeepingMembership(student);
         return student;
     }
 
     void RemoveStudent(int studentId) {
+        static Diagnostics::OperationSite site("bll.student.remove");
+        Diagnostics::ScopedOperation operation(site);
         auto it = std::find_if(items.begin(), items.end(),
             [studentId](const Student& s) { return s.GetId() == studentId; });
 
@@ -232,12 +738,20 @@ public:
             throw StudentNotFoundException("Student with ID " + std::to_string(studentId) + " not found");
         }
 
+        size_t position = static_cast<size_t>(it - items.begin());
+        int groupId = it->GetGroupId();
         items.erase(it);
-        SaveData();
+        EraseMember(groupId, position);
+
+        DAL::ChangeSet<Student> changes;
+        changes.removals.push_back(studentId);
+        SaveKeepingMembership(changes);
     }
 
     void UpdateStudent(int studentId, const std::string& firstName,
                       const std::string& lastName, const std::string& groupName) {
+        static Diagnostics::OperationSite site("bll.student.update");
+        Diagnostics::ScopedOperation operation(site);
         auto it = std::find_if(items.begin(), items.end(),
             [studentId](const Student& s) { return s.GetId() == studentId; });
 
@@ -245,6 +759,7 @@ public:
             throw StudentNotFoundException("Student with ID " + std::to_string(studentId) + " not found");
         }
 
+        int groupId = groupName.empty() ? it->GetGroupId() : groups->EnsureGroup(groupName);
         if (!firstName.empty()) {
             validator->ValidateStudent(firstName, it->GetLastName());
             it->SetFirstName(firstName);
@@ -253,11 +768,14 @@ public:
             validator->ValidateStudent(it->GetFirstName(), lastName);
             it->SetLastName(lastName);
         }
-        if (!groupName.empty()) {
-            it->SetGroupName(groupName);
+        if (groupId != it->GetGroupId()) {
+            size_t position = static_cast<size_t>(it - items.begin());
+            RemoveMember(it->GetGroupId(), position);
+            it->SetGroupId(groupId);
+            AddMember(groupId, position);
         }
 
-        SaveData();
+        SaveUpsertKeepingMembership(*it);
     }
 
     Student* GetStudentById(int studentId) {
@@ -270,6 +788,8 @@ public:
     }
 
     void AddGradeToStudent(int studentId, const std::string& subject, int score) {
+        static Diagnostics::OperationSite site("bll.student.add_grade");
+        Diagnostics::ScopedOperation operation(site);
         validator->ValidateGrade(score);
 
         auto student = GetStudentById(studentId);
@@ -278,21 +798,25 @@ public:
         }
 
         student->AddGrade(Grade(subject, score));
-        SaveData();
+        SaveUpsertKeepingMembership(*student);
     }
 
     void RemoveGradeFromStudent(int studentId, const std::string& subject) {
+        static Diagnostics::OperationSite site("bll.student.remove_grade");
+        Diagnostics::ScopedOperation operation(site);
         auto student = GetStudentById(studentId);
         if (!student) {
             throw StudentNotFoundException("Student with ID " + std::to_string(studentId) + " not found");
         }
 
         student->RemoveGrade(subject);
-        SaveData();
+        SaveUpsertKeepingMembership(*student);
     }
 
     std::vector<Student> FindByName(const std::string& firstName,
                                     const std::string& lastName) const override {
+        static Diagnostics::OperationSite site("bll.student.find_by_name");
+        Diagnostics::ScopedOperation operation(site);
         std::vector<Student> result;
         for (const auto& student : items) {
             bool matchFirst = firstName.empty() ||
@@ -312,21 +836,124 @@ public:
         return FindByName(firstName, lastName);
     }
 
+    struct PrefixSearchResult {
+        std::vector<Student> students;
+        size_t candidates = 0;
+    };
+
+    PrefixSearchResult FindByNamePrefix(const std::string& query, size_t limit,
+                                        std::stop_token stop = {}) const {
+        static Diagnostics::OperationSite site("bll.student.find_by_name_prefix");
+        Diagnostics::ScopedOperation operation(site);
+        if (!prefixIndexEnabled) {
+            PrefixSearchResult result;
+            std::string folded = FoldName(query);
+            for (const auto& student : items) {
+                if (stop.stop_requested()) break;
+                if (NamePrefixIndex::Matches(FoldName(student.GetFirstName()),
+                                             FoldName(student.GetLastName()), folded)) {
+                    ++result.candidates;
+                    if (result.students.size() < limit) {
+                        result.students.push_back(student);
+                    }
+                }
+            }
+            return result;
+        }
+
+        EnsurePrefixIndex();
+        auto match = prefixIndex.Find(query, limit, stop);
+
+        PrefixSearchResult result;
+        result.candidates = match.candidates;
+        result.students.reserve(match.positions.size());
+        for (size_t position : match.positions) {
+            if (stop.stop_requested()) break;
+            result.students.push_back(items[position]);
+        }
+        return result;
+    }
+
+    void PrepareNameIndex() const {
+        if (prefixIndexEnabled) {
+            EnsurePrefixIndex();
+        }
+    }
+
+    void SetNamePrefixIndexEnabled(bool enabled) {
+        prefixIndexEnabled = enabled;
+        if (!enabled) {
+            prefixIndex = NamePrefixIndex();
+            prefixIndexStale = true;
+        }
+    }
+
     std::vector<Student> FindByGroup(const std::string& groupName) const override {
+        static Diagnostics::OperationSite site("bll.student.find_by_group");
+        Diagnostics::ScopedOperation operation(site);
         std::vector<Student> result;
-        for (const auto& student : items) {
-            if (student.GetGroupName() == groupName) {
-                result.push_back(student);
-            }
+        int groupId = groups->FindId(groupName);
+        if (groupId < 0) {
+            return result;
+        }
+        const auto& members = Members(groupId);
+        result.reserve(members.size());
+        for (size_t position : members) {
+            result.push_back(items[position]);
         }
         return result;
     }
 
+    // Moves every member of one group to another and persists them as one
+    // change set. Only the members are touched, found through the
+    // membership index. Returns how many students moved.
+    size_t ReassignGroup(int fromGroupId, int toGroupId) {
+        static Diagnostics::OperationSite site("bll.student.reassign_group");
+        Diagnostics::ScopedOperation operation(site);
+        if (fromGroupId == toGroupId) {
+            return 0;
+        }
+        std::vector<size_t> moved = Members(fromGroupId);
+        if (moved.empty()) {
+            return 0;
+        }
+
+        DAL::ChangeSet<Student> changes;
+        changes.upserts.reserve(moved.size());
+        for (size_t position : moved) {
+            items[position].SetGroupId(toGroupId);
+            changes.upserts.push_back(items[position]);
+        }
+
+        // Positions and names are unchanged, so both indexes stay valid and
+        // the membership index is patched instead of rebuilt.
+        bool prefixWasStale = prefixIndexStale;
+        try {
+            SaveKeepingMembership(changes);
+        } catch (...) {
+            for (size_t position : moved) {
+                items[position].SetGroupId(fromGroupId);
+            }
+            throw;
+        }
+        prefixIndexStale = prefixWasStale;
+
+        std::vector<size_t>& target = membersByGroup[toGroupId];
+        std::vector<size_t> merged;
+        merged.reserve(target.size() + moved.size());
+        std::merge(target.begin(), target.end(), moved.begin(), moved.end(), std::back_inserter(merged));
+        target = std::move(merged);
+        membersByGroup.erase(fromGroupId);
+        return moved.size();
+    }
+
     std::vector<Student> FindStudentsByGroup(const std::string& groupName) const {
         return FindByGroup(groupName);
     }
 
     std::vector<Student> FindByAverageGrade(double minAverage, double maxAverage) const override {
+        static Diagnostics::OperationSite site("bll.student.find_by_average");
+        Diagnostics::ScopedOperation operation(site);
         std::vector<Student> result;
         for (const auto& student : items) {
             double avg = student.CalculateAverageGrade();
@@ -343,6 +970,8 @@ public:
 
     std::vector<Student> FindByPerformance(bool successful,
                                           const std::string& subject = "") const override {
+        static Diagnostics::OperationSite site("bll.student.find_by_performance");
+        Diagnostics::ScopedOperation operation(site);
         std::vector<Student> result;
         const double threshold = 60.0;
 
@@ -374,103 +1003,18 @@ public:
     }
 
     double CalculateGroupAverageGrade(const std::string& groupName) const {
-        auto groupStudents = FindByGroup(groupName);
-        if (groupStudents.empty()) return 0.0;
+        static Diagnostics::OperationSite site("bll.student.group_average");
+        Diagnostics::ScopedOperation operation(site);
+        int groupId = groups->FindId(groupName);
+        if (groupId < 0) return 0.0;
+        const auto& members = Members(groupId);
+        if (members.empty()) return 0.0;
 
         double sum = 0.0;
-        for (const auto& student : groupStudents) {
-            sum += student.CalculateAverageGrade();
-        }
-        return sum / groupStudents.size();
-    }
-};
-
-class IGroupValidator {
-public:
-    virtual ~IGroupValidator() = default;
-    virtual void ValidateGroup(const std::string& name) const = 0;
-};
-
-class GroupValidator : public IGroupValidator {
-public:
-    void ValidateGroup(const std::string& name) const override {
-        if (name.empty()) {
-            throw ValidationException("Group name cannot be empty");
-        }
-        if (name.length() > 20) {
-            throw ValidationException("Group name too long (max 20 characters)");
-        }
-    }
-};
-
-class GroupService : public BaseService<Group> {
-private:
-    std::unique_ptr<IGroupValidator> validator;
-
-    bool IsDuplicate(const std::string& name) const {
-        for (const auto& g : items) {
-            if (g.GetName() == name) {
-                return true;
-            }
-        }
-        return false;
-    }
-
-public:
-    explicit GroupService(std::shared_ptr<DAL::IDataStorage<Group>> dataStorage)
-        : BaseService(dataStorage),
-          validator(std::make_unique<GroupValidator>()) {}
-
-    Group AddGroup(const std::string& name, const std::string& specialization, int year) {
-        validator->ValidateGroup(name);
-
-        if (IsDuplicate(name)) {
-            throw DuplicateEntityException("Group with name '" + name + "' already exists");
+        for (size_t position : members) {
+            sum += items[position].CalculateAverageGrade();
         }
-
-        Group group(name, specialization, year);
-        items.push_back(group);
-        SaveData();
-        return group;
-    }
-
-    void RemoveGroup(const std::string& name) {
-        auto it = std::find_if(items.begin(), items.end(),
-            [&name](const Group& g) { return g.GetName() == name; });
-
-        if (it == items.end()) {
-            throw GroupNotFoundException("Group '" + name + "' not found");
-        }
-
-        items.erase(it);
-        SaveData();
-    }
-
-    void UpdateGroup(const std::string& name, const std::string& specialization, int year) {
-        auto it = std::find_if(items.begin(), items.end(),
-            [&name](const Group& g) { return g.GetName() == name; });
-
-        if (it == items.end()) {
-            throw GroupNotFoundException("Group '" + name + "' not found");
-        }
-
-        if (!specialization.empty()) {
-            it->SetSpecialization(specialization);
-        }
-        if (year > 0) {
-            it->SetYear(year);
-        }
-
-        SaveData();
-    }
-
-    Group* GetGroupByName(const std::string& name) {
-        for (auto& group : items) {
-            if (group.GetName() == name) {
-                return &group;
-            }
-        }
-        return nullptr;
+        return sum / members.size();
     }
 };
 
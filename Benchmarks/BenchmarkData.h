@@ -0,0 +1,139 @@
+#ifndef BENCHMARKDATA_H
+#define BENCHMARKDATA_H
+
+#include "Models.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#define BENCHMARK_PID _getpid()
+#else
+#include <unistd.h>
+#define BENCHMARK_PID getpid()
+#endif
+
+namespace Bench {
+
+inline const std::vector<std::string>& FirstNames() {
+    static const std::vector<std::string> names = {
+        "Olena", "Andrii", "Iryna", "Taras", "Mariia", "Dmytro", "Sofiia", "Oleksandr",
+        "Anna", "Bohdan", "Yuliia", "Maksym", "Kateryna", "Ivan", "Viktoriia", "Serhii"
+    };
+    return names;
+}
+
+inline const std::vector<std::string>& LastNames() {
+    static const std::vector<std::string> names = {
+        "Shevchenko", "Kovalenko", "Bondarenko", "Tkachenko", "Kravchenko", "Oliinyk",
+        "Shevchuk", "Koval", "Polishchuk", "Bondar", "Marchenko", "Moroz", "Lysenko", "Rudenko"
+    };
+    return names;
+}
+
+inline const std::vector<std::string>& Subjects() {
+    static const std::vector<std::string> subjects = {
+        "Mathematics", "Physics", "Programming", "Databases", "Networks", "Algorithms",
+        "English", "History", "Economics", "Statistics", "Operating Systems", "Discrete Math"
+    };
+    return subjects;
+}
+
+inline std::string GroupName(size_t index) {
+    return "GR-" + std::to_string(100 + index);
+}
+
+inline size_t GroupCount(size_t students) {
+    return std::max<size_t>(1, students / 25);
+}
+
+// The groups of MakeStudents(students, ...): group i has id i + 1.
+inline std::vector<BLL::Group> MakeGroups(size_t students) {
+    std::vector<BLL::Group> groups;
+    for (size_t i = 0; i < GroupCount(students); ++i) {
+        groups.emplace_back(static_cast<int>(i + 1), GroupName(i), "Benchmark", 1 + static_cast<int>(i % 6));
+    }
+    return groups;
+}
+
+// Deterministic students: ids 1..count, roughly 25 per group.
+inline std::vector<BLL::Student> MakeStudents(size_t count, size_t gradesPerStudent, uint64_t seed = 42) {
+    std::mt19937_64 random(seed);
+    const auto& first = FirstNames();
+    const auto& last = LastNames();
+    const auto& subjects = Subjects();
+    size_t groups = GroupCount(count);
+
+    std::vector<BLL::Student> students;
+    students.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        BLL::Student student(static_cast<int>(i + 1),
+                             first[random() % first.size()],
+                             last[random() % last.size()] + std::to_string(i % 1000),
+                             static_cast<int>(random() % groups) + 1);
+        for (size_t g = 0; g < gradesPerStudent; ++g) {
+            student.AddGrade(BLL::Grade(subjects[g % subjects.size()], static_cast<int>(random() % 101)));
+        }
+        students.push_back(std::move(student));
+    }
+    return students;
+}
+
+// A unique path in the temp directory; the file and its WAL are removed on destruction.
+class TempFile {
+private:
+    std::filesystem::path path;
+
+public:
+    explicit TempFile(const std::string& tag) {
+        static std::atomic<int> counter{0};
+        path = std::filesystem::temp_directory_path() /
+               ("gradejournal_bench_" + std::to_string(BENCHMARK_PID) + "_" + tag + "_" +
+                std::to_string(counter++) + ".json");
+        Remove();
+    }
+
+    ~TempFile() {
+        Remove();
+    }
+
+    TempFile(const TempFile&) = delete;
+    TempFile& operator=(const TempFile&) = delete;
+
+    void Remove() {
+        std::error_code error;
+        std::filesystem::remove(path, error);
+        std::filesystem::remove(path.string() + ".wal", error);
+        std::filesystem::remove(path.string() + ".idx", error);
+        std::filesystem::remove(path.string() + ".bloom", error);
+        std::string deltaPrefix = path.filename().string() + ".delta-";
+        for (const auto& entry : std::filesystem::directory_iterator(path.parent_path(), error)) {
+            if (entry.path().filename().string().rfind(deltaPrefix, 0) == 0) {
+                std::filesystem::remove(entry.path(), error);
+            }
+        }
+    }
+
+    std::string String() const {
+        return path.string();
+    }
+
+    uint64_t Size() const {
+        std::error_code error;
+        uint64_t total = 0;
+        for (const auto& file : {path.string(), path.string() + ".wal"}) {
+            auto size = std::filesystem::file_size(file, error);
+            if (!error) total += size;
+        }
+        return total;
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,271 @@
+#include <benchmark/benchmark.h>
+#include "AllocationCounter.h"
+#include "BenchmarkData.h"
+#include "Metrics.h"
+#include "Services.h"
+#include "StorageFactory.h"
+#include <deque>
+#include <iostream>
+#include <memory>
+
+// Arguments: storage (0 = in-memory, 1 = WAL files), journal size.
+// Every benchmark reports heap allocations and bytes per iteration.
+
+namespace {
+
+enum StorageKind { Memory = 0, Wal = 1 };
+
+// Loads a fixed dataset and discards saves, so only BLL work is measured.
+class MemoryStorage : public DAL::IDataStorage<BLL::Student> {
+private:
+    std::vector<BLL::Student> seed;
+
+public:
+    explicit MemoryStorage(std::vector<BLL::Student> students) : seed(std::move(students)) {}
+
+    void Save(const std::vector<BLL::Student>&) override {}
+    std::vector<BLL::Student> Load() override { return seed; }
+    void Clear() override { seed.clear(); }
+};
+
+class Journal {
+private:
+    std::unique_ptr<Bench::TempFile> file;
+
+public:
+    std::shared_ptr<BLL::StudentService> service;
+
+    Journal(int64_t kind, size_t students, size_t grades = 5) {
+        auto data = Bench::MakeStudents(students, grades);
+        auto groups = std::make_shared<BLL::GroupService>(
+            std::make_shared<DAL::MemoryStorage<BLL::Group>>(Bench::MakeGroups(students)));
+        if (kind == Memory) {
+            service = std::make_shared<BLL::StudentService>(std::make_shared<MemoryStorage>(std::move(data)), groups);
+            return;
+        }
+        file = std::make_unique<Bench::TempFile>("service");
+        auto storage = DAL::StorageFactory<BLL::Student>::Create(DAL::StorageType::WAL, file->String());
+        storage->Save(data);
+        service = std::make_shared<BLL::StudentService>(storage, groups);
+    }
+};
+
+class AllocationReport {
+private:
+    benchmark::State& state;
+    Diagnostics::AllocationSnapshot start;
+
+public:
+    explicit AllocationReport(benchmark::State& s)
+        : state(s), start(Diagnostics::AllocationCounter::Snapshot()) {}
+
+    ~AllocationReport() {
+        auto used = Diagnostics::AllocationCounter::Snapshot() - start;
+        state.counters["allocs"] = benchmark::Counter(static_cast<double>(used.allocations),
+                                                      benchmark::Counter::kAvgIterations);
+        state.counters["alloc_bytes"] = benchmark::Counter(static_cast<double>(used.bytes),
+                                                           benchmark::Counter::kAvgIterations);
+        state.SetLabel(state.range(0) == Wal ? "wal" : "memory");
+    }
+};
+
+void BM_AddStudent(benchmark::State& state) {
+    Journal journal(state.range(0), state.range(1));
+    int serial = 0;
+    AllocationReport report(state);
+    for (auto _ : state) {
+        journal.service->AddStudent("Bench", "Student" + std::to_string(serial++), "GR-NEW");
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_AddGradeToStudent(benchmark::State& state) {
+    Journal journal(state.range(0), state.range(1));
+    int id = 0;
+    int students = static_cast<int>(state.range(1));
+    AllocationReport report(state);
+    for (auto _ : state) {
+        journal.service->AddGradeToStudent(id % students + 1, "Benchmark", id % 101);
+        id += 7919;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_RemoveStudent(benchmark::State& state) {
+    Journal journal(state.range(0), state.range(1));
+    std::deque<int> ids;
+    for (int id = 1; id <= state.range(1); ++id) ids.push_back(id);
+    int serial = 0;
+    AllocationReport report(state);
+    for (auto _ : state) {
+        journal.service->RemoveStudent(ids.front());
+        ids.pop_front();
+
+        state.PauseTiming();
+        ids.push_back(journal.service->AddStudent("Bench", "Refill" + std::to_string(serial++), "GR-NEW").GetId());
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template<typename Query>
+void RunQuery(benchmark::State& state, Query query) {
+    Journal journal(state.range(0), state.range(1));
+    AllocationReport report(state);
+    for (auto _ : state) {
+        auto result = query(*journal.service);
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+
+void BM_FindByName(benchmark::State& state) {
+    RunQuery(state, [](const BLL::StudentService& s) { return s.FindByName("Olena", "Koval"); });
+}
+
+void BM_FindByGroup(benchmark::State& state) {
+    RunQuery(state, [](const BLL::StudentService& s) { return s.FindByGroup(Bench::GroupName(3)); });
+}
+
+void BM_FindByAverageGrade(benchmark::State& state) {
+    RunQuery(state, [](const BLL::StudentService& s) { return s.FindByAverageGrade(60.0, 75.0); });
+}
+
+void BM_FindByPerformance(benchmark::State& state) {
+    RunQuery(state, [](const BLL::StudentService& s) { return s.FindByPerformance(false); });
+}
+
+void BM_FindByPerformanceSubject(benchmark::State& state) {
+    RunQuery(state, [](const BLL::StudentService& s) { return s.FindByPerformance(true, "Physics"); });
+}
+
+void BM_FindByNamePrefix(benchmark::State& state) {
+    RunQuery(state, [](const BLL::StudentService& s) { return s.FindByNamePrefix("ol ko", 20).students; });
+}
+
+void BM_CalculateGroupAverageGrade(benchmark::State& state) {
+    RunQuery(state, [](const BLL::StudentService& s) { return s.CalculateGroupAverageGrade(Bench::GroupName(3)); });
+}
+
+void BM_GetAll(benchmark::State& state) {
+    RunQuery(state, [](const BLL::StudentService& s) { return s.GetAll(); });
+}
+
+// Moves one group's ~25 members to another group and back on alternate
+// iterations: one membership lookup and one batched persist each.
+void BM_ReassignGroup(benchmark::State& state) {
+    Journal journal(state.range(0), state.range(1));
+    int groups[2] = {journal.service->Groups()->FindId(Bench::GroupName(3)),
+                     journal.service->Groups()->EnsureGroup("GR-MOVED")};
+    size_t iteration = 0;
+    AllocationReport report(state);
+    for (auto _ : state) {
+        size_t moved = journal.service->ReassignGroup(groups[iteration % 2], groups[(iteration + 1) % 2]);
+        benchmark::DoNotOptimize(moved);
+        ++iteration;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Importing n students one AddStudent at a time: each call scans for
+// duplicates and the maximum id, so the whole import is O(n^2).
+void BM_Import(benchmark::State& state) {
+    auto students = Bench::MakeStudents(state.range(0), 0);
+    auto groups = Bench::MakeGroups(state.range(0));
+    AllocationReport report(state);
+    for (auto _ : state) {
+        BLL::StudentService service(std::make_shared<MemoryStorage>(std::vector<BLL::Student>()));
+        for (const auto& student : students) {
+            service.AddStudent(student.GetFirstName(), student.GetLastName(),
+                               groups[static_cast<size_t>(student.GetGroupId() - 1)].GetName());
+        }
+        benchmark::DoNotOptimize(service.Count());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetComplexityN(state.range(0));
+}
+
+// Cost of one instrumented scope with metrics on (1) and off (0); run with
+// several threads to check that the sharded cells do not contend.
+void BM_ScopedOperation(benchmark::State& state) {
+    static Diagnostics::OperationSite site("bench.scoped_operation");
+    Diagnostics::MetricsRegistry::SetEnabled(state.range(0) != 0);
+    for (auto _ : state) {
+        Diagnostics::ScopedOperation operation(site);
+        benchmark::ClobberMemory();
+    }
+    Diagnostics::MetricsRegistry::SetEnabled(true);
+    state.SetLabel(state.range(0) ? "metrics on" : "metrics off");
+}
+
+void BM_CounterAdd(benchmark::State& state) {
+    static Diagnostics::Counter& counter = Diagnostics::MetricsRegistry::Instance().GetCounter("bench.counter");
+    for (auto _ : state) {
+        counter.Add();
+    }
+}
+
+// End-to-end overhead on a cheap mutating service call (two instrumented
+// scopes per iteration), metrics off (0) versus on (1).
+void BM_AddGradeMetrics(benchmark::State& state) {
+    Journal journal(Memory, 10000);
+    Diagnostics::MetricsRegistry::SetEnabled(state.range(0) != 0);
+    int id = 0;
+    for (auto _ : state) {
+        journal.service->AddGradeToStudent(id % 10000 + 1, "Benchmark", id % 101);
+        id += 7919;
+    }
+    Diagnostics::MetricsRegistry::SetEnabled(true);
+    state.SetLabel(state.range(0) ? "metrics on" : "metrics off");
+}
+
+void Sizes(benchmark::internal::Benchmark* benchmark) {
+    benchmark->ArgNames({"storage", "students"})
+        ->ArgsProduct({{Memory, Wal}, {1000, 10000, 100000}});
+}
+
+}
+
+BENCHMARK(BM_AddStudent)->Apply(Sizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_AddGradeToStudent)->Apply(Sizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_RemoveStudent)->Apply(Sizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FindByName)->Apply(Sizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FindByGroup)->Apply(Sizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FindByAverageGrade)->Apply(Sizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FindByPerformance)->Apply(Sizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FindByPerformanceSubject)->Apply(Sizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FindByNamePrefix)->Apply(Sizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_CalculateGroupAverageGrade)->Apply(Sizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_GetAll)->Apply(Sizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ReassignGroup)->Apply(Sizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ScopedOperation)->ArgName("metrics")->Arg(0)->Arg(1)->Threads(1)->Threads(4);
+BENCHMARK(BM_CounterAdd)->Threads(1)->Threads(4);
+BENCHMARK(BM_AddGradeMetrics)->ArgName("metrics")->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Import)->RangeMultiplier(2)->Range(500, 8000)->Unit(benchmark::kMillisecond)->Complexity();
+
+// --alloc_profile additionally attributes heap traffic to the instrumented
+// DAL/BLL operations and prints per-call figures after the run.
+int main(int argc, char** argv) {
+    bool allocationProfile = false;
+    int kept = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--alloc_profile") {
+            allocationProfile = true;
+        } else {
+            argv[kept++] = argv[i];
+        }
+    }
+    argc = kept;
+
+    Diagnostics::MetricsRegistry::SetAllocationProfiling(allocationProfile);
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    if (allocationProfile) {
+        Diagnostics::MetricsRegistry::Instance().PrintAllocationProfiles(std::cout);
+    }
+    return 0;
+}
@@ -0,0 +1,275 @@
+#include <benchmark/benchmark.h>
+#include "BenchmarkData.h"
+#include "StorageFactory.h"
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <utility>
+
+// Arguments of every benchmark: backend (0 = json, 1 = wal), record count,
+// grades per student. Bytes are what the storage wrote (IoStats) or, for
+// loads, the size of the files read.
+
+namespace {
+
+enum Backend { Json = 0, Wal = 1 };
+
+const std::vector<BLL::Student>& Dataset(size_t records, size_t grades) {
+    static std::map<std::pair<size_t, size_t>, std::vector<BLL::Student>> cache;
+    auto key = std::make_pair(records, grades);
+    auto it = cache.find(key);
+    if (it == cache.end()) {
+        it = cache.emplace(key, Bench::MakeStudents(records, grades)).first;
+    }
+    return it->second;
+}
+
+std::shared_ptr<DAL::IDataStorage<BLL::Student>> Open(int64_t backend, const Bench::TempFile& file) {
+    return DAL::StorageFactory<BLL::Student>::Create(
+        backend == Wal ? DAL::StorageType::WAL : DAL::StorageType::Simple, file.String());
+}
+
+void SetLabel(benchmark::State& state) {
+    state.SetLabel(state.range(0) == Wal ? "wal" : "json");
+}
+
+void BM_Load(benchmark::State& state) {
+    const auto& students = Dataset(state.range(1), state.range(2));
+    Bench::TempFile file("load");
+    Open(state.range(0), file)->Save(students);
+    uint64_t size = file.Size();
+
+    for (auto _ : state) {
+        auto loaded = Open(state.range(0), file)->Load();
+        benchmark::DoNotOptimize(loaded.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size));
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+    SetLabel(state);
+}
+
+void BM_Save(benchmark::State& state) {
+    const auto& students = Dataset(state.range(1), state.range(2));
+    Bench::TempFile file("save");
+    auto storage = Open(state.range(0), file);
+
+    uint64_t before = DAL::IoStats::GetBytesWritten();
+    for (auto _ : state) {
+        storage->Save(students);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(DAL::IoStats::GetBytesWritten() - before));
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+    SetLabel(state);
+}
+
+// JsonStorage has no point operations, so an insert or update is a full
+// Save() of the changed vector, exactly as the services do it.
+void BM_Insert(benchmark::State& state) {
+    auto students = Dataset(state.range(1), state.range(2));
+    Bench::TempFile file("insert");
+    DAL::WALJsonStorage<BLL::Student> wal(file.String(), 50);
+    auto json = Open(Json, file);
+    if (state.range(0) == Wal) wal.Save(students); else json->Save(students);
+
+    int nextId = static_cast<int>(students.size()) + 1;
+    BLL::Student prototype = students.front();
+    uint64_t before = DAL::IoStats::GetBytesWritten();
+    for (auto _ : state) {
+        BLL::Student student(nextId++, prototype.GetFirstName(), prototype.GetLastName(), prototype.GetGroupId());
+        if (state.range(0) == Wal) {
+            wal.Insert(student);
+        } else {
+            students.push_back(student);
+            json->Save(students);
+        }
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(DAL::IoStats::GetBytesWritten() - before));
+    state.SetItemsProcessed(state.iterations());
+    SetLabel(state);
+}
+
+void BM_Update(benchmark::State& state) {
+    auto students = Dataset(state.range(1), state.range(2));
+    Bench::TempFile file("update");
+    DAL::WALJsonStorage<BLL::Student> wal(file.String(), 50);
+    auto json = Open(Json, file);
+    if (state.range(0) == Wal) wal.Save(students); else json->Save(students);
+
+    size_t position = 0;
+    uint64_t before = DAL::IoStats::GetBytesWritten();
+    for (auto _ : state) {
+        BLL::Student& student = students[position];
+        position = (position + 7919) % students.size();
+        student.AddGrade(BLL::Grade("Benchmark", static_cast<int>(position % 101)));
+        if (state.range(0) == Wal) {
+            wal.Update(student);
+        } else {
+            json->Save(students);
+        }
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(DAL::IoStats::GetBytesWritten() - before));
+    state.SetItemsProcessed(state.iterations());
+    SetLabel(state);
+}
+
+void BM_LoadRange(benchmark::State& state) {
+    const auto& students = Dataset(state.range(1), state.range(2));
+    const int pageSize = 100;
+    Bench::TempFile file("range");
+    DAL::WALJsonStorage<BLL::Student> wal(file.String(), 50);
+    auto json = Open(Json, file);
+    if (state.range(0) == Wal) wal.Save(students); else json->Save(students);
+
+    int offset = 0;
+    for (auto _ : state) {
+        std::vector<BLL::Student> page;
+        if (state.range(0) == Wal) {
+            page = wal.LoadRange(offset, pageSize);
+        } else {
+            auto all = json->Load();
+            auto begin = all.begin() + std::min<size_t>(offset, all.size());
+            page.assign(begin, begin + std::min<size_t>(pageSize, all.end() - begin));
+        }
+        benchmark::DoNotOptimize(page.data());
+        offset = (offset + pageSize) % static_cast<int>(students.size());
+    }
+    state.SetItemsProcessed(state.iterations() * pageSize);
+    SetLabel(state);
+}
+
+void BM_Compact(benchmark::State& state) {
+    const auto& students = Dataset(state.range(1), state.range(2));
+    Bench::TempFile file("compact");
+    DAL::WALJsonStorage<BLL::Student> wal(file.String(), 1 << 30);
+    wal.Save(students);
+
+    uint64_t written = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (int i = 0; i < 50; ++i) {
+            wal.Update(students[(i * 7919) % students.size()]);
+        }
+        uint64_t before = DAL::IoStats::GetBytesWritten();
+        state.ResumeTiming();
+
+        wal.ForceCompact();
+
+        written += DAL::IoStats::GetBytesWritten() - before;
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(written));
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+    SetLabel(state);
+}
+
+// The same churn as BM_Compact with delta checkpoints merged every 8
+// deltas: each checkpoint writes only the 50 changed records, and the
+// merge that rewrites the data file runs in the background.
+void BM_Checkpoint(benchmark::State& state) {
+    const auto& students = Dataset(state.range(1), state.range(2));
+    Bench::TempFile file("checkpoint");
+    DAL::WALJsonStorage<BLL::Student> wal(file.String(), 1 << 30);
+    wal.Save(students);
+    wal.EnableDeltaCheckpoints(8);
+
+    uint64_t written = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (int i = 0; i < 50; ++i) {
+            wal.Update(students[(i * 7919) % students.size()]);
+        }
+        uint64_t before = DAL::IoStats::GetBytesWritten();
+        state.ResumeTiming();
+
+        wal.ForceCheckpoint();
+
+        written += DAL::IoStats::GetBytesWritten() - before;
+    }
+    wal.WaitForMerge();
+    state.SetBytesProcessed(static_cast<int64_t>(written));
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+    SetLabel(state);
+}
+
+// A fresh process looking up one student: the WAL backend seeks through
+// the id index instead of loading the data file.
+void BM_PointLookup(benchmark::State& state) {
+    const auto& students = Dataset(state.range(1), state.range(2));
+    Bench::TempFile file("lookup");
+    Open(state.range(0), file)->Save(students);
+
+    size_t i = 0;
+    for (auto _ : state) {
+        DAL::WALJsonStorage<BLL::Student> wal(file.String());
+        auto student = wal.LoadById(students[(i++ * 7919) % students.size()].GetId());
+        benchmark::DoNotOptimize(student);
+    }
+    state.SetItemsProcessed(state.iterations());
+    SetLabel(state);
+}
+
+// Exists() for ids that are not stored, as during an import: the WAL
+// backend answers most of them from the id filter alone.
+void BM_NegativeLookup(benchmark::State& state) {
+    const auto& students = Dataset(state.range(1), state.range(2));
+    Bench::TempFile file("negative");
+    Open(state.range(0), file)->Save(students);
+    DAL::WALJsonStorage<BLL::Student> wal(file.String());
+
+    int id = static_cast<int>(students.size()) * 2;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(wal.Exists(++id));
+    }
+    state.counters["false_positive_rate"] = wal.GetIdFilterStats().FalsePositiveRate();
+    state.SetItemsProcessed(state.iterations());
+    SetLabel(state);
+}
+
+// Point lookups under a cache budget of a tenth of the records, with nine
+// in ten lookups going to a hot 1% of the ids.
+void BM_BudgetedLookup(benchmark::State& state) {
+    const auto& students = Dataset(state.range(1), state.range(2));
+    Bench::TempFile file("budget");
+    Open(state.range(0), file)->Save(students);
+    DAL::WALJsonStorage<BLL::Student> wal(file.String());
+    wal.EnableCacheBudget(students.size() / 10 * (students.front().MemoryUsage() + 96));
+
+    size_t i = 0;
+    for (auto _ : state) {
+        size_t index = (i * 7919) % students.size();
+        if (i++ % 10 != 0) {
+            index %= std::max<size_t>(1, students.size() / 100);
+        }
+        auto student = wal.LoadById(students[index].GetId());
+        benchmark::DoNotOptimize(student);
+    }
+    auto stats = wal.GetCacheStats();
+    state.counters["hit_rate"] = stats.HitRate();
+    state.counters["resident_mb"] = static_cast<double>(stats.residentBytes) / (1024 * 1024);
+    state.SetItemsProcessed(state.iterations());
+    SetLabel(state);
+}
+
+void AllBackends(benchmark::internal::Benchmark* benchmark) {
+    benchmark->ArgNames({"backend", "records", "grades"})
+        ->ArgsProduct({{Json, Wal}, {1000, 10000, 100000, 1000000}, {2, 10}});
+}
+
+void WalOnly(benchmark::internal::Benchmark* benchmark) {
+    benchmark->ArgNames({"backend", "records", "grades"})
+        ->ArgsProduct({{Wal}, {1000, 10000, 100000, 1000000}, {2, 10}});
+}
+
+}
+
+BENCHMARK(BM_Load)->Apply(AllBackends)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Save)->Apply(AllBackends)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Insert)->Apply(AllBackends)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Update)->Apply(AllBackends)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_LoadRange)->Apply(AllBackends)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Compact)->Apply(WalOnly)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Checkpoint)->Apply(WalOnly)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_PointLookup)->Apply(WalOnly)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_NegativeLookup)->Apply(WalOnly)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BudgetedLookup)->Apply(WalOnly)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,170 @@
+#ifndef BLOOMFILTER_H
+#define BLOOMFILTER_H
+
+#include "Metrics.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace DAL {
+
+// A fixed-size Bloom filter over 64-bit hashes. MightContain never returns
+// false for a key that was added; it returns true for an absent key with
+// roughly the false-positive rate the filter was sized for, rising once more
+// keys than `capacity` are added. Bit positions use double hashing, so each
+// key is hashed once.
+class BloomFilter {
+private:
+    std::vector<uint64_t> words;
+    uint64_t bitCount = 64;
+    uint32_t hashCount = 1;
+    size_t capacity = 0;
+    size_t keys = 0;
+
+    static uint64_t Mix(uint64_t value) {
+        value ^= value >> 33;
+        value *= 0xff51afd7ed558ccdULL;
+        value ^= value >> 33;
+        value *= 0xc4ceb9fe1a85ec53ULL;
+        value ^= value >> 33;
+        return value;
+    }
+
+public:
+    BloomFilter() : words(1, 0) {}
+
+    // Sized for `expectedKeys` at `falsePositiveRate`: m = -n ln p / (ln 2)^2
+    // bits and k = m / n ln 2 hash functions.
+    BloomFilter(size_t expectedKeys, double falsePositiveRate) : capacity(std::max<size_t>(expectedKeys, 1)) {
+        double ln2 = std::log(2.0);
+        double bits = -static_cast<double>(capacity) * std::log(falsePositiveRate) / (ln2 * ln2);
+        bitCount = std::max<uint64_t>(64, static_cast<uint64_t>(std::ceil(bits / 64.0)) * 64);
+        hashCount = std::clamp<uint32_t>(static_cast<uint32_t>(std::lround(bits / capacity * ln2)), 1, 16);
+        words.assign(bitCount / 64, 0);
+    }
+
+    static uint64_t Hash(const std::string& key) {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (unsigned char c : key) {
+            hash = (hash ^ c) * 0x100000001b3ULL;
+        }
+        return Mix(hash);
+    }
+
+    static uint64_t Hash(int key) {
+        return Mix(static_cast<uint64_t>(static_cast<uint32_t>(key)) + 0x9e3779b97f4a7c15ULL);
+    }
+
+    void Add(uint64_t hash) {
+        uint64_t step = Mix(hash) | 1;
+        for (uint32_t i = 0; i < hashCount; ++i) {
+            uint64_t bit = (hash + i * step) % bitCount;
+            words[bit / 64] |= uint64_t{1} << (bit % 64);
+        }
+        ++keys;
+    }
+
+    bool MightContain(uint64_t hash) const {
+        uint64_t step = Mix(hash) | 1;
+        for (uint32_t i = 0; i < hashCount; ++i) {
+            uint64_t bit = (hash + i * step) % bitCount;
+            if ((words[bit / 64] & (uint64_t{1} << (bit % 64))) == 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // True once the filter holds more keys than it was sized for and its
+    // false-positive rate has started to climb.
+    bool Saturated() const {
+        return keys > capacity;
+    }
+
+    size_t SizeBytes() const {
+        return words.size() * sizeof(uint64_t);
+    }
+
+    // Layout: bit count, hash count, capacity, key count, then the words.
+    void AppendTo(std::string& out) const {
+        uint64_t header[4] = {bitCount, hashCount, capacity, keys};
+        out.append(reinterpret_cast<const char*>(header), sizeof(header));
+        out.append(reinterpret_cast<const char*>(words.data()), SizeBytes());
+    }
+
+    // Reads a filter written by AppendTo at `offset`, advancing it; false if
+    // the bytes are truncated or malformed.
+    bool ReadFrom(const std::string& in, size_t& offset) {
+        uint64_t header[4];
+        if (in.size() < offset + sizeof(header)) return false;
+        std::memcpy(header, in.data() + offset, sizeof(header));
+        if (header[0] == 0 || header[0] % 64 != 0 || header[1] == 0 || header[1] > 16 ||
+            in.size() - offset - sizeof(header) < header[0] / 8) {
+            return false;
+        }
+        bitCount = header[0];
+        hashCount = static_cast<uint32_t>(header[1]);
+        capacity = static_cast<size_t>(header[2]);
+        keys = static_cast<size_t>(header[3]);
+        words.assign(bitCount / 64, 0);
+        std::memcpy(words.data(), in.data() + offset + sizeof(header), SizeBytes());
+        offset += sizeof(header) + SizeBytes();
+        return true;
+    }
+};
+
+// Outcomes of lookups guarded by a filter. A negative is answered by the
+// filter alone; a false positive passed the filter and then missed in the
+// data. The observed false-positive rate is FP / (FP + negatives), the
+// share of absent keys the filter failed to reject.
+struct BloomFilterStats {
+    uint64_t checks = 0;
+    uint64_t negatives = 0;
+    uint64_t falsePositives = 0;
+
+    double FalsePositiveRate() const {
+        uint64_t absent = negatives + falsePositives;
+        return absent == 0 ? 0.0 : static_cast<double>(falsePositives) / absent;
+    }
+};
+
+// Per-storage stats that also feed the process-wide "dal.bloom.<name>.*"
+// counters exported with the other metrics.
+class BloomFilterCounters {
+private:
+    BloomFilterStats stats;
+    Diagnostics::Counter& checks;
+    Diagnostics::Counter& negatives;
+    Diagnostics::Counter& falsePositives;
+
+public:
+    explicit BloomFilterCounters(const std::string& name)
+        : checks(Diagnostics::MetricsRegistry::Instance().GetCounter("dal.bloom." + name + ".checks")),
+          negatives(Diagnostics::MetricsRegistry::Instance().GetCounter("dal.bloom." + name + ".negatives")),
+          falsePositives(Diagnostics::MetricsRegistry::Instance().GetCounter("dal.bloom." + name + ".false_positives")) {}
+
+    void Check(bool negative) {
+        ++stats.checks;
+        checks.Add();
+        if (negative) {
+            ++stats.negatives;
+            negatives.Add();
+        }
+    }
+
+    void FalsePositive() {
+        ++stats.falsePositives;
+        falsePositives.Add();
+    }
+
+    const BloomFilterStats& Stats() const {
+        return stats;
+    }
+};
+
+}
+
+#endif
@@ -11,6 +11,7 @@ template<typename T>
 class JsonStorage : public IDataStorage<T> {
 private:
     std::string filePath;
+    FsyncMode fsyncMode;
 
     void ValidateFilePath() const {
         if (filePath.empty()) {
@@ -23,11 +24,16 @@ private:
         if (!file.is_open()) {
             throw DataAccessException("Cannot open file for writing: " + filePath);
         }
-        file << data.dump(4);
+        std::string text = data.dump(4);
+        file << text;
         if (!file.good()) {
             throw DataAccessException("Error writing to file: " + filePath);
         }
         file.close();
+        IoStats::AddBytesWritten(text.size());
+        if (fsyncMode != FsyncMode::None) {
+            SyncFile(filePath);
+        }
     }
 
     json ReadFromFile() {
@@ -47,11 +53,14 @@ private:
     }
 
 public:
-    explicit JsonStorage(const std::string& path) : filePath(path) {
+    explicit JsonStorage(const std::string& path, FsyncMode fsync = FsyncMode::None)
+        : filePath(path), fsyncMode(fsync) {
         ValidateFilePath();
     }
 
     void Save(const std::vector<T>& items) override {
+        static Diagnostics::OperationSite site("dal.json.save");
+        Diagnostics::ScopedOperation operation(site);
         try {
             json j = json::array();
             for (const auto& item : items) {
@@ -66,6 +75,8 @@ public:
     }
 
     std::vector<T> Load() override {
+        static Diagnostics::OperationSite site("dal.json.load");
+        Diagnostics::ScopedOperation operation(site);
         std::vector<T> items;
         try {
             json j = ReadFromFile();
@@ -88,6 +99,8 @@ public:
     }
 
     void Clear() override {
+        static Diagnostics::OperationSite site("dal.json.clear");
+        Diagnostics::ScopedOperation operation(site);
         try {
             WriteToFile(json::array());
         } catch (const std::exception& e) {
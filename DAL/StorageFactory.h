@@ -17,6 +17,20 @@ enum class StorageType {
     Sqlite
 };
 
+struct StorageOptions {
+    StorageType type = StorageType::WAL;
+    int compactAfter = 50;
+    FsyncMode fsync = FsyncMode::None;
+    // WAL only: archive compacted segments and base snapshots for
+    // point-in-time restore.
+    bool archive = false;
+    int archiveKeepBases = 3;
+    int archiveBaseEvery = 10;
+    // WAL only: checkpoints write deltas of the changed records, merged into
+    // the data file every deltaCheckpoints deltas; 0 rewrites it each time.
+    int deltaCheckpoints = 0;
+};
+
 template<typename T>
 class UniversalStorageAdapter : public IDataStorage<T> {
 private:
@@ -47,6 +61,27 @@ public:
         }
     }
 
+    void SaveChanges(const std::vector<T>& items, const ChangeSet<T>& changes) override {
+        switch (type) {
+            case StorageType::WAL: {
+                auto s = std::static_pointer_cast<WALJsonStorage<T>>(storage);
+                s->ApplyBatch(changes);
+                break;
+            }
+            default:
+                Save(items);
+        }
+    }
+
+    std::optional<bool> ContainsKey(const std::string& key) override {
+        if constexpr (requires(WALJsonStorage<T>& wal) { wal.ContainsKey(key); }) {
+            if (type == StorageType::WAL) {
+                return std::static_pointer_cast<WALJsonStorage<T>>(storage)->ContainsKey(key);
+            }
+        }
+        return std::nullopt;
+    }
+
     std::vector<T> Load() override {
         switch (type) {
             case StorageType::Simple: {
@@ -92,24 +127,39 @@ public:
     static std::shared_ptr<IDataStorage<T>> Create(
         StorageType type,
         const std::string& path) {
+        StorageOptions options;
+        options.type = type;
+        return Create(options, path);
+    }
+
+    static std::shared_ptr<IDataStorage<T>> Create(
+        const StorageOptions& options,
+        const std::string& path) {
 
         std::shared_ptr<void> storage;
+        StorageType type = options.type;
 
         switch (type) {
             case StorageType::Simple:
-                storage = std::make_shared<JsonStorage<T>>(path);
+                storage = std::make_shared<JsonStorage<T>>(path, options.fsync);
                 break;
 
-            case StorageType::WAL:
-                storage = std::make_shared<WALJsonStorage<T>>(path, 50);
+            case StorageType::WAL: {
+                auto wal = std::make_shared<WALJsonStorage<T>>(path, options.compactAfter, options.fsync);
+                if (options.archive) {
+                    wal->EnableArchive(options.archiveKeepBases, options.archiveBaseEvery);
+                }
+                wal->EnableDeltaCheckpoints(options.deltaCheckpoints);
+                storage = wal;
                 break;
+            }
 
             /*case StorageType::Sqlite:
                 storage = std::make_shared<SqliteStorage<T>>(path, "data");
                 break;*/
 
             default:
-                storage = std::make_shared<JsonStorage<T>>(path);
+                storage = std::make_shared<JsonStorage<T>>(path, options.fsync);
         }
 
         return std::make_shared<UniversalStorageAdapter<T>>(type, storage);
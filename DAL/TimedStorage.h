@@ -0,0 +1,70 @@
+#ifndef TIMEDSTORAGE_H
+#define TIMEDSTORAGE_H
+
+#include "DataAccess.h"
+#include <chrono>
+#include <memory>
+
+namespace DAL {
+
+struct StorageTimer {
+    std::atomic<int64_t> nanoseconds{0};
+    std::atomic<uint64_t> calls{0};
+
+    void Add(std::chrono::steady_clock::duration elapsed) {
+        nanoseconds.fetch_add(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+            std::memory_order_relaxed);
+        calls.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::chrono::nanoseconds Total() const {
+        return std::chrono::nanoseconds(nanoseconds.load(std::memory_order_relaxed));
+    }
+};
+
+template<typename T>
+class TimedStorage : public IDataStorage<T> {
+private:
+    std::shared_ptr<IDataStorage<T>> inner;
+    std::shared_ptr<StorageTimer> timer;
+
+    template<typename F>
+    decltype(auto) Measure(F&& action) {
+        auto start = std::chrono::steady_clock::now();
+        struct Recorder {
+            StorageTimer& timer;
+            std::chrono::steady_clock::time_point start;
+            ~Recorder() { timer.Add(std::chrono::steady_clock::now() - start); }
+        } recorder{*timer, start};
+        return action();
+    }
+
+public:
+    TimedStorage(std::shared_ptr<IDataStorage<T>> wrapped, std::shared_ptr<StorageTimer> storageTimer)
+        : inner(wrapped), timer(storageTimer) {}
+
+    void Save(const std::vector<T>& items) override {
+        Measure([&]() { inner->Save(items); });
+    }
+
+    void SaveChanges(const std::vector<T>& items, const ChangeSet<T>& changes) override {
+        Measure([&]() { inner->SaveChanges(items, changes); });
+    }
+
+    std::vector<T> Load() override {
+        return Measure([&]() { return inner->Load(); });
+    }
+
+    void Clear() override {
+        Measure([&]() { inner->Clear(); });
+    }
+
+    std::optional<bool> ContainsKey(const std::string& key) override {
+        return Measure([&]() { return inner->ContainsKey(key); });
+    }
+};
+
+}
+
+#endif
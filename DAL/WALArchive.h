@@ -0,0 +1,135 @@
+#ifndef WALARCHIVE_H
+#define WALARCHIVE_H
+
+#include "DataAccess.h"
+#include <algorithm>
+#include <cstdint>
+#include <ctime>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace DAL {
+
+// A full snapshot of the data file holding every operation up to `lsn`.
+struct ArchivedBase {
+    std::string path;
+    uint64_t lsn = 0;
+    std::time_t time = 0;
+};
+
+// A WAL file that compaction moved into the archive instead of truncating,
+// holding the lines with LSNs firstLsn..lastLsn.
+struct ArchivedSegment {
+    std::string path;
+    uint64_t firstLsn = 0;
+    uint64_t lastLsn = 0;
+};
+
+// Layout of the archive directory next to a WAL data file:
+//   base-<lsn>-<unix time>.json    snapshots, in the data file format
+//   wal-<first lsn>-<last lsn>.log  archived WAL segments
+// LSNs are zero-padded so the names also sort in LSN order.
+class WALArchive {
+private:
+    static std::string Pad(uint64_t value) {
+        std::string digits = std::to_string(value);
+        return std::string(digits.size() < 20 ? 20 - digits.size() : 0, '0') + digits;
+    }
+
+    // Splits "prefix-<a>-<b><suffix>" into a and b; false for other names.
+    static bool ParseName(const std::string& name, const std::string& prefix, const std::string& suffix,
+                          uint64_t& first, uint64_t& second) {
+        if (name.size() <= prefix.size() + suffix.size() || name.compare(0, prefix.size(), prefix) != 0 ||
+            name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) {
+            return false;
+        }
+        std::string middle = name.substr(prefix.size(), name.size() - prefix.size() - suffix.size());
+        size_t dash = middle.find('-');
+        if (dash == std::string::npos || dash == 0 || dash + 1 == middle.size() ||
+            middle.find_first_not_of("0123456789-") != std::string::npos) {
+            return false;
+        }
+        try {
+            first = std::stoull(middle.substr(0, dash));
+            second = std::stoull(middle.substr(dash + 1));
+        } catch (const std::exception&) {
+            return false;
+        }
+        return true;
+    }
+
+public:
+    static std::string BaseName(uint64_t lsn, std::time_t time) {
+        return "base-" + Pad(lsn) + "-" + std::to_string(static_cast<long long>(time)) + ".json";
+    }
+
+    static std::string SegmentName(uint64_t firstLsn, uint64_t lastLsn) {
+        return "wal-" + Pad(firstLsn) + "-" + Pad(lastLsn) + ".log";
+    }
+
+    static std::vector<ArchivedBase> ListBases(const std::string& directory) {
+        std::vector<ArchivedBase> bases;
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+            uint64_t lsn = 0, time = 0;
+            if (ParseName(entry.path().filename().string(), "base-", ".json", lsn, time)) {
+                bases.push_back(ArchivedBase{entry.path().string(), lsn, static_cast<std::time_t>(time)});
+            }
+        }
+        std::sort(bases.begin(), bases.end(),
+                  [](const ArchivedBase& a, const ArchivedBase& b) { return a.lsn < b.lsn; });
+        return bases;
+    }
+
+    static std::vector<ArchivedSegment> ListSegments(const std::string& directory) {
+        std::vector<ArchivedSegment> segments;
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+            uint64_t first = 0, last = 0;
+            if (ParseName(entry.path().filename().string(), "wal-", ".log", first, last)) {
+                segments.push_back(ArchivedSegment{entry.path().string(), first, last});
+            }
+        }
+        std::sort(segments.begin(), segments.end(),
+                  [](const ArchivedSegment& a, const ArchivedSegment& b) { return a.firstLsn < b.firstLsn; });
+        return segments;
+    }
+
+    // The highest LSN the archive knows about, 0 for an empty archive.
+    static uint64_t LastLsn(const std::string& directory) {
+        uint64_t last = 0;
+        for (const auto& base : ListBases(directory)) {
+            last = std::max(last, base.lsn);
+        }
+        for (const auto& segment : ListSegments(directory)) {
+            last = std::max(last, segment.lastLsn);
+        }
+        return last;
+    }
+
+    // Keeps the newest `keepBases` snapshots and the segments needed to roll
+    // any of them forward; everything older than the oldest kept snapshot
+    // can no longer be restored and is deleted.
+    static void ApplyRetention(const std::string& directory, int keepBases) {
+        auto bases = ListBases(directory);
+        if (keepBases < 1 || bases.size() <= static_cast<size_t>(keepBases)) {
+            return;
+        }
+        size_t firstKept = bases.size() - static_cast<size_t>(keepBases);
+        std::error_code error;
+        for (size_t i = 0; i < firstKept; ++i) {
+            std::filesystem::remove(bases[i].path, error);
+        }
+        uint64_t oldestLsn = bases[firstKept].lsn;
+        for (const auto& segment : ListSegments(directory)) {
+            if (segment.lastLsn <= oldestLsn) {
+                std::filesystem::remove(segment.path, error);
+            }
+        }
+    }
+};
+
+}
+
+#endif
@@ -1,13 +1,28 @@
 #ifndef WALJSONSTORAGE_H
 #define WALJSONSTORAGE_H
 
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
 #include <fstream>
 #include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <future>
+#include <iterator>
+#include <limits>
+#include <list>
+#include <optional>
 #include <set>
+#include <unordered_map>
+#include <utility>
 #include <nlohmann/json.hpp>
+#include "BloomFilter.h"
+#include "DataAccess.h"
+#include "WALArchive.h"
 
 using json = nlohmann::json;
 
@@ -16,7 +31,8 @@ namespace DAL {
 enum class OperationType {
     INSERT,
     UPDATE,
-    DELETE
+    DELETE,
+    BATCH
 };
 
 template<typename T>
@@ -50,113 +66,1011 @@ struct Operation {
     }
 };
 
+// Record cache of a WALJsonStorage with a memory budget. Hits and misses
+// count lookups of single records; scans read evicted records without
+// caching them and are not counted.
+struct CacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t residentRecords = 0;
+    size_t evictedRecords = 0;
+    size_t residentBytes = 0;
+
+    double HitRate() const {
+        uint64_t lookups = hits + misses;
+        return lookups == 0 ? 0.0 : static_cast<double>(hits) / lookups;
+    }
+};
+
 template<typename T>
 class WALJsonStorage {
 private:
+    // "<data>.idx" maps every id in the data file to the byte range of its
+    // record: a header followed by entries sorted by id, in native byte
+    // order since the index is rebuilt by every compaction on this machine.
+    static constexpr char IndexMagic[8] = {'G', 'J', 'I', 'D', 'X', '1', 0, 0};
+    // "<data>.bloom" holds Bloom filters over the ids and, for records with
+    // a DuplicateKey(), the duplicate keys in the data file, behind the same
+    // header as the id index. Version 2 keys students by group id, not name.
+    static constexpr char FilterMagic[8] = {'G', 'J', 'B', 'L', 'M', '2', 0, 0};
+    static constexpr double FilterFalsePositiveRate = 0.01;
+    static constexpr bool HasDuplicateKey = requires(const T& item) { item.DuplicateKey(); };
+
+    struct IndexHeader {
+        char magic[8];
+        uint64_t dataSize;
+        int64_t dataTime;
+        uint64_t count;
+    };
+
+    struct IndexEntry {
+        int32_t id;
+        uint32_t length;
+        uint64_t offset;
+    };
+
     std::string dataFilePath;
     std::string walFilePath;
+    std::string indexFilePath;
+    std::string filterFilePath;
     std::map<int, T> memoryIndex;
     std::set<int> deletedIds;
     int operationsSinceCompact;
     int compactThreshold;
+    FsyncMode fsyncMode;
     bool indexLoaded;
+    // Every WAL line carries the next LSN; a batch line takes one LSN for
+    // all its operations. walFirstLsn is the first LSN in the current WAL
+    // file, 0 while it is empty.
+    uint64_t nextLsn = 1;
+    uint64_t walFirstLsn = 0;
+    std::string archiveDirectory;
+    int archiveKeepBases = 0;
+    int archiveBaseEvery = 1;
+    int compactionsSinceBase = 0;
+    // With delta checkpoints a checkpoint writes only the records changed
+    // since the previous one, to "<data>.delta-<seq>", and a background
+    // merge folds the deltas into the data file once deltaCheckpoints have
+    // accumulated. Loading applies every remaining delta in order over the
+    // data file. A merge deletes only the deltas it folded and only after
+    // the new data file is in place, so deltas left behind by a crash are a
+    // suffix of what the data file already holds and replaying them is
+    // harmless.
+    int deltaCheckpoints = 0;
+    std::set<int> dirtyIds;
+    std::vector<uint64_t> deltaSeqs;
+    uint64_t nextDeltaSeq = 1;
+    uint64_t mergingUpTo = 0;
+    std::future<void> merge;
+    std::optional<BloomFilter> idFilter;
+    std::optional<BloomFilter> keyFilter;
+    BloomFilterCounters idFilterCounters{"ids"};
+    BloomFilterCounters keyFilterCounters{"keys"};
+    // DuplicateKey() -> ids of the records with it, built by the first
+    // ContainsKey that gets past the key filter and then kept in step by
+    // Put and Erase, so positives need no scan of the records.
+    bool keyIndexBuilt = false;
+    std::unordered_multimap<std::string, int> idsByKey;
+    std::unordered_map<int, std::string> keyById;
+    // With a cache budget only recently used records stay in memoryIndex.
+    // A resident record identical to its copy in the data file has that
+    // location in onDisk and a place in the LRU list, and can be evicted to
+    // coldRecords, which keeps only the location; it is read back on access.
+    // Changed records stay resident until the next data file write gives
+    // them a location.
+    size_t cacheBudget = 0;
+    size_t residentBytes = 0;
+    std::map<int, IndexEntry> coldRecords;
+    std::unordered_map<int, IndexEntry> onDisk;
+    std::list<int> lru;
+    std::unordered_map<int, std::list<int>::iterator> lruPosition;
+    CacheStats cacheStats;
+
+    // Per record: the map node and the LRU bookkeeping.
+    static constexpr size_t RecordOverhead = 96;
+
+    static size_t RecordBytes(const T& item) {
+        if constexpr (requires { item.MemoryUsage(); }) {
+            return item.MemoryUsage() + RecordOverhead;
+        } else {
+            return sizeof(T) + RecordOverhead;
+        }
+    }
+
+    void AdjustResident(int64_t bytes) {
+        static Diagnostics::Gauge& gauge = Diagnostics::MetricsRegistry::Instance().GetGauge("dal.cache.resident_bytes");
+        residentBytes = static_cast<size_t>(static_cast<int64_t>(residentBytes) + bytes);
+        gauge.Add(bytes);
+    }
+
+    void List(int id) {
+        lruPosition[id] = lru.insert(lru.end(), id);
+    }
+
+    void Unlist(int id) {
+        auto it = lruPosition.find(id);
+        if (it != lruPosition.end()) {
+            lru.erase(it->second);
+            lruPosition.erase(it);
+        }
+    }
+
+    void UnindexKey(int id) {
+        auto it = keyById.find(id);
+        if (it == keyById.end()) return;
+        auto range = idsByKey.equal_range(it->second);
+        for (auto entry = range.first; entry != range.second; ++entry) {
+            if (entry->second == id) {
+                idsByKey.erase(entry);
+                break;
+            }
+        }
+        keyById.erase(it);
+    }
+
+    void IndexKey(const T& item) {
+        UnindexKey(item.GetId());
+        std::string key = item.DuplicateKey();
+        idsByKey.emplace(key, item.GetId());
+        keyById.emplace(item.GetId(), std::move(key));
+    }
+
+    // Every change to memoryIndex goes through Put and Erase, which keep
+    // the budget bookkeeping and the key index in step.
+    void Put(const T& item) {
+        int id = item.GetId();
+        if constexpr (HasDuplicateKey) {
+            if (keyIndexBuilt) IndexKey(item);
+        }
+        if (cacheBudget > 0) {
+            auto it = memoryIndex.find(id);
+            if (it != memoryIndex.end()) {
+                AdjustResident(-static_cast<int64_t>(RecordBytes(it->second)));
+            }
+            AdjustResident(static_cast<int64_t>(RecordBytes(item)));
+            coldRecords.erase(id);
+            onDisk.erase(id);
+            Unlist(id);
+        }
+        memoryIndex[id] = item;
+    }
+
+    void Erase(int id) {
+        if constexpr (HasDuplicateKey) {
+            if (keyIndexBuilt) UnindexKey(id);
+        }
+        auto it = memoryIndex.find(id);
+        if (it != memoryIndex.end()) {
+            if (cacheBudget > 0) {
+                AdjustResident(-static_cast<int64_t>(RecordBytes(it->second)));
+            }
+            memoryIndex.erase(it);
+        }
+        if (cacheBudget > 0) {
+            coldRecords.erase(id);
+            onDisk.erase(id);
+            Unlist(id);
+        }
+    }
+
+    void ClearRecords() {
+        memoryIndex.clear();
+        coldRecords.clear();
+        onDisk.clear();
+        lru.clear();
+        lruPosition.clear();
+        idsByKey.clear();
+        keyById.clear();
+        AdjustResident(-static_cast<int64_t>(residentBytes));
+    }
+
+    bool Contains(int id) const {
+        return memoryIndex.count(id) > 0 || coldRecords.count(id) > 0;
+    }
+
+    size_t Count() const {
+        return memoryIndex.size() + coldRecords.size();
+    }
+
+    std::string ReadRecord(std::ifstream& data, const IndexEntry& entry) const {
+        std::string record(entry.length, '\0');
+        data.clear();
+        data.seekg(static_cast<std::streamoff>(entry.offset));
+        if (!data.read(record.data(), entry.length)) {
+            throw DataAccessException("Cannot read record " + std::to_string(entry.id) + " from " + dataFilePath);
+        }
+        return record;
+    }
+
+    // Evicts the least recently used clean records until the resident ones
+    // fit the budget. The most recent one always stays, so a record that
+    // was just read back is never dropped under the caller.
+    void EnforceBudget() {
+        static Diagnostics::Counter& evictions = Diagnostics::MetricsRegistry::Instance().GetCounter("dal.cache.evictions");
+        while (residentBytes > cacheBudget && lru.size() > 1) {
+            int id = lru.front();
+            Unlist(id);
+            auto it = memoryIndex.find(id);
+            AdjustResident(-static_cast<int64_t>(RecordBytes(it->second)));
+            memoryIndex.erase(it);
+            auto location = onDisk.find(id);
+            coldRecords[id] = location->second;
+            onDisk.erase(location);
+            ++cacheStats.evictions;
+            evictions.Add();
+        }
+    }
+
+    // The resident copy of a record, read back from the data file if it was
+    // evicted; null if there is no such record.
+    const T* Find(int id) {
+        static Diagnostics::Counter& hits = Diagnostics::MetricsRegistry::Instance().GetCounter("dal.cache.hits");
+        static Diagnostics::Counter& misses = Diagnostics::MetricsRegistry::Instance().GetCounter("dal.cache.misses");
+        auto it = memoryIndex.find(id);
+        if (it != memoryIndex.end()) {
+            if (cacheBudget > 0) {
+                ++cacheStats.hits;
+                hits.Add();
+                auto position = lruPosition.find(id);
+                if (position != lruPosition.end()) {
+                    lru.splice(lru.end(), lru, position->second);
+                }
+            }
+            return &it->second;
+        }
+        auto cold = coldRecords.find(id);
+        if (cold == coldRecords.end()) {
+            return nullptr;
+        }
+        ++cacheStats.misses;
+        misses.Add();
+        IndexEntry entry = cold->second;
+        std::ifstream data(dataFilePath, std::ios::binary);
+        T item = T::FromJson(json::parse(ReadRecord(data, entry)));
+        coldRecords.erase(cold);
+        it = memoryIndex.emplace(id, std::move(item)).first;
+        AdjustResident(static_cast<int64_t>(RecordBytes(it->second)));
+        onDisk[id] = entry;
+        List(id);
+        EnforceBudget();
+        return &it->second;
+    }
+
+    // Visits records in id order, from `offset` on and at most `limit` of
+    // them, as visit(item, raw): raw is the record's JSON in the data file
+    // for an evicted record, read without caching it, and empty for a
+    // resident one. Stops early when visit returns false.
+    template<typename Visit>
+    void ForEachRecord(Visit visit, size_t offset = 0,
+                       size_t limit = std::numeric_limits<size_t>::max()) const {
+        std::ifstream data;
+        if (!coldRecords.empty()) {
+            data.open(dataFilePath, std::ios::binary);
+        }
+        const std::string resident;
+        auto next = memoryIndex.begin();
+        auto cold = coldRecords.begin();
+        size_t position = 0;
+        size_t visited = 0;
+        while (visited < limit) {
+            bool fromMemory = cold == coldRecords.end() ||
+                              (next != memoryIndex.end() && next->first < cold->first);
+            if (fromMemory && next == memoryIndex.end()) {
+                return;
+            }
+            if (position++ < offset) {
+                if (fromMemory) ++next; else ++cold;
+                continue;
+            }
+            ++visited;
+            bool more;
+            if (fromMemory) {
+                more = visit(next->second, resident);
+                ++next;
+            } else {
+                std::string raw = ReadRecord(data, cold->second);
+                more = visit(T::FromJson(json::parse(raw)), raw);
+                ++cold;
+            }
+            if (!more) return;
+        }
+    }
+
+    template<typename Visit>
+    void ForEach(Visit visit) const {
+        ForEachRecord([&visit](const T& item, const std::string&) {
+            visit(item);
+            return true;
+        });
+    }
+
+    // After a data file write every record has a new location: evicted
+    // ones move to it and resident ones become evictable.
+    void Relocate(const std::vector<IndexEntry>& entries) {
+        for (const auto& entry : entries) {
+            auto cold = coldRecords.find(entry.id);
+            if (cold != coldRecords.end()) {
+                cold->second = entry;
+                continue;
+            }
+            onDisk[entry.id] = entry;
+            if (lruPosition.count(entry.id) == 0) {
+                List(entry.id);
+            }
+        }
+        EnforceBudget();
+    }
+
+    // Starts a budgeted load with every record evicted, located through a
+    // current id index, so nothing is decoded up front.
+    bool LoadColdIndex() {
+        std::ifstream index;
+        IndexHeader header{};
+        if (!OpenIndex(index, header)) {
+            return false;
+        }
+        std::vector<IndexEntry> entries(header.count);
+        if (!entries.empty() &&
+            !index.read(reinterpret_cast<char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(IndexEntry)))) {
+            return false;
+        }
+        for (const auto& entry : entries) {
+            coldRecords.emplace_hint(coldRecords.end(), entry.id, entry);
+        }
+        return true;
+    }
 
     void LoadIndex() {
         if (indexLoaded) return;
+        static Diagnostics::OperationSite site("dal.wal.load_index");
+        Diagnostics::ScopedOperation operation(site);
 
+        bool located = cacheBudget > 0 && LoadColdIndex();
         std::ifstream dataFile(dataFilePath);
-        if (dataFile.is_open()) {
+        if (!located && dataFile.is_open()) {
             try {
                 json j;
                 dataFile >> j;
                 if (j.is_array()) {
                     for (const auto& elem : j) {
-                        T item = T::FromJson(elem);
-                        memoryIndex[item.GetId()] = item;
+                        Put(T::FromJson(elem));
                     }
                 }
             } catch (...) {}
             dataFile.close();
         }
 
+        deltaSeqs = ListDeltas();
+        for (uint64_t seq : deltaSeqs) {
+            std::ifstream deltaFile(DeltaPath(seq));
+            try {
+                json delta;
+                deltaFile >> delta;
+                for (const auto& elem : delta["upserts"]) {
+                    Put(T::FromJson(elem));
+                }
+                for (const auto& id : delta["removals"]) {
+                    Erase(id.get<int>());
+                }
+            } catch (...) {}
+            nextDeltaSeq = seq + 1;
+        }
+
+        if (!archiveDirectory.empty()) {
+            nextLsn = std::max(nextLsn, WALArchive::LastLsn(archiveDirectory) + 1);
+        }
         ApplyWAL();
         indexLoaded = true;
+
+        if (cacheBudget > 0) {
+            // Records parsed from a data file without a current id index
+            // have nowhere to be evicted to until a compaction writes one.
+            if (!located && residentBytes > cacheBudget) {
+                Compact();
+            }
+            EnforceBudget();
+        }
     }
 
+    // A writer killed mid-append leaves a torn last line. It is cut off here,
+    // otherwise the next append would be glued to it and lost on replay.
     void ApplyWAL() {
-        std::ifstream walFile(walFilePath);
+        Diagnostics::TraceSpan span("dal.wal.apply_wal");
+        std::ifstream walFile(walFilePath, std::ios::binary);
         if (!walFile.is_open()) return;
 
         std::string line;
+        std::streamoff completeBytes = 0;
+        bool tornTail = false;
         while (std::getline(walFile, line)) {
+            if (walFile.eof()) {
+                tornTail = true;
+                break;
+            }
+            completeBytes += static_cast<std::streamoff>(line.size()) + 1;
             if (line.empty()) continue;
             try {
                 json j = json::parse(line);
-                Operation<T> op = Operation<T>::FromJson(j);
-
-                switch (op.type) {
-                    case OperationType::INSERT:
-                    case OperationType::UPDATE:
-                        memoryIndex[op.id] = op.data;
-                        deletedIds.erase(op.id);
-                        break;
-                    case OperationType::DELETE:
-                        memoryIndex.erase(op.id);
-                        deletedIds.insert(op.id);
-                        break;
+                if (j.contains("lsn")) {
+                    uint64_t lsn = j["lsn"].get<uint64_t>();
+                    if (walFirstLsn == 0) walFirstLsn = lsn;
+                    nextLsn = std::max(nextLsn, lsn + 1);
+                }
+                if (j["type"].get<int>() == static_cast<int>(OperationType::BATCH)) {
+                    for (const auto& element : j["ops"]) {
+                        Replay(Operation<T>::FromJson(element));
+                    }
+                } else {
+                    Replay(Operation<T>::FromJson(j));
                 }
             } catch (...) {}
         }
         walFile.close();
+
+        if (tornTail) {
+            std::error_code error;
+            std::filesystem::resize_file(walFilePath, static_cast<uintmax_t>(completeBytes), error);
+        }
+    }
+
+    void Replay(const Operation<T>& op) {
+        switch (op.type) {
+            case OperationType::INSERT:
+            case OperationType::UPDATE:
+                Put(op.data);
+                deletedIds.erase(op.id);
+                dirtyIds.insert(op.id);
+                AddToFilters(op.data);
+                break;
+            case OperationType::DELETE:
+                Erase(op.id);
+                deletedIds.insert(op.id);
+                dirtyIds.insert(op.id);
+                break;
+            case OperationType::BATCH:
+                break;
+        }
+        operationsSinceCompact++;
     }
 
     void AppendToWAL(const Operation<T>& op) {
+        AppendLine(op.ToJson(), 1);
+    }
+
+    void AppendLine(json line, int operations) {
+        uint64_t lsn = nextLsn++;
+        line["lsn"] = lsn;
+        std::string text = line.dump();
         std::ofstream walFile(walFilePath, std::ios::app);
         if (walFile.is_open()) {
-            walFile << op.ToJson().dump() << "\n";
+            walFile << text << "\n";
             walFile.close();
+            IoStats::AddBytesWritten(text.size() + 1);
+            if (fsyncMode == FsyncMode::Always) {
+                SyncFile(walFilePath);
+            }
+            if (walFirstLsn == 0) walFirstLsn = lsn;
         }
-        operationsSinceCompact++;
+        operationsSinceCompact += operations;
 
         if (operationsSinceCompact >= compactThreshold) {
-            Compact();
+            Checkpoint();
         }
     }
 
-    void Compact() {
+    // Files are written to a temporary name and renamed into place, so a
+    // crash leaves either the old or the new file, never a truncated one.
+    // `crashPoint` names the kill point between the two.
+    void WriteAtomically(const std::string& path, const std::string& text, const char* crashPoint) const {
+        std::string tempPath = path + ".tmp";
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            throw std::runtime_error("Cannot open " + tempPath + " for writing");
+        }
+        file << text;
+        file.close();
+        if (!file) {
+            throw std::runtime_error("Cannot write " + tempPath);
+        }
+        IoStats::AddBytesWritten(text.size());
+        if (fsyncMode != FsyncMode::None) {
+            SyncFile(tempPath);
+        }
+        CrashPoint(crashPoint);
+        std::filesystem::rename(tempPath, path);
+    }
+
+    // A data file being built together with its id index and filters. The
+    // records are one per line inside the JSON array, so every record is a
+    // contiguous byte range the index can point at.
+    struct DataFileImage {
+        std::string text = "[";
+        std::vector<IndexEntry> entries;
+        BloomFilter ids;
+        BloomFilter keys;
+    };
+
+    static DataFileImage NewImage(size_t count) {
+        DataFileImage image;
+        image.entries.reserve(count);
+        auto filters = MakeFilters(count);
+        image.ids = std::move(filters.first);
+        image.keys = std::move(filters.second);
+        return image;
+    }
+
+    static void AddToImage(DataFileImage& image, const T& item, const std::string& record) {
+        image.text += image.entries.empty() ? "\n" : ",\n";
+        image.entries.push_back(IndexEntry{static_cast<int32_t>(item.GetId()),
+                                           static_cast<uint32_t>(record.size()), image.text.size()});
+        image.text += record;
+        AddToFilters(item, image.ids, image.keys);
+    }
+
+    static DataFileImage ImageOf(const std::vector<T>& items) {
+        DataFileImage image = NewImage(items.size());
+        for (const auto& item : items) {
+            AddToImage(image, item, item.ToJson().dump());
+        }
+        return image;
+    }
+
+    // Evicted records are copied from the current data file as they are.
+    DataFileImage CurrentImage() const {
+        DataFileImage image = NewImage(Count());
+        ForEachRecord([&image](const T& item, const std::string& raw) {
+            AddToImage(image, item, raw.empty() ? item.ToJson().dump() : raw);
+            return true;
+        });
+        return image;
+    }
+
+    static int64_t WriteTime(const std::string& path) {
+        std::error_code error;
+        auto time = std::filesystem::last_write_time(path, error);
+        return error ? 0 : static_cast<int64_t>(time.time_since_epoch().count());
+    }
+
+    // The id index is written after the data file it describes and records
+    // that file's size and modification time; an index left behind by a
+    // crash in between no longer matches and is ignored. Images are built
+    // in id order, so the entries are sorted by id.
+    void WriteDataFile(DataFileImage& image) const {
+        const std::vector<IndexEntry>& entries = image.entries;
+        image.text += "\n]\n";
+        WriteAtomically(dataFilePath, image.text, "data");
+
+        IndexHeader header{};
+        std::memcpy(header.magic, IndexMagic, sizeof(header.magic));
+        header.dataSize = std::filesystem::file_size(dataFilePath);
+        header.dataTime = WriteTime(dataFilePath);
+        header.count = entries.size();
+        std::string bytes(sizeof(header) + entries.size() * sizeof(IndexEntry), '\0');
+        std::memcpy(bytes.data(), &header, sizeof(header));
+        if (!entries.empty()) {
+            std::memcpy(bytes.data() + sizeof(header), entries.data(), entries.size() * sizeof(IndexEntry));
+        }
+        WriteAtomically(indexFilePath, bytes, "index");
+
+        std::memcpy(header.magic, FilterMagic, sizeof(header.magic));
+        bytes.assign(reinterpret_cast<const char*>(&header), sizeof(header));
+        image.ids.AppendTo(bytes);
+        if constexpr (HasDuplicateKey) {
+            image.keys.AppendTo(bytes);
+        }
+        WriteAtomically(filterFilePath, bytes, "filter");
+    }
+
+    // Opens the id index and reads its header; false unless it describes
+    // the current data file.
+    bool OpenIndex(std::ifstream& index, IndexHeader& header) const {
+        std::error_code error;
+        uint64_t dataSize = std::filesystem::file_size(dataFilePath, error);
+        if (error) {
+            return false;
+        }
+        index.open(indexFilePath, std::ios::binary);
+        return index.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+               std::memcmp(header.magic, IndexMagic, sizeof(header.magic)) == 0 &&
+               header.dataSize == dataSize && header.dataTime == WriteTime(dataFilePath);
+    }
+
+    // Answers a point lookup from the data file through the id index without
+    // loading it: a binary search over the index entries, one seek and one
+    // record decoded, then the WAL lines for that id applied on top. Returns
+    // false when the index is missing or stale or deltas are pending, and
+    // the caller loads everything instead.
+    bool ReadThroughIndex(int id, std::optional<T>& item) const {
+        static Diagnostics::OperationSite site("dal.wal.indexed_lookup");
+        Diagnostics::ScopedOperation operation(site);
+        std::ifstream index;
+        IndexHeader header{};
+        if (!ListDeltas().empty() || !OpenIndex(index, header)) {
+            return false;
+        }
+
+        uint64_t low = 0, high = header.count;
+        IndexEntry entry{};
+        bool indexed = false;
+        while (low < high) {
+            uint64_t middle = low + (high - low) / 2;
+            index.seekg(static_cast<std::streamoff>(sizeof(header) + middle * sizeof(IndexEntry)));
+            if (!index.read(reinterpret_cast<char*>(&entry), sizeof(entry))) {
+                return false;
+            }
+            if (entry.id == id) {
+                indexed = true;
+                break;
+            }
+            if (entry.id < id) low = middle + 1; else high = middle;
+        }
+
+        item.reset();
+        if (indexed) {
+            std::ifstream data(dataFilePath, std::ios::binary);
+            std::string record(entry.length, '\0');
+            data.seekg(static_cast<std::streamoff>(entry.offset));
+            if (!data.read(record.data(), entry.length)) {
+                return false;
+            }
+            try {
+                item = T::FromJson(json::parse(record));
+            } catch (const json::exception&) {
+                return false;
+            }
+            if (item->GetId() != id) {
+                return false;
+            }
+        }
+
+        ScanWAL([&](const json& element) {
+            if (element["id"].get<int>() != id) return;
+            Operation<T> op = Operation<T>::FromJson(element);
+            if (op.type == OperationType::DELETE) {
+                item.reset();
+            } else {
+                item = op.data;
+            }
+        });
+        return true;
+    }
+
+    // Calls visit(operation json) for every operation in the WAL without
+    // loading the index; unreadable and torn lines are skipped.
+    template<typename Visit>
+    void ScanWAL(Visit visit) const {
+        std::ifstream walFile(walFilePath, std::ios::binary);
+        std::string line;
+        while (std::getline(walFile, line)) {
+            if (walFile.eof() || line.empty()) continue;
+            try {
+                json j = json::parse(line);
+                if (j["type"].get<int>() == static_cast<int>(OperationType::BATCH)) {
+                    for (const auto& element : j["ops"]) {
+                        visit(element);
+                    }
+                } else {
+                    visit(j);
+                }
+            } catch (...) {}
+        }
+    }
+
+    static std::pair<BloomFilter, BloomFilter> MakeFilters(size_t expectedKeys) {
+        // Headroom so the filters stay near their rate while records are
+        // added between compactions.
+        size_t capacity = expectedKeys + expectedKeys / 2 + 64;
+        return {BloomFilter(capacity, FilterFalsePositiveRate),
+                HasDuplicateKey ? BloomFilter(capacity, FilterFalsePositiveRate) : BloomFilter()};
+    }
+
+    static void AddToFilters(const T& item, BloomFilter& ids, BloomFilter& keys) {
+        ids.Add(BloomFilter::Hash(item.GetId()));
+        if constexpr (HasDuplicateKey) {
+            keys.Add(BloomFilter::Hash(item.DuplicateKey()));
+        }
+    }
+
+    void AddToFilters(const T& item) {
+        if (!idFilter) return;
+        AddToFilters(item, *idFilter, *keyFilter);
+        if (indexLoaded && idFilter->Saturated()) {
+            idFilter.reset();
+            keyFilter.reset();
+        }
+    }
+
+    // Filters come from "<data>.bloom" topped up with the records in
+    // pending deltas and the WAL while the index is not loaded, and from
+    // memoryIndex once it is. False when neither is available, in which
+    // case lookups go without a filter.
+    bool EnsureFilters() {
+        if (idFilter) return true;
+        if (indexLoaded) {
+            auto filters = MakeFilters(Count());
+            ForEach([&filters](const T& item) {
+                AddToFilters(item, filters.first, filters.second);
+            });
+            idFilter = std::move(filters.first);
+            keyFilter = std::move(filters.second);
+            return true;
+        }
+
+        std::error_code error;
+        uint64_t dataSize = std::filesystem::file_size(dataFilePath, error);
+        if (error) return false;
+        std::ifstream file(filterFilePath, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        IndexHeader header{};
+        if (bytes.size() < sizeof(header)) return false;
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        if (std::memcmp(header.magic, FilterMagic, sizeof(header.magic)) != 0 ||
+            header.dataSize != dataSize || header.dataTime != WriteTime(dataFilePath)) {
+            return false;
+        }
+        size_t offset = sizeof(header);
+        BloomFilter ids, keys;
+        if (!ids.ReadFrom(bytes, offset) || (HasDuplicateKey && !keys.ReadFrom(bytes, offset))) {
+            return false;
+        }
+
+        for (uint64_t seq : ListDeltas()) {
+            std::ifstream deltaFile(DeltaPath(seq));
+            try {
+                json delta;
+                deltaFile >> delta;
+                for (const auto& elem : delta["upserts"]) {
+                    AddToFilters(T::FromJson(elem), ids, keys);
+                }
+            } catch (...) {}
+        }
+        ScanWAL([&](const json& element) {
+            if (element.contains("data")) {
+                AddToFilters(T::FromJson(element["data"]), ids, keys);
+            }
+        });
+        idFilter = std::move(ids);
+        keyFilter = std::move(keys);
+        return true;
+    }
+
+    std::vector<T> AllItems() const {
         std::vector<T> allItems;
+        allItems.reserve(memoryIndex.size());
         for (const auto& pair : memoryIndex) {
             allItems.push_back(pair.second);
         }
+        return allItems;
+    }
 
-        std::ofstream dataFile(dataFilePath);
-        if (!dataFile.is_open()) {
-            throw std::runtime_error("Cannot open data file for compaction");
+    std::string DeltaPath(uint64_t seq) const {
+        return dataFilePath + ".delta-" + std::to_string(seq);
+    }
+
+    std::vector<uint64_t> ListDeltas() const {
+        namespace fs = std::filesystem;
+        fs::path data(dataFilePath);
+        std::string prefix = data.filename().string() + ".delta-";
+        std::vector<uint64_t> seqs;
+        std::error_code error;
+        for (const auto& entry : fs::directory_iterator(data.has_parent_path() ? data.parent_path() : fs::path("."), error)) {
+            std::string name = entry.path().filename().string();
+            if (name.size() > prefix.size() && name.compare(0, prefix.size(), prefix) == 0 &&
+                name.find_first_not_of("0123456789", prefix.size()) == std::string::npos) {
+                seqs.push_back(std::stoull(name.substr(prefix.size())));
+            }
         }
+        std::sort(seqs.begin(), seqs.end());
+        return seqs;
+    }
 
-        json j = json::array();
-        for (const auto& item : allItems) {
-            j.push_back(item.ToJson());
+    // Called when compactThreshold operations have been logged. Falls back
+    // to a full compaction when deltas are off or the archive needs a base
+    // snapshot, which is a copy of a complete data file.
+    void Checkpoint() {
+        bool baseDue = !archiveDirectory.empty() &&
+            (compactionsSinceBase + 1 >= archiveBaseEvery || WALArchive::ListBases(archiveDirectory).empty());
+        if (deltaCheckpoints == 0 || baseDue) {
+            Compact();
+            return;
         }
-        dataFile << j.dump(2);
-        dataFile.close();
 
-        std::ofstream walFile(walFilePath, std::ofstream::trunc);
-        walFile.close();
+        WriteDelta();
+        if (merge.valid() && merge.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            WaitForMerge();
+        }
+        size_t unmerged = static_cast<size_t>(std::count_if(deltaSeqs.begin(), deltaSeqs.end(),
+            [this](uint64_t seq) { return seq > mergingUpTo; }));
+        if (unmerged >= static_cast<size_t>(deltaCheckpoints)) {
+            StartMerge();
+        }
+    }
+
+    void WriteDelta() {
+        static Diagnostics::OperationSite site("dal.wal.checkpoint_delta");
+        Diagnostics::ScopedOperation operation(site);
+        json upserts = json::array();
+        json removals = json::array();
+        for (int id : dirtyIds) {
+            auto it = memoryIndex.find(id);
+            if (it != memoryIndex.end()) {
+                upserts.push_back(it->second.ToJson());
+            } else {
+                removals.push_back(id);
+            }
+        }
+        uint64_t seq = nextDeltaSeq++;
+        json delta = {{"seq", seq}, {"upserts", upserts}, {"removals", removals}};
+        WriteAtomically(DeltaPath(seq), delta.dump(), "delta");
+        deltaSeqs.push_back(seq);
+        FinishCheckpoint(false);
+    }
+
+    // The copy of the records is taken here; serializing and writing the
+    // new data file happen on the merge thread.
+    void StartMerge() {
+        WaitForMerge();
+        if (cacheBudget > 0) {
+            // Evicted records are located in the current data file, so with
+            // a budget it is replaced on this thread.
+            static Diagnostics::OperationSite site("dal.wal.merge");
+            Diagnostics::ScopedOperation operation(site);
+            DataFileImage image = CurrentImage();
+            WriteDataFile(image);
+            std::error_code error;
+            for (uint64_t seq : deltaSeqs) {
+                std::filesystem::remove(DeltaPath(seq), error);
+            }
+            deltaSeqs.clear();
+            Relocate(image.entries);
+            return;
+        }
+        auto items = std::make_shared<std::vector<T>>(AllItems());
+        uint64_t upTo = deltaSeqs.back();
+        std::vector<std::string> folded;
+        for (uint64_t seq : deltaSeqs) {
+            folded.push_back(DeltaPath(seq));
+        }
+        mergingUpTo = upTo;
+        merge = std::async(std::launch::async, [this, items, folded]() {
+            static Diagnostics::OperationSite site("dal.wal.merge");
+            Diagnostics::ScopedOperation operation(site);
+            DataFileImage image = ImageOf(*items);
+            WriteDataFile(image);
+            std::error_code error;
+            for (const auto& path : folded) {
+                std::filesystem::remove(path, error);
+            }
+        });
+    }
+
+    // Full compaction: the whole index is written as the new data file and
+    // every delta is dropped. The WAL is only cleared after the rename;
+    // replaying it over the new snapshot is harmless because every
+    // operation is idempotent.
+    void Compact() {
+        static Diagnostics::OperationSite site("dal.wal.compact");
+        Diagnostics::ScopedOperation operation(site);
+        WaitForMerge();
+        DataFileImage image = CurrentImage();
+        WriteDataFile(image);
+        CrashPoint("checkpoint");
+        if (cacheBudget > 0) {
+            Relocate(image.entries);
+        }
+
+        std::error_code error;
+        for (uint64_t seq : deltaSeqs) {
+            std::filesystem::remove(DeltaPath(seq), error);
+        }
+        deltaSeqs.clear();
+        FinishCheckpoint(true);
+    }
+
+    // Once a checkpoint is durable the WAL it covers is truncated, or with
+    // archiving moved into the archive as a segment. A crash before that
+    // leaves the WAL in place to be replayed and archived next time.
+    void FinishCheckpoint(bool full) {
+        if (archiveDirectory.empty()) {
+            std::ofstream walFile(walFilePath, std::ofstream::trunc);
+            walFile.close();
+        } else {
+            ArchiveSegment();
+            ++compactionsSinceBase;
+            if (full && (compactionsSinceBase >= archiveBaseEvery || WALArchive::ListBases(archiveDirectory).empty())) {
+                ArchiveBase();
+            }
+        }
 
         operationsSinceCompact = 0;
+        walFirstLsn = 0;
         deletedIds.clear();
+        dirtyIds.clear();
+    }
+
+    void ArchiveSegment() {
+        static Diagnostics::OperationSite site("dal.wal.archive");
+        Diagnostics::ScopedOperation operation(site);
+        namespace fs = std::filesystem;
+        fs::create_directories(archiveDirectory);
+        if (walFirstLsn == 0) {
+            return;
+        }
+        fs::path segment = fs::path(archiveDirectory) / WALArchive::SegmentName(walFirstLsn, nextLsn - 1);
+        std::error_code error;
+        fs::rename(walFilePath, segment, error);
+        if (error) {
+            fs::copy_file(walFilePath, segment, fs::copy_options::overwrite_existing);
+        }
+        std::ofstream walFile(walFilePath, std::ofstream::trunc);
+        walFile.close();
+    }
+
+    // Copies the freshly compacted data file in as a base snapshot.
+    void ArchiveBase() {
+        namespace fs = std::filesystem;
+        fs::path base = fs::path(archiveDirectory) /
+            WALArchive::BaseName(nextLsn - 1, std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()));
+        std::string tempBase = base.string() + ".tmp";
+        fs::copy_file(dataFilePath, tempBase, fs::copy_options::overwrite_existing);
+        if (fsyncMode != FsyncMode::None) {
+            SyncFile(tempBase);
+        }
+        CrashPoint("base");
+        fs::rename(tempBase, base);
+        compactionsSinceBase = 0;
+        WALArchive::ApplyRetention(archiveDirectory, archiveKeepBases);
+    }
+
+    ChangeSet<T> Difference(const std::vector<T>& items) {
+        LoadIndex();
+        ChangeSet<T> changes;
+        std::map<int, const T*> given;
+        for (const T& item : items) {
+            given[item.GetId()] = &item;
+        }
+        ForEach([&](const T& current) {
+            auto it = given.find(current.GetId());
+            if (it == given.end()) {
+                changes.removals.push_back(current.GetId());
+                return;
+            }
+            if (!(*it->second == current)) {
+                changes.upserts.push_back(*it->second);
+            }
+            given.erase(it);
+        });
+        for (const auto& pair : given) {
+            changes.upserts.push_back(*pair.second);
+        }
+        return changes;
     }
 
 public:
-    WALJsonStorage(const std::string& dataPath, int compactAfter = 100)
+    WALJsonStorage(const std::string& dataPath, int compactAfter = 100,
+                   FsyncMode fsync = FsyncMode::None)
         : dataFilePath(dataPath),
           walFilePath(dataPath + ".wal"),
+          indexFilePath(dataPath + ".idx"),
+          filterFilePath(dataPath + ".bloom"),
           operationsSinceCompact(0),
           compactThreshold(compactAfter),
+          fsyncMode(fsync),
           indexLoaded(false) {}
 
+    WALJsonStorage(const WALJsonStorage&) = delete;
+    WALJsonStorage& operator=(const WALJsonStorage&) = delete;
+
+    ~WALJsonStorage() {
+        try {
+            WaitForMerge();
+        } catch (...) {}
+    }
+
     void Insert(const T& item) {
+        static Diagnostics::OperationSite site("dal.wal.insert");
+        Diagnostics::ScopedOperation operation(site);
         LoadIndex();
 
         Operation<T> op;
@@ -165,14 +1079,18 @@ public:
         op.data = item;
         op.timestamp = std::chrono::system_clock::now();
 
-        memoryIndex[item.GetId()] = item;
+        Put(item);
+        dirtyIds.insert(item.GetId());
+        AddToFilters(item);
         AppendToWAL(op);
     }
 
     void Update(const T& item) {
+        static Diagnostics::OperationSite site("dal.wal.update");
+        Diagnostics::ScopedOperation operation(site);
         LoadIndex();
 
-        if (memoryIndex.find(item.GetId()) == memoryIndex.end()) {
+        if (!Contains(item.GetId())) {
             throw std::runtime_error("Item not found for update");
         }
 
@@ -182,14 +1100,18 @@ public:
         op.data = item;
         op.timestamp = std::chrono::system_clock::now();
 
-        memoryIndex[item.GetId()] = item;
+        Put(item);
+        dirtyIds.insert(item.GetId());
+        AddToFilters(item);
         AppendToWAL(op);
     }
 
     void Delete(int id) {
+        static Diagnostics::OperationSite site("dal.wal.delete");
+        Diagnostics::ScopedOperation operation(site);
         LoadIndex();
 
-        if (memoryIndex.find(id) == memoryIndex.end()) {
+        if (!Contains(id)) {
             throw std::runtime_error("Item not found for deletion");
         }
 
@@ -198,28 +1120,128 @@ public:
         op.id = id;
         op.timestamp = std::chrono::system_clock::now();
 
-        memoryIndex.erase(id);
+        Erase(id);
         deletedIds.insert(id);
+        dirtyIds.insert(id);
         AppendToWAL(op);
     }
 
+    // Writes the whole change set as one WAL line, so after a crash it is
+    // replayed either completely or, as a torn tail, not at all. Removals
+    // are applied after upserts.
+    void ApplyBatch(const ChangeSet<T>& changes) {
+        static Diagnostics::OperationSite site("dal.wal.apply_batch");
+        Diagnostics::ScopedOperation operation(site);
+        LoadIndex();
+        if (changes.Empty()) return;
+
+        auto now = std::chrono::system_clock::now();
+        json operations = json::array();
+        for (const T& item : changes.upserts) {
+            Operation<T> op;
+            op.type = Contains(item.GetId()) ? OperationType::UPDATE : OperationType::INSERT;
+            op.id = item.GetId();
+            op.data = item;
+            op.timestamp = now;
+            operations.push_back(op.ToJson());
+            Put(item);
+            deletedIds.erase(item.GetId());
+            dirtyIds.insert(item.GetId());
+            AddToFilters(item);
+        }
+        for (int id : changes.removals) {
+            Operation<T> op;
+            op.type = OperationType::DELETE;
+            op.id = id;
+            op.timestamp = now;
+            operations.push_back(op.ToJson());
+            Erase(id);
+            deletedIds.insert(id);
+            dirtyIds.insert(id);
+        }
+
+        json batch = {
+            {"type", static_cast<int>(OperationType::BATCH)},
+            {"timestamp", std::chrono::system_clock::to_time_t(now)},
+            {"ops", operations}
+        };
+        AppendLine(std::move(batch), static_cast<int>(changes.Size()));
+    }
+
+    // Archiving keeps compacted WAL segments and periodic base snapshots in
+    // "<data file>.archive" for point-in-time restore (see WALRestore.h).
+    // Full saves are then logged as the difference to the current state, so
+    // the archive holds every change. keepBases bounds the archive size.
+    void EnableArchive(int keepBases, int baseEvery) {
+        archiveDirectory = dataFilePath + ".archive";
+        archiveKeepBases = keepBases;
+        archiveBaseEvery = std::max(1, baseEvery);
+    }
+
+    const std::string& GetArchiveDirectory() const {
+        return archiveDirectory;
+    }
+
+    uint64_t GetLastLsn() {
+        LoadIndex();
+        return nextLsn - 1;
+    }
+
+    // Checkpoints write deltas of the changed records and every
+    // `mergeAfter` deltas are merged into the data file in the background;
+    // 0 restores full rewrites.
+    void EnableDeltaCheckpoints(int mergeAfter) {
+        deltaCheckpoints = std::max(0, mergeAfter);
+    }
+
+    void ForceCheckpoint() {
+        LoadIndex();
+        Checkpoint();
+    }
+
+    // Blocks until a running merge has finished; rethrows its failure.
+    void WaitForMerge() {
+        if (!merge.valid()) return;
+        std::future<void> finished = std::move(merge);
+        finished.get();
+        uint64_t upTo = mergingUpTo;
+        deltaSeqs.erase(std::remove_if(deltaSeqs.begin(), deltaSeqs.end(),
+            [upTo](uint64_t seq) { return seq <= upTo; }), deltaSeqs.end());
+    }
+
+    size_t GetDeltaCount() const {
+        return deltaSeqs.size();
+    }
+
+    // With a cache budget loading only reads the id index, so lookups go
+    // through the cache rather than straight to the files.
     T LoadById(int id) {
+        if (!indexLoaded && cacheBudget == 0) {
+            std::optional<T> item;
+            if (ReadThroughIndex(id, item)) {
+                if (!item) {
+                    throw std::runtime_error("Item not found");
+                }
+                return *item;
+            }
+        }
         LoadIndex();
 
-        auto it = memoryIndex.find(id);
-        if (it == memoryIndex.end()) {
+        const T* item = Find(id);
+        if (!item) {
             throw std::runtime_error("Item not found");
         }
-        return it->second;
+        return *item;
     }
 
     std::vector<T> LoadAll() {
         LoadIndex();
 
         std::vector<T> result;
-        for (const auto& pair : memoryIndex) {
-            result.push_back(pair.second);
-        }
+        result.reserve(Count());
+        ForEach([&result](const T& item) {
+            result.push_back(item);
+        });
         return result;
     }
 
@@ -227,35 +1249,64 @@ public:
         LoadIndex();
 
         std::vector<T> result;
-        auto it = memoryIndex.begin();
-        std::advance(it, std::min(offset, static_cast<int>(memoryIndex.size())));
-
-        int count = 0;
-        while (it != memoryIndex.end() && count < limit) {
-            result.push_back(it->second);
-            ++it;
-            ++count;
+        if (offset < 0 || limit <= 0) {
+            return result;
         }
+        ForEachRecord([&result](const T& item, const std::string&) {
+            result.push_back(item);
+            return true;
+        }, static_cast<size_t>(offset), static_cast<size_t>(limit));
         return result;
     }
 
     void Save(const std::vector<T>& items) {
-        memoryIndex.clear();
+        if (!archiveDirectory.empty()) {
+            ApplyBatch(Difference(items));
+            return;
+        }
+        ClearRecords();
         for (const auto& item : items) {
-            memoryIndex[item.GetId()] = item;
+            Put(item);
         }
+        idFilter.reset();
+        keyFilter.reset();
         Compact();
         indexLoaded = true;
     }
 
     void Clear() {
-        memoryIndex.clear();
+        if (!archiveDirectory.empty()) {
+            ApplyBatch(Difference({}));
+            return;
+        }
+        ClearRecords();
         deletedIds.clear();
+        idFilter.reset();
+        keyFilter.reset();
         Compact();
     }
 
     int GetCount() const {
-        return memoryIndex.size();
+        return static_cast<int>(Count());
+    }
+
+    // Keeps the resident records within about `bytes`, evicting the least
+    // recently used unchanged ones to their place in the data file; 0 keeps
+    // everything in memory. Must be set before the first access. Only this
+    // storage's records are bounded; LoadAll still returns all of them.
+    void EnableCacheBudget(size_t bytes) {
+        if (indexLoaded) {
+            throw std::logic_error("The cache budget must be set before the storage is loaded");
+        }
+        cacheBudget = bytes;
+    }
+
+    CacheStats GetCacheStats() const {
+        CacheStats stats = cacheStats;
+        stats.residentRecords = memoryIndex.size();
+        stats.evictedRecords = coldRecords.size();
+        stats.residentBytes = residentBytes;
+        return stats;
     }
 
     void ForceCompact() {
@@ -266,9 +1317,64 @@ public:
         return operationsSinceCompact;
     }
 
+    // Absent ids are usually rejected by the id filter without touching
+    // any records; the rest are looked up through the id index or the
+    // loaded index.
     bool Exists(int id) {
+        bool filtered = EnsureFilters();
+        if (filtered) {
+            bool negative = !idFilter->MightContain(BloomFilter::Hash(id));
+            idFilterCounters.Check(negative);
+            if (negative) return false;
+        }
+        bool found;
+        std::optional<T> item;
+        if (!indexLoaded && cacheBudget == 0 && ReadThroughIndex(id, item)) {
+            found = item.has_value();
+        } else {
+            LoadIndex();
+            found = Contains(id);
+        }
+        if (filtered && !found) {
+            idFilterCounters.FalsePositive();
+        }
+        return found;
+    }
+
+    // Whether a record with this DuplicateKey() exists. Absent keys, the
+    // usual case when importing, are mostly answered by the key filter
+    // without loading the index; the rest by the key index.
+    bool ContainsKey(const std::string& key) requires HasDuplicateKey {
+        bool filtered = EnsureFilters();
+        if (filtered) {
+            bool negative = !keyFilter->MightContain(BloomFilter::Hash(key));
+            keyFilterCounters.Check(negative);
+            if (negative) return false;
+        }
         LoadIndex();
-        return memoryIndex.find(id) != memoryIndex.end();
+        if (!keyIndexBuilt) {
+            ForEachRecord([this](const T& item, const std::string&) {
+                IndexKey(item);
+                return true;
+            });
+            keyIndexBuilt = true;
+        }
+        bool found = idsByKey.count(key) > 0;
+        if (found) {
+            return true;
+        }
+        if (filtered) {
+            keyFilterCounters.FalsePositive();
+        }
+        return false;
+    }
+
+    const BloomFilterStats& GetIdFilterStats() const {
+        return idFilterCounters.Stats();
+    }
+
+    const BloomFilterStats& GetKeyFilterStats() const {
+        return keyFilterCounters.Stats();
     }
 
     std::vector<T> LoadByIds(const std::vector<int>& ids) {
@@ -276,9 +1382,8 @@ public:
 
         std::vector<T> result;
         for (int id : ids) {
-            auto it = memoryIndex.find(id);
-            if (it != memoryIndex.end()) {
-                result.push_back(it->second);
+            if (const T* item = Find(id)) {
+                result.push_back(*item);
             }
         }
         return result;
@@ -0,0 +1,204 @@
+#ifndef WALRESTORE_H
+#define WALRESTORE_H
+
+#include "WALArchive.h"
+#include "WALJsonStorage.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <future>
+#include <limits>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace DAL {
+
+// Restore stops before the first WAL line past either bound.
+struct RestoreTarget {
+    uint64_t lsn = std::numeric_limits<uint64_t>::max();
+    std::time_t time = std::numeric_limits<std::time_t>::max();
+
+    bool Includes(uint64_t lineLsn, std::time_t lineTime) const {
+        return lineLsn <= lsn && lineTime <= time;
+    }
+};
+
+struct RestoreReport {
+    std::string basePath;
+    uint64_t baseLsn = 0;
+    size_t segments = 0;
+    size_t records = 0;
+    size_t operations = 0;
+    uint64_t lastLsn = 0;
+    std::time_t lastTime = 0;
+    size_t items = 0;
+    double milliseconds = 0.0;
+};
+
+// Rebuilds the state of a WAL data file at a past LSN or time from its
+// archive: the newest base snapshot not past the target, rolled forward
+// through the archived segments and finally the live WAL. Segments are
+// decoded on up to `threads` threads, a window at a time, and applied in
+// LSN order as each window completes, so memory stays bounded by the
+// window rather than the archive.
+template<typename T>
+class WALRestore {
+private:
+    struct Record {
+        uint64_t lsn = 0;
+        std::time_t time = 0;
+        std::vector<Operation<T>> operations;
+    };
+
+    // Lines without an LSN predate archiving and a torn last line is an
+    // interrupted append; both are skipped.
+    static std::vector<Record> Decode(const std::string& path) {
+        std::vector<Record> records;
+        std::ifstream file(path, std::ios::binary);
+        std::string line;
+        while (std::getline(file, line)) {
+            if (line.empty()) continue;
+            try {
+                json j = json::parse(line);
+                if (!j.contains("lsn")) continue;
+                Record record;
+                record.lsn = j["lsn"].get<uint64_t>();
+                record.time = j["timestamp"].get<std::time_t>();
+                if (j["type"].get<int>() == static_cast<int>(OperationType::BATCH)) {
+                    for (const auto& element : j["ops"]) {
+                        record.operations.push_back(Operation<T>::FromJson(element));
+                    }
+                } else {
+                    record.operations.push_back(Operation<T>::FromJson(j));
+                }
+                records.push_back(std::move(record));
+            } catch (const json::exception&) {
+            }
+        }
+        return records;
+    }
+
+public:
+    static RestoreReport Restore(const std::string& dataPath, const RestoreTarget& target,
+                                 std::map<int, T>& state, unsigned threads = 0) {
+        static Diagnostics::OperationSite site("dal.wal.restore");
+        Diagnostics::ScopedOperation operation(site);
+        auto start = std::chrono::steady_clock::now();
+        std::string archive = dataPath + ".archive";
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        const ArchivedBase* base = nullptr;
+        auto bases = WALArchive::ListBases(archive);
+        for (const auto& candidate : bases) {
+            if (target.Includes(candidate.lsn, candidate.time)) {
+                base = &candidate;
+            }
+        }
+        if (!base) {
+            throw DataAccessException("No base snapshot in " + archive + " at or before the restore target");
+        }
+
+        RestoreReport report;
+        report.basePath = base->path;
+        report.baseLsn = base->lsn;
+        report.lastLsn = base->lsn;
+        report.lastTime = base->time;
+        state.clear();
+        {
+            std::ifstream file(base->path);
+            json items;
+            try {
+                file >> items;
+            } catch (const json::exception& e) {
+                throw DataAccessException("Cannot read base snapshot " + base->path + ": " + e.what());
+            }
+            for (const auto& element : items) {
+                T item = T::FromJson(element);
+                state[item.GetId()] = item;
+            }
+        }
+
+        std::vector<std::string> paths;
+        for (const auto& segment : WALArchive::ListSegments(archive)) {
+            if (segment.lastLsn > base->lsn) {
+                paths.push_back(segment.path);
+            }
+        }
+        paths.push_back(dataPath + ".wal");
+
+        bool done = false;
+        for (size_t window = 0; window < paths.size() && !done; window += threads) {
+            size_t end = std::min(paths.size(), window + threads);
+            std::vector<std::future<std::vector<Record>>> decoded;
+            for (size_t i = window; i < end; ++i) {
+                decoded.push_back(std::async(std::launch::async, &WALRestore::Decode, paths[i]));
+            }
+            for (size_t i = 0; i < decoded.size(); ++i) {
+                auto records = decoded[i].get();
+                if (done) continue;
+                if (window + i + 1 < paths.size()) {
+                    ++report.segments;
+                }
+                for (const Record& record : records) {
+                    if (record.lsn <= report.lastLsn) continue;
+                    if (!target.Includes(record.lsn, record.time)) {
+                        done = true;
+                        break;
+                    }
+                    if (record.lsn != report.lastLsn + 1) {
+                        throw DataAccessException("WAL archive " + archive + " has no record for LSN " +
+                                                  std::to_string(report.lastLsn + 1));
+                    }
+                    for (const auto& op : record.operations) {
+                        if (op.type == OperationType::DELETE) {
+                            state.erase(op.id);
+                        } else {
+                            state[op.id] = op.data;
+                        }
+                    }
+                    ++report.records;
+                    report.operations += record.operations.size();
+                    report.lastLsn = record.lsn;
+                    report.lastTime = record.time;
+                }
+            }
+        }
+
+        report.items = state.size();
+        report.milliseconds = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+        return report;
+    }
+
+    // Writes a restored state in the data file format, replacing `path`
+    // atomically.
+    static void WriteDataFile(const std::map<int, T>& state, const std::string& path) {
+        json items = json::array();
+        for (const auto& pair : state) {
+            items.push_back(pair.second.ToJson());
+        }
+        std::string tempPath = path + ".tmp";
+        {
+            std::ofstream file(tempPath, std::ios::trunc);
+            if (!file.is_open()) {
+                throw DataAccessException("Cannot open file for writing: " + tempPath);
+            }
+            file << items.dump(2);
+            if (!file.good()) {
+                throw DataAccessException("Error writing to file: " + tempPath);
+            }
+        }
+        SyncFile(tempPath);
+        std::filesystem::rename(tempPath, path);
+    }
+};
+
+}
+
+#endif
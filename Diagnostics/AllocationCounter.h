@@ -0,0 +1,75 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace Diagnostics {
+
+struct AllocationSnapshot {
+    uint64_t allocations = 0;
+    uint64_t deallocations = 0;
+    uint64_t bytes = 0;
+
+    AllocationSnapshot operator-(const AllocationSnapshot& other) const {
+        return AllocationSnapshot{
+            allocations - other.allocations,
+            deallocations - other.deallocations,
+            bytes - other.bytes
+        };
+    }
+};
+
+// Process-wide heap counters. They only move when the executable links
+// AllocationHooks.cpp, which replaces the global operator new/delete.
+class AllocationCounter {
+private:
+    static inline std::atomic<uint64_t> allocations{0};
+    static inline std::atomic<uint64_t> deallocations{0};
+    static inline std::atomic<uint64_t> bytes{0};
+    static inline std::atomic<bool> installed{false};
+
+    // Per-thread totals let a scope measure its own thread's allocations
+    // without seeing other threads' traffic.
+    static inline thread_local uint64_t threadAllocations = 0;
+    static inline thread_local uint64_t threadDeallocations = 0;
+    static inline thread_local uint64_t threadBytes = 0;
+
+public:
+    static void RecordAllocation(std::size_t size) noexcept {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        bytes.fetch_add(size, std::memory_order_relaxed);
+        ++threadAllocations;
+        threadBytes += size;
+    }
+
+    static void RecordDeallocation() noexcept {
+        deallocations.fetch_add(1, std::memory_order_relaxed);
+        ++threadDeallocations;
+    }
+
+    static AllocationSnapshot ThreadSnapshot() noexcept {
+        return AllocationSnapshot{threadAllocations, threadDeallocations, threadBytes};
+    }
+
+    static void MarkInstalled() noexcept {
+        installed.store(true, std::memory_order_relaxed);
+    }
+
+    static bool IsInstalled() noexcept {
+        return installed.load(std::memory_order_relaxed);
+    }
+
+    static AllocationSnapshot Snapshot() noexcept {
+        return AllocationSnapshot{
+            allocations.load(std::memory_order_relaxed),
+            deallocations.load(std::memory_order_relaxed),
+            bytes.load(std::memory_order_relaxed)
+        };
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace Diagnostics {
+
+// Log-linear histogram in the style of HdrHistogram. Values below 2^B are
+// counted exactly; above that each power of two is split into 2^(B-1)
+// linear sub-buckets, so any recorded value is reported with a relative
+// error below 2^-(B-1) (under 1% with B = 8). Recording is O(1) and
+// histograms from several threads merge by adding counts.
+class LatencyHistogram {
+private:
+    static constexpr unsigned SubBucketBits = 8;
+    static constexpr uint64_t ExactLimit = uint64_t{1} << SubBucketBits;
+    static constexpr size_t BucketCount =
+        ((64 - SubBucketBits) << (SubBucketBits - 1)) + ExactLimit;
+
+    std::vector<uint64_t> counts;
+    uint64_t total = 0;
+    uint64_t minimum = std::numeric_limits<uint64_t>::max();
+    uint64_t maximum = 0;
+    long double sum = 0;
+
+    static size_t IndexOf(uint64_t value) {
+        if (value < ExactLimit) {
+            return static_cast<size_t>(value);
+        }
+        unsigned magnitude = static_cast<unsigned>(std::bit_width(value)) - SubBucketBits;
+        return (static_cast<size_t>(magnitude) << (SubBucketBits - 1)) + static_cast<size_t>(value >> magnitude);
+    }
+
+    static uint64_t HighestEquivalent(size_t index) {
+        if (index < ExactLimit) {
+            return index;
+        }
+        unsigned magnitude = static_cast<unsigned>(index >> (SubBucketBits - 1)) - 1;
+        uint64_t subBucket = index - (static_cast<size_t>(magnitude) << (SubBucketBits - 1));
+        return ((subBucket + 1) << magnitude) - 1;
+    }
+
+public:
+    LatencyHistogram() : counts(BucketCount, 0) {}
+
+    void Record(uint64_t value) {
+        ++counts[IndexOf(value)];
+        ++total;
+        minimum = std::min(minimum, value);
+        maximum = std::max(maximum, value);
+        sum += value;
+    }
+
+    void Merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < BucketCount; ++i) {
+            counts[i] += other.counts[i];
+        }
+        total += other.total;
+        minimum = std::min(minimum, other.minimum);
+        maximum = std::max(maximum, other.maximum);
+        sum += other.sum;
+    }
+
+    void Reset() {
+        std::fill(counts.begin(), counts.end(), 0);
+        total = 0;
+        minimum = std::numeric_limits<uint64_t>::max();
+        maximum = 0;
+        sum = 0;
+    }
+
+    // Smallest recorded-value bound such that `percentile` percent of the
+    // samples are at or below it.
+    uint64_t Percentile(double percentile) const {
+        if (total == 0) {
+            return 0;
+        }
+        double clamped = std::clamp(percentile, 0.0, 100.0);
+        uint64_t rank = static_cast<uint64_t>(clamped / 100.0 * static_cast<double>(total) + 0.5);
+        rank = std::clamp<uint64_t>(rank, 1, total);
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BucketCount; ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                return std::min(HighestEquivalent(i), maximum);
+            }
+        }
+        return maximum;
+    }
+
+    uint64_t Count() const { return total; }
+    uint64_t Min() const { return total == 0 ? 0 : minimum; }
+    uint64_t Max() const { return maximum; }
+    double Mean() const { return total == 0 ? 0.0 : static_cast<double>(sum / total); }
+};
+
+}
+
+#endif
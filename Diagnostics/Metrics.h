@@ -0,0 +1,502 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "AllocationCounter.h"
+#include "LatencyHistogram.h"
+#include "Trace.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <algorithm>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <nlohmann/json.hpp>
+
+namespace Diagnostics {
+
+constexpr size_t CacheLineSize = 64;
+constexpr size_t MetricShards = 16;
+
+// Threads are spread round-robin over the shards, so concurrent writers to
+// the same metric usually touch different cache lines.
+inline size_t ThreadShard() {
+    static std::atomic<size_t> nextShard{0};
+    thread_local size_t shard = nextShard.fetch_add(1, std::memory_order_relaxed) % MetricShards;
+    return shard;
+}
+
+class Counter {
+private:
+    struct alignas(CacheLineSize) Cell {
+        std::atomic<uint64_t> value{0};
+    };
+    std::array<Cell, MetricShards> cells;
+
+public:
+    void Add(uint64_t amount = 1) {
+        cells[ThreadShard()].value.fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    uint64_t Value() const {
+        uint64_t total = 0;
+        for (const auto& cell : cells) {
+            total += cell.value.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+};
+
+class Gauge {
+private:
+    alignas(CacheLineSize) std::atomic<int64_t> value{0};
+
+public:
+    void Set(int64_t v) { value.store(v, std::memory_order_relaxed); }
+    void Add(int64_t delta) { value.fetch_add(delta, std::memory_order_relaxed); }
+    int64_t Value() const { return value.load(std::memory_order_relaxed); }
+};
+
+// Latencies in nanoseconds. Each shard's histogram (about 60 KB) is only
+// allocated once a thread mapped to that shard records into it.
+class Histogram {
+private:
+    static constexpr size_t Shards = 4;
+
+    struct alignas(CacheLineSize) Shard {
+        std::mutex mutex;
+        std::unique_ptr<LatencyHistogram> histogram;
+    };
+    mutable std::array<Shard, Shards> shards;
+
+public:
+    void Record(uint64_t nanoseconds) {
+        Shard& shard = shards[ThreadShard() % Shards];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (!shard.histogram) {
+            shard.histogram = std::make_unique<LatencyHistogram>();
+        }
+        shard.histogram->Record(nanoseconds);
+    }
+
+    LatencyHistogram Snapshot() const {
+        LatencyHistogram merged;
+        for (auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            if (shard.histogram) {
+                merged.Merge(*shard.histogram);
+            }
+        }
+        return merged;
+    }
+};
+
+// Heap traffic attributed to one operation site. "Inclusive" covers the
+// whole scope including nested instrumented operations; "self" excludes
+// them, so summing self figures over all sites never double counts.
+struct AllocationProfile {
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> selfAllocations{0};
+    std::atomic<uint64_t> selfBytes{0};
+};
+
+struct AllocationProfileRow {
+    std::string name;
+    uint64_t calls;
+    uint64_t allocations;
+    uint64_t bytes;
+    uint64_t selfAllocations;
+    uint64_t selfBytes;
+};
+
+// Process-wide, named metrics. Lookups take a lock, so hot paths resolve
+// their metrics once (see OperationSite) and keep the references, which
+// stay valid for the lifetime of the process.
+class MetricsRegistry {
+private:
+    mutable std::mutex mutex;
+    std::map<std::string, std::unique_ptr<Counter>> counters;
+    std::map<std::string, std::unique_ptr<Gauge>> gauges;
+    std::map<std::string, std::unique_ptr<Histogram>> histograms;
+    std::map<std::string, std::unique_ptr<AllocationProfile>> allocationProfiles;
+    static inline std::atomic<bool> enabled{true};
+    static inline std::atomic<bool> allocationProfiling{false};
+
+    template<typename M>
+    M& GetOrCreate(std::map<std::string, std::unique_ptr<M>>& metrics, const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& slot = metrics[name];
+        if (!slot) {
+            slot = std::make_unique<M>();
+        }
+        return *slot;
+    }
+
+    static std::string PrometheusName(const std::string& name) {
+        std::string result = "gradejournal_";
+        for (char c : name) {
+            if (c >= 'A' && c <= 'Z') {
+                result += static_cast<char>(c - 'A' + 'a');
+            } else {
+                bool valid = (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9');
+                result += valid ? c : '_';
+            }
+        }
+        return result;
+    }
+
+    static std::string LabelValue(const std::string& value) {
+        std::string result;
+        for (char c : value) {
+            if (c == '\\' || c == '"') result += '\\';
+            if (c == '\n') {
+                result += "\\n";
+                continue;
+            }
+            result += c;
+        }
+        return result;
+    }
+
+public:
+    static MetricsRegistry& Instance() {
+        static MetricsRegistry registry;
+        return registry;
+    }
+
+    static void SetEnabled(bool value) { enabled.store(value, std::memory_order_relaxed); }
+    static bool Enabled() { return enabled.load(std::memory_order_relaxed); }
+
+    Counter& GetCounter(const std::string& name) { return GetOrCreate(counters, name); }
+    Gauge& GetGauge(const std::string& name) { return GetOrCreate(gauges, name); }
+    Histogram& GetHistogram(const std::string& name) { return GetOrCreate(histograms, name); }
+    AllocationProfile& GetAllocationProfile(const std::string& name) { return GetOrCreate(allocationProfiles, name); }
+
+    // Attribution only sees allocations when the executable links
+    // AllocationHooks.cpp (GradeJournal does with GRADEJOURNAL_ALLOC_HOOKS);
+    // otherwise every profile stays at zero.
+    static void SetAllocationProfiling(bool value) { allocationProfiling.store(value, std::memory_order_relaxed); }
+    static bool AllocationProfiling() { return allocationProfiling.load(std::memory_order_relaxed); }
+
+    // Sites that ran while profiling, heaviest self bytes first.
+    std::vector<AllocationProfileRow> AllocationProfiles() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<AllocationProfileRow> rows;
+        for (const auto& [name, profile] : allocationProfiles) {
+            uint64_t calls = profile->calls.load(std::memory_order_relaxed);
+            if (calls == 0) continue;
+            rows.push_back({name, calls,
+                            profile->allocations.load(std::memory_order_relaxed),
+                            profile->bytes.load(std::memory_order_relaxed),
+                            profile->selfAllocations.load(std::memory_order_relaxed),
+                            profile->selfBytes.load(std::memory_order_relaxed)});
+        }
+        std::sort(rows.begin(), rows.end(),
+            [](const AllocationProfileRow& a, const AllocationProfileRow& b) { return a.selfBytes > b.selfBytes; });
+        return rows;
+    }
+
+    void ResetAllocationProfiles() {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& [name, profile] : allocationProfiles) {
+            profile->calls = 0;
+            profile->allocations = 0;
+            profile->bytes = 0;
+            profile->selfAllocations = 0;
+            profile->selfBytes = 0;
+        }
+    }
+
+    void PrintAllocationProfiles(std::ostream& out, size_t limit = 25) const {
+        auto rows = AllocationProfiles();
+        out << "\n=== ALLOCATIONS BY OPERATION ===\n";
+        if (!AllocationCounter::IsInstalled()) {
+            out << "Allocation hooks are not linked into this executable.\n";
+            return;
+        }
+        if (rows.empty()) {
+            out << "No instrumented operations ran while profiling.\n";
+            return;
+        }
+        out << std::left << std::setw(40) << "Operation" << std::right
+            << std::setw(9) << "Calls" << std::setw(14) << "Allocs/call" << std::setw(14) << "Bytes/call"
+            << std::setw(14) << "Self allocs" << std::setw(14) << "Self bytes" << "\n";
+        out << std::fixed << std::setprecision(1);
+        for (size_t i = 0; i < std::min(limit, rows.size()); ++i) {
+            const auto& row = rows[i];
+            double calls = static_cast<double>(row.calls);
+            out << std::left << std::setw(40) << row.name << std::right
+                << std::setw(9) << row.calls
+                << std::setw(14) << row.allocations / calls << std::setw(14) << row.bytes / calls
+                << std::setw(14) << row.selfAllocations / calls << std::setw(14) << row.selfBytes / calls << "\n";
+        }
+        out << "(self columns are per call and exclude nested operations)\n";
+    }
+
+    nlohmann::json ToJson() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        nlohmann::json root = {
+            {"counters", nlohmann::json::object()},
+            {"gauges", nlohmann::json::object()},
+            {"operations", nlohmann::json::object()},
+            {"allocations", nlohmann::json::object()}
+        };
+        for (const auto& [name, counter] : counters) {
+            root["counters"][name] = counter->Value();
+        }
+        for (const auto& [name, profile] : allocationProfiles) {
+            if (profile->calls.load(std::memory_order_relaxed) == 0) continue;
+            root["allocations"][name] = {
+                {"calls", profile->calls.load(std::memory_order_relaxed)},
+                {"allocations", profile->allocations.load(std::memory_order_relaxed)},
+                {"bytes", profile->bytes.load(std::memory_order_relaxed)},
+                {"selfAllocations", profile->selfAllocations.load(std::memory_order_relaxed)},
+                {"selfBytes", profile->selfBytes.load(std::memory_order_relaxed)}
+            };
+        }
+        for (const auto& [name, gauge] : gauges) {
+            root["gauges"][name] = gauge->Value();
+        }
+        for (const auto& [name, histogram] : histograms) {
+            LatencyHistogram h = histogram->Snapshot();
+            root["operations"][name] = {
+                {"count", h.Count()},
+                {"meanUs", h.Mean() / 1000.0},
+                {"p50Us", h.Percentile(50) / 1000.0},
+                {"p90Us", h.Percentile(90) / 1000.0},
+                {"p99Us", h.Percentile(99) / 1000.0},
+                {"p999Us", h.Percentile(99.9) / 1000.0},
+                {"maxUs", h.Max() / 1000.0}
+            };
+        }
+        return root;
+    }
+
+    // Prometheus text exposition format. Histograms are exported as one
+    // summary family labelled by operation name.
+    std::string ToPrometheus() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::ostringstream out;
+        out << std::setprecision(9);
+        for (const auto& [name, counter] : counters) {
+            std::string metric = PrometheusName(name) + "_total";
+            out << "# TYPE " << metric << " counter\n" << metric << " " << counter->Value() << "\n";
+        }
+        for (const auto& [name, gauge] : gauges) {
+            std::string metric = PrometheusName(name);
+            out << "# TYPE " << metric << " gauge\n" << metric << " " << gauge->Value() << "\n";
+        }
+        if (!histograms.empty()) {
+            out << "# TYPE gradejournal_operation_seconds summary\n";
+        }
+        for (const auto& [name, histogram] : histograms) {
+            LatencyHistogram h = histogram->Snapshot();
+            std::string label = "op=\"" + LabelValue(name) + "\"";
+            for (double quantile : {0.5, 0.9, 0.99, 0.999}) {
+                out << "gradejournal_operation_seconds{" << label << ",quantile=\"" << quantile << "\"} "
+                    << h.Percentile(quantile * 100.0) / 1e9 << "\n";
+            }
+            out << "gradejournal_operation_seconds_sum{" << label << "} " << h.Mean() * h.Count() / 1e9 << "\n"
+                << "gradejournal_operation_seconds_count{" << label << "} " << h.Count() << "\n";
+        }
+        return out.str();
+    }
+
+    // Paths ending in ".json" get the JSON snapshot, anything else the
+    // Prometheus text format. The file is replaced atomically so a scraper
+    // never reads a partial dump.
+    void WriteToFile(const std::string& path) const {
+        bool asJson = std::filesystem::path(path).extension() == ".json";
+        std::string text = asJson ? ToJson().dump(2) + "\n" : ToPrometheus();
+        std::string tempPath = path + ".tmp";
+        {
+            std::ofstream file(tempPath, std::ios::trunc);
+            if (!file.is_open()) {
+                throw std::runtime_error("Cannot open metrics file: " + tempPath);
+            }
+            file << text;
+            if (!file.good()) {
+                throw std::runtime_error("Cannot write metrics file: " + tempPath);
+            }
+        }
+        std::filesystem::rename(tempPath, path);
+    }
+};
+
+// The metrics behind one instrumented call site: a latency histogram named
+// after the operation and a "<name>.errors" counter. Declare it static at
+// the call site so the registry lookup happens once.
+struct OperationSite {
+    const char* name;
+    Histogram& latency;
+    Counter& errors;
+    AllocationProfile& allocations;
+
+    explicit OperationSite(const std::string& operationName)
+        : name(Tracer::Instance().Intern(operationName)),
+          latency(MetricsRegistry::Instance().GetHistogram(operationName)),
+          errors(MetricsRegistry::Instance().GetCounter(operationName + ".errors")),
+          allocations(MetricsRegistry::Instance().GetAllocationProfile(operationName)) {}
+};
+
+// Records the enclosing scope's latency; a scope left by an exception also
+// counts as an error. While tracing is on the scope is also emitted as a
+// trace span, and while allocation profiling is on the thread's heap
+// traffic during the scope is attributed to the site. With all three off
+// it costs three flag checks.
+class ScopedOperation {
+private:
+    OperationSite& site;
+    bool measured;
+    bool traced;
+    bool profiled;
+    std::chrono::steady_clock::time_point start;
+    int exceptionsAtStart = 0;
+
+    AllocationSnapshot allocationsAtStart;
+    uint64_t nestedAllocations = 0;
+    uint64_t nestedBytes = 0;
+    uint64_t bookkeepingAllocations = 0;
+    uint64_t bookkeepingBytes = 0;
+    ScopedOperation* enclosing = nullptr;
+    static inline thread_local ScopedOperation* innermost = nullptr;
+
+    // Heap use by the instrumentation itself (lazily created histogram
+    // shards, trace buffers) is excluded from every enclosing scope.
+    void AttributeAllocations(const AllocationSnapshot& atEnd) {
+        AllocationSnapshot used = atEnd - allocationsAtStart;
+        used.allocations -= bookkeepingAllocations;
+        used.bytes -= bookkeepingBytes;
+        AllocationSnapshot bookkeeping = AllocationCounter::ThreadSnapshot() - atEnd;
+
+        AllocationProfile& profile = site.allocations;
+        profile.calls.fetch_add(1, std::memory_order_relaxed);
+        profile.allocations.fetch_add(used.allocations, std::memory_order_relaxed);
+        profile.bytes.fetch_add(used.bytes, std::memory_order_relaxed);
+        profile.selfAllocations.fetch_add(used.allocations - nestedAllocations, std::memory_order_relaxed);
+        profile.selfBytes.fetch_add(used.bytes - nestedBytes, std::memory_order_relaxed);
+        innermost = enclosing;
+        if (enclosing) {
+            enclosing->nestedAllocations += used.allocations;
+            enclosing->nestedBytes += used.bytes;
+            enclosing->bookkeepingAllocations += bookkeepingAllocations + bookkeeping.allocations;
+            enclosing->bookkeepingBytes += bookkeepingBytes + bookkeeping.bytes;
+        }
+    }
+
+public:
+    explicit ScopedOperation(OperationSite& operationSite)
+        : site(operationSite),
+          measured(MetricsRegistry::Enabled()),
+          traced(Tracer::Enabled()),
+          profiled(MetricsRegistry::AllocationProfiling()) {
+        if (profiled) {
+            enclosing = innermost;
+            innermost = this;
+            allocationsAtStart = AllocationCounter::ThreadSnapshot();
+        }
+        if (measured || traced) {
+            exceptionsAtStart = std::uncaught_exceptions();
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ScopedOperation(const ScopedOperation&) = delete;
+    ScopedOperation& operator=(const ScopedOperation&) = delete;
+
+    ~ScopedOperation() {
+        AllocationSnapshot atEnd;
+        if (profiled) {
+            atEnd = AllocationCounter::ThreadSnapshot();
+        }
+        if (measured || traced) {
+            auto end = std::chrono::steady_clock::now();
+            if (measured) {
+                site.latency.Record(static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+                if (std::uncaught_exceptions() > exceptionsAtStart) {
+                    site.errors.Add();
+                }
+            }
+            if (traced) {
+                Tracer& tracer = Tracer::Instance();
+                tracer.Record(site.name, tracer.ToTraceTime(start), tracer.ToTraceTime(end));
+            }
+        }
+        if (profiled) {
+            AttributeAllocations(atEnd);
+        }
+    }
+};
+
+// Writes the registry to a file every `interval` (if non-zero), whenever
+// Request() is called, and once more on destruction. Request() only sets
+// a flag, so it may be called from a signal handler.
+class MetricsDumper {
+private:
+    std::string path;
+    std::chrono::seconds interval;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::thread worker;
+    static inline std::atomic<bool> requested{false};
+
+    void Dump() {
+        try {
+            MetricsRegistry::Instance().WriteToFile(path);
+        } catch (const std::exception& e) {
+            std::cerr << "Metrics dump failed: " << e.what() << std::endl;
+        }
+    }
+
+    void Loop() {
+        auto nextDump = std::chrono::steady_clock::now() + interval;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping) {
+            wake.wait_for(lock, std::chrono::milliseconds(200));
+            bool due = interval.count() > 0 && std::chrono::steady_clock::now() >= nextDump;
+            if (requested.exchange(false) || due) {
+                lock.unlock();
+                Dump();
+                lock.lock();
+                nextDump = std::chrono::steady_clock::now() + interval;
+            }
+        }
+    }
+
+public:
+    MetricsDumper(const std::string& filePath, std::chrono::seconds dumpInterval)
+        : path(filePath), interval(dumpInterval), worker([this]() { Loop(); }) {}
+
+    ~MetricsDumper() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        worker.join();
+        Dump();
+    }
+
+    static void Request() noexcept {
+        requested.store(true, std::memory_order_relaxed);
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,202 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace Diagnostics {
+
+struct TraceEvent {
+    const char* name;
+    uint64_t startNs;
+    uint64_t durationNs;
+};
+
+// Events of one thread. Only the owning thread appends; it publishes the new
+// size with a release store, so a concurrent writer of the trace file reads
+// completed events without any lock. A full buffer drops further events.
+class TraceBuffer {
+private:
+    std::unique_ptr<TraceEvent[]> events;
+    std::atomic<size_t> size{0};
+    std::atomic<uint64_t> dropped{0};
+
+public:
+    static constexpr size_t Capacity = size_t{1} << 16;
+    const uint32_t threadId;
+
+    explicit TraceBuffer(uint32_t id) : events(new TraceEvent[Capacity]), threadId(id) {}
+
+    void Append(const TraceEvent& event) {
+        size_t index = size.load(std::memory_order_relaxed);
+        if (index == Capacity) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        events[index] = event;
+        size.store(index + 1, std::memory_order_release);
+    }
+
+    size_t Size() const { return size.load(std::memory_order_acquire); }
+    const TraceEvent& At(size_t index) const { return events[index]; }
+    uint64_t Dropped() const { return dropped.load(std::memory_order_relaxed); }
+};
+
+// Collects scoped spans into per-thread buffers and writes them as Chrome
+// trace-event JSON, which Perfetto and chrome://tracing open directly.
+// While disabled a span costs one relaxed load.
+class Tracer {
+private:
+    static inline std::atomic<bool> enabled{false};
+
+    std::mutex mutex;
+    std::vector<std::shared_ptr<TraceBuffer>> buffers;
+    std::set<std::string> names;
+    const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+    TraceBuffer& ThreadBuffer() {
+        thread_local std::shared_ptr<TraceBuffer> buffer = [this]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto created = std::make_shared<TraceBuffer>(static_cast<uint32_t>(buffers.size() + 1));
+            buffers.push_back(created);
+            return created;
+        }();
+        return *buffer;
+    }
+
+public:
+    static Tracer& Instance() {
+        static Tracer tracer;
+        return tracer;
+    }
+
+    static bool Enabled() { return enabled.load(std::memory_order_relaxed); }
+    static void SetEnabled(bool value) { enabled.store(value, std::memory_order_relaxed); }
+
+    // Signal-safe: only flips the flag.
+    static void Toggle() { enabled.store(!enabled.load(std::memory_order_relaxed), std::memory_order_relaxed); }
+
+    // Spans keep a raw pointer to their name, so names that are not string
+    // literals must be interned first.
+    const char* Intern(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return names.insert(name).first->c_str();
+    }
+
+    uint64_t ToTraceTime(std::chrono::steady_clock::time_point time) const {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(time - epoch).count());
+    }
+
+    uint64_t Now() const {
+        return ToTraceTime(std::chrono::steady_clock::now());
+    }
+
+    void Record(const char* name, uint64_t startNs, uint64_t endNs) {
+        ThreadBuffer().Append(TraceEvent{name, startNs, endNs - startNs});
+    }
+
+    nlohmann::json ToChromeJson() {
+        std::vector<std::shared_ptr<TraceBuffer>> snapshot;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            snapshot = buffers;
+        }
+#ifdef _WIN32
+        int pid = _getpid();
+#else
+        int pid = static_cast<int>(getpid());
+#endif
+        nlohmann::json events = nlohmann::json::array();
+        uint64_t dropped = 0;
+        for (const auto& buffer : snapshot) {
+            events.push_back({{"name", "thread_name"}, {"ph", "M"}, {"pid", pid}, {"tid", buffer->threadId},
+                              {"args", {{"name", "thread " + std::to_string(buffer->threadId)}}}});
+            size_t count = buffer->Size();
+            for (size_t i = 0; i < count; ++i) {
+                const TraceEvent& event = buffer->At(i);
+                events.push_back({{"name", event.name}, {"cat", "gradejournal"}, {"ph", "X"},
+                                  {"ts", event.startNs / 1000.0}, {"dur", event.durationNs / 1000.0},
+                                  {"pid", pid}, {"tid", buffer->threadId}});
+            }
+            dropped += buffer->Dropped();
+        }
+        return {{"traceEvents", events}, {"displayTimeUnit", "ms"},
+                {"otherData", {{"droppedEvents", dropped}}}};
+    }
+
+    void WriteChromeTrace(const std::string& path) {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file.is_open()) {
+            throw std::runtime_error("Cannot open trace file: " + path);
+        }
+        file << ToChromeJson().dump();
+        if (!file.good()) {
+            throw std::runtime_error("Cannot write trace file: " + path);
+        }
+    }
+};
+
+class TraceSpan {
+private:
+    const char* name;
+    uint64_t start = 0;
+
+public:
+    explicit TraceSpan(const char* spanName)
+        : name(Tracer::Enabled() ? spanName : nullptr) {
+        if (name) start = Tracer::Instance().Now();
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    ~TraceSpan() {
+        if (name) {
+            Tracer& tracer = Tracer::Instance();
+            tracer.Record(name, start, tracer.Now());
+        }
+    }
+};
+
+// Turns tracing on for its lifetime and writes the trace file when it ends.
+class TraceSession {
+private:
+    std::string path;
+
+public:
+    explicit TraceSession(const std::string& tracePath) : path(tracePath) {
+        Tracer::SetEnabled(true);
+    }
+
+    TraceSession(const TraceSession&) = delete;
+    TraceSession& operator=(const TraceSession&) = delete;
+
+    ~TraceSession() {
+        Tracer::SetEnabled(false);
+        try {
+            Tracer::Instance().WriteChromeTrace(path);
+        } catch (const std::exception& e) {
+            std::cerr << "Trace write failed: " << e.what() << std::endl;
+        }
+    }
+};
+
+}
+
+#endif
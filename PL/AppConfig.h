@@ -0,0 +1,336 @@
+#ifndef APPCONFIG_H
+#define APPCONFIG_H
+
+#include "StorageFactory.h"
+#include <fstream>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace PL {
+
+class ConfigException : public std::runtime_error {
+public:
+    explicit ConfigException(const std::string& message)
+        : std::runtime_error(message) {}
+};
+
+// Runtime settings read from a JSON file and then overridden by
+// "--set key.path=value" arguments. Example file:
+//   {
+//     "storage": {
+//       "students": { "backend": "wal", "compactAfter": 50, "fsync": "compact",
+//                     "archive": true, "archiveKeepBases": 3, "archiveBaseEvery": 10,
+//                     "deltaCheckpoints": 8 },
+//       "groups":   { "backend": "json", "fsync": "none" }
+//     },
+//     "threads": 4,
+//     "indexes": { "namePrefix": true },
+//     "journals": "faculties",
+//     "backups": "faculties/backups",
+//     "metrics": { "enabled": true, "file": "metrics.prom", "intervalSeconds": 10 }
+//   }
+struct AppConfig {
+    DAL::StorageOptions students;
+    DAL::StorageOptions groups{DAL::StorageType::Simple};
+    size_t threads = 0;
+    bool namePrefixIndex = true;
+    std::string journalsDirectory;
+    // Socket clients may only write backups into this directory; empty
+    // means "<journals>/backups".
+    std::string backupDirectory;
+    bool metricsEnabled = true;
+    std::string metricsFile;
+    int metricsIntervalSeconds = 0;
+
+    static AppConfig Load(const std::string& path, const std::vector<std::string>& overrides) {
+        json root = json::object();
+        if (!path.empty()) {
+            std::ifstream file(path);
+            if (!file.is_open()) {
+                throw ConfigException("Cannot open config file: " + path);
+            }
+            try {
+                file >> root;
+            } catch (const json::exception& e) {
+                throw ConfigException("Invalid JSON in " + path + ": " + e.what());
+            }
+        }
+        for (const auto& assignment : overrides) {
+            ApplyOverride(root, assignment);
+        }
+        return FromJson(root);
+    }
+
+    static void ApplyOverride(json& root, const std::string& assignment) {
+        size_t equals = assignment.find('=');
+        if (equals == std::string::npos || equals == 0) {
+            throw ConfigException("Override must look like key.path=value: " + assignment);
+        }
+        std::string key = assignment.substr(0, equals);
+        std::string text = assignment.substr(equals + 1);
+
+        json value;
+        try {
+            value = json::parse(text);
+        } catch (const json::exception&) {
+            value = text;
+        }
+
+        json* node = &root;
+        size_t start = 0;
+        while (true) {
+            size_t dot = key.find('.', start);
+            std::string part = key.substr(start, dot == std::string::npos ? std::string::npos : dot - start);
+            if (part.empty()) {
+                throw ConfigException("Invalid override key: " + key);
+            }
+            if (!node->is_object()) {
+                *node = json::object();
+            }
+            if (dot == std::string::npos) {
+                (*node)[part] = value;
+                return;
+            }
+            node = &(*node)[part];
+            start = dot + 1;
+        }
+    }
+
+    static AppConfig FromJson(const json& root) {
+        AppConfig config;
+        std::vector<std::string> errors;
+
+        CheckKeys(root, "", {"storage", "threads", "indexes", "journals", "backups", "metrics"}, errors);
+
+        if (root.contains("storage")) {
+            const json& storage = root["storage"];
+            CheckKeys(storage, "storage.", {"students", "groups"}, errors);
+            if (storage.is_object() && storage.contains("students")) {
+                ReadStorage(storage["students"], "storage.students.",
+                            {"backend", "compactAfter", "fsync", "archive", "archiveKeepBases",
+                             "archiveBaseEvery", "deltaCheckpoints"}, config.students, errors);
+            }
+            if (storage.is_object() && storage.contains("groups")) {
+                ReadStorage(storage["groups"], "storage.groups.", {"backend", "fsync"}, config.groups, errors);
+            }
+        }
+
+        if (root.contains("threads")) {
+            const json& threads = root["threads"];
+            if (!threads.is_number_integer() || threads.get<long long>() < 0 || threads.get<long long>() > 256) {
+                errors.push_back("threads: expected an integer between 0 (hardware concurrency) and 256");
+            } else {
+                config.threads = threads.get<size_t>();
+            }
+        }
+
+        if (root.contains("indexes")) {
+            const json& indexes = root["indexes"];
+            CheckKeys(indexes, "indexes.", {"namePrefix"}, errors);
+            if (indexes.is_object() && indexes.contains("namePrefix")) {
+                if (!indexes["namePrefix"].is_boolean()) {
+                    errors.push_back("indexes.namePrefix: expected true or false");
+                } else {
+                    config.namePrefixIndex = indexes["namePrefix"].get<bool>();
+                }
+            }
+        }
+
+        if (root.contains("journals")) {
+            if (!root["journals"].is_string()) {
+                errors.push_back("journals: expected a directory path");
+            } else {
+                config.journalsDirectory = root["journals"].get<std::string>();
+            }
+        }
+
+        if (root.contains("backups")) {
+            if (!root["backups"].is_string()) {
+                errors.push_back("backups: expected a directory path");
+            } else {
+                config.backupDirectory = root["backups"].get<std::string>();
+            }
+        }
+
+        if (root.contains("metrics")) {
+            const json& metrics = root["metrics"];
+            CheckKeys(metrics, "metrics.", {"enabled", "file", "intervalSeconds"}, errors);
+            if (metrics.is_object() && metrics.contains("enabled")) {
+                if (!metrics["enabled"].is_boolean()) {
+                    errors.push_back("metrics.enabled: expected true or false");
+                } else {
+                    config.metricsEnabled = metrics["enabled"].get<bool>();
+                }
+            }
+            if (metrics.is_object() && metrics.contains("file")) {
+                if (!metrics["file"].is_string()) {
+                    errors.push_back("metrics.file: expected a path (\".json\" for JSON, otherwise Prometheus text)");
+                } else {
+                    config.metricsFile = metrics["file"].get<std::string>();
+                }
+            }
+            if (metrics.is_object() && metrics.contains("intervalSeconds")) {
+                const json& value = metrics["intervalSeconds"];
+                if (!value.is_number_integer() || value.get<long long>() < 0 || value.get<long long>() > 86400) {
+                    errors.push_back("metrics.intervalSeconds: expected an integer between 0 (on demand only) and 86400");
+                } else {
+                    config.metricsIntervalSeconds = value.get<int>();
+                }
+            }
+        }
+
+        if (!errors.empty()) {
+            std::string message = "Invalid configuration:";
+            for (const auto& error : errors) {
+                message += "\n  " + error;
+            }
+            throw ConfigException(message);
+        }
+        return config;
+    }
+
+    json ToJson() const {
+        return {
+            {"storage", {
+                {"students", {
+                    {"backend", BackendName(students.type)},
+                    {"compactAfter", students.compactAfter},
+                    {"fsync", FsyncName(students.fsync)},
+                    {"archive", students.archive},
+                    {"archiveKeepBases", students.archiveKeepBases},
+                    {"archiveBaseEvery", students.archiveBaseEvery},
+                    {"deltaCheckpoints", students.deltaCheckpoints}
+                }},
+                {"groups", {
+                    {"backend", BackendName(groups.type)},
+                    {"fsync", FsyncName(groups.fsync)}
+                }}
+            }},
+            {"threads", threads},
+            {"indexes", {{"namePrefix", namePrefixIndex}}},
+            {"journals", journalsDirectory},
+            {"backups", backupDirectory},
+            {"metrics", {
+                {"enabled", metricsEnabled},
+                {"file", metricsFile},
+                {"intervalSeconds", metricsIntervalSeconds}
+            }}
+        };
+    }
+
+private:
+    static std::string BackendName(DAL::StorageType type) {
+        return type == DAL::StorageType::WAL ? "wal" : "json";
+    }
+
+    static std::string FsyncName(DAL::FsyncMode mode) {
+        switch (mode) {
+            case DAL::FsyncMode::OnCompact: return "compact";
+            case DAL::FsyncMode::Always: return "always";
+            default: return "none";
+        }
+    }
+
+    static void CheckKeys(const json& node, const std::string& prefix,
+                          const std::set<std::string>& allowed, std::vector<std::string>& errors) {
+        if (!node.is_object()) {
+            errors.push_back((prefix.empty() ? "<root>" : prefix.substr(0, prefix.size() - 1)) +
+                             ": expected an object");
+            return;
+        }
+        for (const auto& item : node.items()) {
+            if (allowed.count(item.key()) == 0) {
+                errors.push_back(prefix + item.key() + ": unknown setting");
+            }
+        }
+    }
+
+    static void ReadStorage(const json& node, const std::string& prefix, const std::set<std::string>& allowed,
+                            DAL::StorageOptions& options, std::vector<std::string>& errors) {
+        CheckKeys(node, prefix, allowed, errors);
+        if (!node.is_object()) {
+            return;
+        }
+
+        if (node.contains("backend")) {
+            std::string backend = node["backend"].is_string() ? node["backend"].get<std::string>() : "";
+            if (backend == "json") {
+                options.type = DAL::StorageType::Simple;
+            } else if (backend == "wal") {
+                options.type = DAL::StorageType::WAL;
+            } else {
+                errors.push_back(prefix + "backend: expected \"json\" or \"wal\"");
+            }
+        }
+
+        if (node.contains("compactAfter")) {
+            const json& value = node["compactAfter"];
+            if (!value.is_number_integer() || value.get<long long>() < 1 || value.get<long long>() > 1000000) {
+                errors.push_back(prefix + "compactAfter: expected an integer between 1 and 1000000");
+            } else {
+                options.compactAfter = value.get<int>();
+            }
+        }
+
+        if (node.contains("fsync")) {
+            std::string mode = node["fsync"].is_string() ? node["fsync"].get<std::string>() : "";
+            if (mode == "none") {
+                options.fsync = DAL::FsyncMode::None;
+            } else if (mode == "compact") {
+                options.fsync = DAL::FsyncMode::OnCompact;
+            } else if (mode == "always") {
+                options.fsync = DAL::FsyncMode::Always;
+            } else {
+                errors.push_back(prefix + "fsync: expected \"none\", \"compact\" or \"always\"");
+            }
+        }
+
+        if (node.contains("archive")) {
+            if (!node["archive"].is_boolean()) {
+                errors.push_back(prefix + "archive: expected true or false");
+            } else {
+                options.archive = node["archive"].get<bool>();
+            }
+        }
+
+        if (node.contains("archiveKeepBases")) {
+            const json& value = node["archiveKeepBases"];
+            if (!value.is_number_integer() || value.get<long long>() < 1 || value.get<long long>() > 1000) {
+                errors.push_back(prefix + "archiveKeepBases: expected an integer between 1 and 1000");
+            } else {
+                options.archiveKeepBases = value.get<int>();
+            }
+        }
+
+        if (node.contains("archiveBaseEvery")) {
+            const json& value = node["archiveBaseEvery"];
+            if (!value.is_number_integer() || value.get<long long>() < 1 || value.get<long long>() > 1000000) {
+                errors.push_back(prefix + "archiveBaseEvery: expected an integer between 1 and 1000000");
+            } else {
+                options.archiveBaseEvery = value.get<int>();
+            }
+        }
+
+        if (node.contains("deltaCheckpoints")) {
+            const json& value = node["deltaCheckpoints"];
+            if (!value.is_number_integer() || value.get<long long>() < 0 || value.get<long long>() > 1000) {
+                errors.push_back(prefix + "deltaCheckpoints: expected an integer between 0 (full rewrites) and 1000");
+            } else {
+                options.deltaCheckpoints = value.get<int>();
+            }
+        }
+
+        if (options.archive && options.type != DAL::StorageType::WAL) {
+            errors.push_back(prefix + "archive: only the \"wal\" backend keeps an archive");
+        }
+        if (options.deltaCheckpoints > 0 && options.type != DAL::StorageType::WAL) {
+            errors.push_back(prefix + "deltaCheckpoints: only the \"wal\" backend writes checkpoints");
+        }
+    }
+};
+
+}
+
+#endif
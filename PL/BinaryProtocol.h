@@ -0,0 +1,671 @@
+#ifndef BINARYPROTOCOL_H
+#define BINARYPROTOCOL_H
+
+#include "Services.h"
+#include "Journal.h"
+#include "Backup.h"
+#include "WorkloadCapture.h"
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace PL {
+
+// Frame layout (little-endian):
+//   request:  u32 bodyLength | u32 requestId | u8 opCode | payload
+//   response: u32 bodyLength | u32 requestId | u8 status | payload
+// bodyLength counts everything after the length field itself.
+
+constexpr size_t FrameLengthSize = 4;
+constexpr size_t FrameHeaderSize = 9;
+constexpr uint32_t MaxFrameBody = 16 * 1024 * 1024;
+
+enum class OpCode : uint8_t {
+    Ping = 0,
+    AddStudent = 1,
+    RemoveStudent = 2,
+    UpdateStudent = 3,
+    GetStudent = 4,
+    AddGrade = 5,
+    RemoveGrade = 6,
+    FindByName = 7,
+    FindByGroup = 8,
+    FindByAverageGrade = 9,
+    FindByPerformance = 10,
+    GroupAverageGrade = 11,
+    GetAllStudents = 12,
+    AddGroup = 13,
+    RemoveGroup = 14,
+    UpdateGroup = 15,
+    GetGroup = 16,
+    GetAllGroups = 17,
+    ListJournals = 18,
+    SelectJournal = 19,
+    FindByNameAllJournals = 20,
+    RenameGroup = 21,
+    Backup = 22
+};
+
+inline const char* OpCodeName(uint8_t code) {
+    static const char* const names[] = {
+        "ping", "add_student", "remove_student", "update_student", "get_student",
+        "add_grade", "remove_grade", "find_by_name", "find_by_group", "find_by_average_grade",
+        "find_by_performance", "group_average_grade", "get_all_students", "add_group",
+        "remove_group", "update_group", "get_group", "get_all_groups", "list_journals",
+        "select_journal", "find_by_name_all_journals", "rename_group",
+        "backup"
+    };
+    return code < std::size(names) ? names[code] : "unknown";
+}
+
+enum class Status : uint8_t {
+    Ok = 0,
+    NotFound = 1,
+    Duplicate = 2,
+    Invalid = 3,
+    Error = 4,
+    BadRequest = 5
+};
+
+class ProtocolException : public std::runtime_error {
+public:
+    explicit ProtocolException(const std::string& message)
+        : std::runtime_error(message) {}
+};
+
+// A student as it travels over the wire. Group ids are local to the
+// server's journal, so students carry their group's name instead.
+struct RemoteStudent {
+    BLL::Student student;
+    std::string groupName;
+};
+
+class BinaryWriter {
+private:
+    std::vector<uint8_t> buffer;
+
+public:
+    BinaryWriter() = default;
+
+    void WriteU8(uint8_t value) {
+        buffer.push_back(value);
+    }
+
+    void WriteU16(uint16_t value) {
+        buffer.push_back(static_cast<uint8_t>(value));
+        buffer.push_back(static_cast<uint8_t>(value >> 8));
+    }
+
+    void WriteU32(uint32_t value) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            buffer.push_back(static_cast<uint8_t>(value >> shift));
+        }
+    }
+
+    void WriteU64(uint64_t value) {
+        for (int shift = 0; shift < 64; shift += 8) {
+            buffer.push_back(static_cast<uint8_t>(value >> shift));
+        }
+    }
+
+    void WriteI32(int32_t value) {
+        WriteU32(static_cast<uint32_t>(value));
+    }
+
+    void WriteDouble(double value) {
+        WriteU64(std::bit_cast<uint64_t>(value));
+    }
+
+    void WriteString(const std::string& value) {
+        if (value.size() > 0xFFFF) {
+            throw ProtocolException("String too long for protocol field");
+        }
+        WriteU16(static_cast<uint16_t>(value.size()));
+        buffer.insert(buffer.end(), value.begin(), value.end());
+    }
+
+    void WriteStudent(const BLL::Student& student, const std::string& groupName) {
+        WriteI32(student.GetId());
+        WriteString(student.GetFirstName());
+        WriteString(student.GetLastName());
+        WriteString(groupName);
+        auto grades = student.GetGrades();
+        WriteU16(static_cast<uint16_t>(grades.size()));
+        for (const auto& grade : grades) {
+            WriteString(grade.GetSubject());
+            WriteU8(static_cast<uint8_t>(grade.GetScore()));
+        }
+    }
+
+    void WriteStudents(const std::vector<BLL::Student>& students, const BLL::GroupService& groups) {
+        WriteU32(static_cast<uint32_t>(students.size()));
+        for (const auto& student : students) {
+            WriteStudent(student, groups.NameOf(student.GetGroupId()));
+        }
+    }
+
+    void WriteJournalStudents(const std::vector<BLL::JournalStudent>& found) {
+        WriteU32(static_cast<uint32_t>(found.size()));
+        for (const auto& match : found) {
+            WriteString(match.journal);
+            WriteStudent(match.student, match.groupName);
+        }
+    }
+
+    void WriteStrings(const std::vector<std::string>& values) {
+        WriteU32(static_cast<uint32_t>(values.size()));
+        for (const auto& value : values) {
+            WriteString(value);
+        }
+    }
+
+    void WriteGroup(const BLL::Group& group) {
+        WriteString(group.GetName());
+        WriteString(group.GetSpecialization());
+        WriteI32(group.GetYear());
+    }
+
+    void WriteGroups(const std::vector<BLL::Group>& groups) {
+        WriteU32(static_cast<uint32_t>(groups.size()));
+        for (const auto& group : groups) {
+            WriteGroup(group);
+        }
+    }
+
+    size_t Size() const { return buffer.size(); }
+    const std::vector<uint8_t>& Data() const { return buffer; }
+    std::vector<uint8_t> Release() { return std::move(buffer); }
+};
+
+class BinaryReader {
+private:
+    const uint8_t* data;
+    size_t size;
+    size_t position;
+
+    void Require(size_t count) const {
+        if (size - position < count) {
+            throw ProtocolException("Truncated payload");
+        }
+    }
+
+public:
+    BinaryReader(const uint8_t* bytes, size_t length)
+        : data(bytes), size(length), position(0) {}
+
+    explicit BinaryReader(const std::vector<uint8_t>& bytes)
+        : BinaryReader(bytes.data(), bytes.size()) {}
+
+    explicit BinaryReader(std::vector<uint8_t>&&) = delete;
+
+    uint8_t ReadU8() {
+        Require(1);
+        return data[position++];
+    }
+
+    uint16_t ReadU16() {
+        Require(2);
+        uint16_t value = static_cast<uint16_t>(data[position] | (data[position + 1] << 8));
+        position += 2;
+        return value;
+    }
+
+    uint32_t ReadU32() {
+        Require(4);
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i) {
+            value |= static_cast<uint32_t>(data[position + i]) << (8 * i);
+        }
+        position += 4;
+        return value;
+    }
+
+    uint64_t ReadU64() {
+        Require(8);
+        uint64_t value = 0;
+        for (int i = 0; i < 8; ++i) {
+            value |= static_cast<uint64_t>(data[position + i]) << (8 * i);
+        }
+        position += 8;
+        return value;
+    }
+
+    int32_t ReadI32() {
+        return static_cast<int32_t>(ReadU32());
+    }
+
+    double ReadDouble() {
+        return std::bit_cast<double>(ReadU64());
+    }
+
+    std::string ReadString() {
+        uint16_t length = ReadU16();
+        Require(length);
+        std::string value(reinterpret_cast<const char*>(data + position), length);
+        position += length;
+        return value;
+    }
+
+    RemoteStudent ReadStudent() {
+        int id = ReadI32();
+        std::string firstName = ReadString();
+        std::string lastName = ReadString();
+        RemoteStudent remote{BLL::Student(id, firstName, lastName), ReadString()};
+        uint16_t gradeCount = ReadU16();
+        for (uint16_t i = 0; i < gradeCount; ++i) {
+            std::string subject = ReadString();
+            int score = ReadU8();
+            remote.student.AddGrade(BLL::Grade(subject, score));
+        }
+        return remote;
+    }
+
+    std::vector<RemoteStudent> ReadStudents() {
+        uint32_t count = ReadU32();
+        std::vector<RemoteStudent> students;
+        students.reserve(std::min<uint32_t>(count, 1 << 16));
+        for (uint32_t i = 0; i < count; ++i) {
+            students.push_back(ReadStudent());
+        }
+        return students;
+    }
+
+    std::vector<BLL::JournalStudent> ReadJournalStudents() {
+        uint32_t count = ReadU32();
+        std::vector<BLL::JournalStudent> found;
+        for (uint32_t i = 0; i < count; ++i) {
+            std::string journal = ReadString();
+            RemoteStudent remote = ReadStudent();
+            found.push_back(BLL::JournalStudent{journal, std::move(remote.student), std::move(remote.groupName)});
+        }
+        return found;
+    }
+
+    std::vector<std::string> ReadStrings() {
+        uint32_t count = ReadU32();
+        std::vector<std::string> values;
+        for (uint32_t i = 0; i < count; ++i) {
+            values.push_back(ReadString());
+        }
+        return values;
+    }
+
+    BLL::Group ReadGroup() {
+        std::string name = ReadString();
+        std::string specialization = ReadString();
+        int year = ReadI32();
+        return BLL::Group(name, specialization, year);
+    }
+
+    std::vector<BLL::Group> ReadGroups() {
+        uint32_t count = ReadU32();
+        std::vector<BLL::Group> groups;
+        for (uint32_t i = 0; i < count; ++i) {
+            groups.push_back(ReadGroup());
+        }
+        return groups;
+    }
+
+    bool AtEnd() const { return position == size; }
+};
+
+struct FrameHeader {
+    std::array<uint8_t, FrameHeaderSize> bytes;
+
+    FrameHeader(uint32_t requestId, uint8_t code, size_t payloadSize) {
+        uint32_t bodyLength = static_cast<uint32_t>(payloadSize + FrameHeaderSize - FrameLengthSize);
+        for (int i = 0; i < 4; ++i) {
+            bytes[i] = static_cast<uint8_t>(bodyLength >> (8 * i));
+            bytes[4 + i] = static_cast<uint8_t>(requestId >> (8 * i));
+        }
+        bytes[8] = code;
+    }
+};
+
+struct Frame {
+    uint32_t requestId;
+    uint8_t code;
+    std::vector<uint8_t> payload;
+};
+
+// Accumulates bytes from a stream and yields every complete frame, so a
+// single read can carry any number of pipelined requests or responses.
+class FrameDecoder {
+private:
+    std::vector<uint8_t> buffer;
+    size_t consumed = 0;
+
+public:
+    void Append(const uint8_t* bytes, size_t length) {
+        if (consumed > 0 && consumed == buffer.size()) {
+            buffer.clear();
+            consumed = 0;
+        }
+        buffer.insert(buffer.end(), bytes, bytes + length);
+    }
+
+    bool Next(Frame& frame) {
+        size_t available = buffer.size() - consumed;
+        if (available < FrameHeaderSize) {
+            return false;
+        }
+        const uint8_t* start = buffer.data() + consumed;
+        BinaryReader header(start, FrameHeaderSize);
+        uint32_t bodyLength = header.ReadU32();
+        if (bodyLength < FrameHeaderSize - FrameLengthSize || bodyLength > MaxFrameBody) {
+            throw ProtocolException("Invalid frame length: " + std::to_string(bodyLength));
+        }
+        if (available < FrameLengthSize + bodyLength) {
+            return false;
+        }
+        frame.requestId = header.ReadU32();
+        frame.code = header.ReadU8();
+        frame.payload.assign(start + FrameHeaderSize, start + FrameLengthSize + bodyLength);
+        consumed += FrameLengthSize + bodyLength;
+
+        if (consumed > 64 * 1024 && consumed * 2 > buffer.size()) {
+            buffer.erase(buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(consumed));
+            consumed = 0;
+        }
+        return true;
+    }
+
+    size_t Pending() const { return buffer.size() - consumed; }
+};
+
+struct Response {
+    uint32_t requestId;
+    Status status;
+    std::vector<uint8_t> payload;
+};
+
+inline std::vector<uint8_t> EncodeFrame(uint32_t requestId, uint8_t code,
+                                        const std::vector<uint8_t>& payload) {
+    FrameHeader header(requestId, code, payload.size());
+    std::vector<uint8_t> frame(header.bytes.begin(), header.bytes.end());
+    frame.insert(frame.end(), payload.begin(), payload.end());
+    return frame;
+}
+
+class RequestDispatcher {
+private:
+    std::shared_ptr<BLL::StudentService> studentService;
+    std::shared_ptr<BLL::GroupService> groupService;
+    std::shared_ptr<BLL::JournalSet> journals;
+    std::shared_ptr<BLL::OnlineBackup> backup;
+    std::filesystem::path backupDirectory;
+    std::shared_ptr<WorkloadCaptureWriter> capture;
+    uint32_t session = 0;
+
+    BLL::JournalSet& RequireJournals() {
+        if (!journals) {
+            throw ProtocolException("Server was not started with a journal set");
+        }
+        return *journals;
+    }
+
+    // Clients name a file inside the backup directory; absolute paths and
+    // ".." are rejected so a request cannot write anywhere else.
+    std::filesystem::path BackupPath(const std::string& name) const {
+        if (backupDirectory.empty()) {
+            throw ProtocolException("Server was not started with a backup directory");
+        }
+        std::filesystem::path relative(name);
+        if (name.empty() || relative.has_root_path()) {
+            throw std::invalid_argument("Backup name must be a path inside the backup directory: " + name);
+        }
+        for (const auto& part : relative) {
+            if (part == "..") {
+                throw std::invalid_argument("Backup name must not contain '..': " + name);
+            }
+        }
+        std::filesystem::path target = backupDirectory / relative;
+        std::filesystem::create_directories(target.parent_path());
+        return target;
+    }
+
+    static std::vector<uint8_t> ErrorPayload(const std::string& message) {
+        BinaryWriter writer;
+        writer.WriteString(message.substr(0, 0xFFFF));
+        return writer.Release();
+    }
+
+    std::vector<uint8_t> Execute(OpCode op, BinaryReader& in) {
+        BinaryWriter out;
+        switch (op) {
+            case OpCode::Ping:
+                break;
+            case OpCode::AddStudent: {
+                std::string firstName = in.ReadString();
+                std::string lastName = in.ReadString();
+                std::string groupName = in.ReadString();
+                BLL::Student student = studentService->AddStudent(firstName, lastName, groupName);
+                out.WriteStudent(student, studentService->GroupName(student));
+                break;
+            }
+            case OpCode::RemoveStudent:
+                studentService->RemoveStudent(in.ReadI32());
+                break;
+            case OpCode::UpdateStudent: {
+                int id = in.ReadI32();
+                std::string firstName = in.ReadString();
+                std::string lastName = in.ReadString();
+                std::string groupName = in.ReadString();
+                studentService->UpdateStudent(id, firstName, lastName, groupName);
+                break;
+            }
+            case OpCode::GetStudent: {
+                int id = in.ReadI32();
+                auto student = studentService->GetStudentById(id);
+                if (!student) {
+                    throw BLL::StudentNotFoundException("Student with ID " + std::to_string(id) + " not found");
+                }
+                out.WriteStudent(*student, studentService->GroupName(*student));
+                break;
+            }
+            case OpCode::AddGrade: {
+                int id = in.ReadI32();
+                std::string subject = in.ReadString();
+                int score = in.ReadI32();
+                studentService->AddGradeToStudent(id, subject, score);
+                break;
+            }
+            case OpCode::RemoveGrade: {
+                int id = in.ReadI32();
+                std::string subject = in.ReadString();
+                studentService->RemoveGradeFromStudent(id, subject);
+                break;
+            }
+            case OpCode::FindByName: {
+                std::string firstName = in.ReadString();
+                std::string lastName = in.ReadString();
+                out.WriteStudents(studentService->FindByName(firstName, lastName), *studentService->Groups());
+                break;
+            }
+            case OpCode::FindByGroup:
+                out.WriteStudents(studentService->FindByGroup(in.ReadString()), *studentService->Groups());
+                break;
+            case OpCode::FindByAverageGrade: {
+                double minAverage = in.ReadDouble();
+                double maxAverage = in.ReadDouble();
+                out.WriteStudents(studentService->FindByAverageGrade(minAverage, maxAverage), *studentService->Groups());
+                break;
+            }
+            case OpCode::FindByPerformance: {
+                bool successful = in.ReadU8() != 0;
+                std::string subject = in.ReadString();
+                out.WriteStudents(studentService->FindByPerformance(successful, subject), *studentService->Groups());
+                break;
+            }
+            case OpCode::GroupAverageGrade:
+                out.WriteDouble(studentService->CalculateGroupAverageGrade(in.ReadString()));
+                break;
+            case OpCode::GetAllStudents:
+                out.WriteStudents(studentService->GetAll(), *studentService->Groups());
+                break;
+            case OpCode::AddGroup: {
+                std::string name = in.ReadString();
+                std::string specialization = in.ReadString();
+                int year = in.ReadI32();
+                out.WriteGroup(groupService->AddGroup(name, specialization, year));
+                break;
+            }
+            case OpCode::RemoveGroup:
+                groupService->RemoveGroup(in.ReadString());
+                break;
+            case OpCode::UpdateGroup: {
+                std::string name = in.ReadString();
+                std::string specialization = in.ReadString();
+                int year = in.ReadI32();
+                groupService->UpdateGroup(name, specialization, year);
+                break;
+            }
+            case OpCode::RenameGroup: {
+                std::string name = in.ReadString();
+                std::string newName = in.ReadString();
+                groupService->RenameGroup(name, newName);
+                out.WriteU32(static_cast<uint32_t>(studentService->CountInGroup(groupService->FindId(newName))));
+                break;
+            }
+            case OpCode::GetGroup: {
+                std::string name = in.ReadString();
+                auto group = groupService->GetGroupByName(name);
+                if (!group) {
+                    throw BLL::GroupNotFoundException("Group '" + name + "' not found");
+                }
+                out.WriteGroup(*group);
+                break;
+            }
+            case OpCode::GetAllGroups:
+                out.WriteGroups(groupService->GetAll());
+                break;
+            case OpCode::ListJournals:
+                out.WriteStrings(RequireJournals().GetNames());
+                break;
+            case OpCode::SelectJournal: {
+                auto journal = RequireJournals().Get(in.ReadString());
+                studentService = journal->students;
+                groupService = journal->groups;
+                break;
+            }
+            case OpCode::FindByNameAllJournals: {
+                std::string firstName = in.ReadString();
+                std::string lastName = in.ReadString();
+                out.WriteJournalStudents(RequireJournals().FindByName(firstName, lastName));
+                break;
+            }
+            case OpCode::Backup: {
+                // Replies once the snapshot is taken; the file is written in
+                // the background while later requests are served.
+                std::string name = in.ReadString();
+                backup->Start(RequireJournals(), BackupPath(name).string());
+                break;
+            }
+            default:
+                throw ProtocolException("Unknown operation code " + std::to_string(static_cast<int>(op)));
+        }
+        if (!in.AtEnd()) {
+            throw ProtocolException("Unexpected trailing bytes in request");
+        }
+        return out.Release();
+    }
+
+public:
+    RequestDispatcher(std::shared_ptr<BLL::StudentService> studServ,
+                      std::shared_ptr<BLL::GroupService> grpServ)
+        : studentService(studServ), groupService(grpServ) {}
+
+    // Starts on the first journal; SelectJournal switches the journal used by
+    // this dispatcher, so each connection should own its own copy.
+    explicit RequestDispatcher(std::shared_ptr<BLL::JournalSet> journalSet)
+        : journals(journalSet), backup(std::make_shared<BLL::OnlineBackup>()) {
+        auto journal = journals->First();
+        studentService = journal->students;
+        groupService = journal->groups;
+    }
+
+    void SetBackupDirectory(const std::string& directory) {
+        backupDirectory = directory;
+    }
+
+    // One metrics site per opcode; failures are counted from the response
+    // status because Dispatch turns exceptions into error replies.
+    static Diagnostics::OperationSite& SiteFor(uint8_t code) {
+        static const auto sites = []() {
+            std::array<std::unique_ptr<Diagnostics::OperationSite>, 256> table;
+            for (size_t c = 0; c < table.size(); ++c) {
+                std::string name = OpCodeName(static_cast<uint8_t>(c));
+                if (name != "unknown" || c == 255) {
+                    table[c] = std::make_unique<Diagnostics::OperationSite>("rpc." + name);
+                }
+            }
+            return table;
+        }();
+        return sites[code] ? *sites[code] : *sites[255];
+    }
+
+    // Every dispatched request is appended to the capture together with its
+    // start time, latency and status; `connection` tags the requests of one
+    // client so a replay can keep their per-connection journal selection.
+    void SetCapture(std::shared_ptr<WorkloadCaptureWriter> writer, uint32_t connection) {
+        capture = std::move(writer);
+        session = connection;
+    }
+
+    Response Dispatch(const Frame& request) {
+        Diagnostics::OperationSite& site = SiteFor(request.code);
+        Diagnostics::ScopedOperation operation(site);
+        auto start = capture ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+        Response response{request.requestId, Status::Ok, {}};
+        try {
+            BinaryReader in(request.payload);
+            response.payload = Execute(static_cast<OpCode>(request.code), in);
+        } catch (const ProtocolException& e) {
+            response.status = Status::BadRequest;
+            response.payload = ErrorPayload(e.what());
+        } catch (const BLL::StudentNotFoundException& e) {
+            response.status = Status::NotFound;
+            response.payload = ErrorPayload(e.what());
+        } catch (const BLL::GroupNotFoundException& e) {
+            response.status = Status::NotFound;
+            response.payload = ErrorPayload(e.what());
+        } catch (const BLL::JournalNotFoundException& e) {
+            response.status = Status::NotFound;
+            response.payload = ErrorPayload(e.what());
+        } catch (const BLL::DuplicateEntityException& e) {
+            response.status = Status::Duplicate;
+            response.payload = ErrorPayload(e.what());
+        } catch (const BLL::ValidationException& e) {
+            response.status = Status::Invalid;
+            response.payload = ErrorPayload(e.what());
+        } catch (const BLL::InvalidGradeException& e) {
+            response.status = Status::Invalid;
+            response.payload = ErrorPayload(e.what());
+        } catch (const std::invalid_argument& e) {
+            response.status = Status::Invalid;
+            response.payload = ErrorPayload(e.what());
+        } catch (const std::exception& e) {
+            response.status = Status::Error;
+            response.payload = ErrorPayload(e.what());
+        }
+        if (response.status != Status::Ok && Diagnostics::MetricsRegistry::Enabled()) {
+            site.errors.Add();
+        }
+        if (capture) {
+            capture->Record(session, request.code, static_cast<uint8_t>(response.status), request.payload,
+                            start, std::chrono::steady_clock::now() - start);
+        }
+        return response;
+    }
+};
+
+}
+
+#endif
@@ -2,10 +2,18 @@
 #define CONSOLEINTERFACE_H
 
 #include "Services.h"
+#include "Journal.h"
+#include "GroupReport.h"
+#include "Backup.h"
+#include "Profiler.h"
+#include "RawTerminal.h"
+#include <cctype>
+#include <chrono>
 #include <iostream>
 #include <iomanip>
 #include <limits>
 #include <sstream>
+#include <thread>
 
 namespace PL {
 
@@ -13,6 +21,57 @@ class ConsoleInterface {
 private:
     std::shared_ptr<BLL::StudentService> studentService;
     std::shared_ptr<BLL::GroupService> groupService;
+    std::shared_ptr<Profiler> profiler;
+    std::shared_ptr<BLL::JournalSet> journals;
+    std::string currentJournal;
+    BLL::OnlineBackup backup;
+
+    void UseJournal(const std::shared_ptr<BLL::Journal>& journal) {
+        studentService = journal->students;
+        groupService = journal->groups;
+        currentJournal = journal->name;
+    }
+
+    template<typename F>
+    decltype(auto) Service(F&& call) {
+        if (!profiler) {
+            return call();
+        }
+        return profiler->TimeService(std::forward<F>(call));
+    }
+
+    // Every call site passes its own lambda, so each action gets its own
+    // instantiation and with it one static site, registered on first use.
+    template<typename F>
+    void Profile(const std::string& action, F&& body) {
+        static Diagnostics::OperationSite site("console." + action);
+        Diagnostics::ScopedOperation operation(site);
+        if (!profiler) {
+            body();
+            return;
+        }
+        profiler->BeginAction(action);
+        try {
+            body();
+        } catch (...) {
+            profiler->EndAction(true);
+            throw;
+        }
+        profiler->EndAction();
+    }
+
+    template<typename F>
+    decltype(auto) WaitForInput(F&& read) {
+        auto start = std::chrono::steady_clock::now();
+        struct Recorder {
+            Profiler* profiler;
+            std::chrono::steady_clock::time_point start;
+            ~Recorder() {
+                if (profiler) profiler->AddInputWait(std::chrono::steady_clock::now() - start);
+            }
+        } recorder{profiler.get(), start};
+        return read();
+    }
 
     void ClearScreen() {
         #ifdef _WIN32
@@ -23,15 +82,21 @@ private:
     }
 
     void PauseScreen() {
+        if (profiler) {
+            profiler->EndAction();
+            profiler->PrintLastAction(std::cout);
+        }
         std::cout << "\n\nPress Enter to continue...";
-        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-        std::cin.get();
+        WaitForInput([]() {
+            std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            std::cin.get();
+        });
     }
 
     std::string GetStringInput(const std::string& prompt) {
         std::string input;
         std::cout << prompt;
-        std::getline(std::cin, input);
+        WaitForInput([&input]() { std::getline(std::cin, input); });
         return input;
     }
 
@@ -39,7 +104,7 @@ private:
         int value;
         while (true) {
             std::cout << prompt;
-            if (std::cin >> value) {
+            if (WaitForInput([&value]() { return static_cast<bool>(std::cin >> value); })) {
                 std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
                 return value;
             }
@@ -53,7 +118,7 @@ private:
         double value;
         while (true) {
             std::cout << prompt;
-            if (std::cin >> value) {
+            if (WaitForInput([&value]() { return static_cast<bool>(std::cin >> value); })) {
                 std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
                 return value;
             }
@@ -64,9 +129,13 @@ private:
     }
 
     void DisplayStudent(const BLL::Student& student) {
+        DisplayStudent(student, studentService->GroupName(student));
+    }
+
+    void DisplayStudent(const BLL::Student& student, const std::string& groupName) {
         std::cout << "ID: " << student.GetId()
                   << " | Name: " << student.GetFirstName() << " " << student.GetLastName()
-                  << " | Group: " << student.GetGroupName()
+                  << " | Group: " << groupName
                   << " | Avg: " << std::fixed << std::setprecision(2)
                   << student.CalculateAverageGrade() << "\n";
     }
@@ -75,7 +144,7 @@ private:
         std::cout << "\n=== Student Details ===\n";
         std::cout << "ID: " << student.GetId() << "\n";
         std::cout << "Name: " << student.GetFirstName() << " " << student.GetLastName() << "\n";
-        std::cout << "Group: " << student.GetGroupName() << "\n";
+        std::cout << "Group: " << studentService->GroupName(student) << "\n";
         std::cout << "Average Grade: " << std::fixed << std::setprecision(2)
                   << student.CalculateAverageGrade() << "\n";
         std::cout << "\nGrades:\n";
@@ -105,6 +174,7 @@ private:
             std::cout << "3. Update Student\n";
             std::cout << "4. View All Students\n";
             std::cout << "5. View Student Details\n";
+            std::cout << "6. Remove Students of Group\n";
             std::cout << "0. Back\n";
             std::cout << "Choice: ";
 
@@ -112,11 +182,12 @@ private:
 
             try {
                 switch (choice) {
-                    case 1: AddStudentMenu(); break;
-                    case 2: RemoveStudentMenu(); break;
-                    case 3: UpdateStudentMenu(); break;
-                    case 4: ViewAllStudentsMenu(); break;
-                    case 5: ViewStudentDetailsMenu(); break;
+                    case 1: Profile("Add Student", [this]() { AddStudentMenu(); }); break;
+                    case 2: Profile("Remove Student", [this]() { RemoveStudentMenu(); }); break;
+                    case 3: Profile("Update Student", [this]() { UpdateStudentMenu(); }); break;
+                    case 4: Profile("View All Students", [this]() { ViewAllStudentsMenu(); }); break;
+                    case 5: Profile("View Student Details", [this]() { ViewStudentDetailsMenu(); }); break;
+                    case 6: Profile("Remove Students of Group", [this]() { RemoveGroupStudentsMenu(); }); break;
                     case 0: return;
                     default: std::cout << "Invalid choice!\n"; PauseScreen();
                 }
@@ -141,7 +212,7 @@ private:
             return;
         }
 
-        auto student = studentService->AddStudent(firstName, lastName, groupName);
+        auto student = Service([&]() { return studentService->AddStudent(firstName, lastName, groupName); });
         std::cout << "\nStudent added successfully! ID: " << student.GetId() << "\n";
         PauseScreen();
     }
@@ -151,18 +222,32 @@ private:
         std::cout << "\n=== REMOVE STUDENT ===\n";
 
         int studentId = GetIntInput("Student ID: ");
-        studentService->RemoveStudent(studentId);
+        Service([&]() { studentService->RemoveStudent(studentId); });
 
         std::cout << "\nStudent removed successfully!\n";
         PauseScreen();
     }
 
+    void RemoveGroupStudentsMenu() {
+        ClearScreen();
+        std::cout << "\n=== REMOVE STUDENTS OF GROUP ===\n";
+
+        std::string groupName = GetStringInput("Group Name: ");
+        int groupId = studentService->Groups()->FindId(groupName);
+        size_t removed = groupId < 0 ? 0 : Service([&]() {
+            return studentService->RemoveWhere([groupId](const BLL::Student& s) { return s.GetGroupId() == groupId; });
+        });
+
+        std::cout << "\n" << removed << " student(s) removed from '" << groupName << "'.\n";
+        PauseScreen();
+    }
+
     void UpdateStudentMenu() {
         ClearScreen();
         std::cout << "\n=== UPDATE STUDENT ===\n";
 
         int studentId = GetIntInput("Student ID: ");
-        auto student = studentService->GetStudentById(studentId);
+        auto student = Service([&]() { return studentService->GetStudentById(studentId); });
 
         if (!student) {
             std::cout << "Student not found!\n";
@@ -178,7 +263,7 @@ private:
         std::string lastName = GetStringInput("Last Name: ");
         std::string groupName = GetStringInput("Group Name: ");
 
-        studentService->UpdateStudent(studentId, firstName, lastName, groupName);
+        Service([&]() { studentService->UpdateStudent(studentId, firstName, lastName, groupName); });
         std::cout << "\nStudent updated successfully!\n";
         PauseScreen();
     }
@@ -187,7 +272,7 @@ private:
         ClearScreen();
         std::cout << "\n=== ALL STUDENTS ===\n";
 
-        auto students = studentService->GetAll();
+        auto students = Service([&]() { return studentService->GetAll(); });
         if (students.empty()) {
             std::cout << "No students found.\n";
         } else {
@@ -203,7 +288,7 @@ private:
         std::cout << "\n=== STUDENT DETAILS ===\n";
 
         int studentId = GetIntInput("Student ID: ");
-        auto student = studentService->GetStudentById(studentId);
+        auto student = Service([&]() { return studentService->GetStudentById(studentId); });
 
         if (!student) {
             std::cout << "Student not found!\n";
@@ -222,6 +307,9 @@ private:
             std::cout << "3. Update Group\n";
             std::cout << "4. View All Groups\n";
             std::cout << "5. View Group Details\n";
+            std::cout << "6. Rename Group\n";
+            std::cout << "7. Group Report\n";
+            std::cout << "8. Advance Year\n";
             std::cout << "0. Back\n";
             std::cout << "Choice: ";
 
@@ -229,11 +317,14 @@ private:
 
             try {
                 switch (choice) {
-                    case 1: AddGroupMenu(); break;
-                    case 2: RemoveGroupMenu(); break;
-                    case 3: UpdateGroupMenu(); break;
-                    case 4: ViewAllGroupsMenu(); break;
-                    case 5: ViewGroupDetailsMenu(); break;
+                    case 1: Profile("Add Group", [this]() { AddGroupMenu(); }); break;
+                    case 2: Profile("Remove Group", [this]() { RemoveGroupMenu(); }); break;
+                    case 3: Profile("Update Group", [this]() { UpdateGroupMenu(); }); break;
+                    case 4: Profile("View All Groups", [this]() { ViewAllGroupsMenu(); }); break;
+                    case 5: Profile("View Group Details", [this]() { ViewGroupDetailsMenu(); }); break;
+                    case 6: Profile("Rename Group", [this]() { RenameGroupMenu(); }); break;
+                    case 7: Profile("Group Report", [this]() { GroupReportMenu(); }); break;
+                    case 8: Profile("Advance Year", [this]() { AdvanceYearMenu(); }); break;
                     case 0: return;
                     default: std::cout << "Invalid choice!\n"; PauseScreen();
                 }
@@ -258,7 +349,7 @@ private:
             return;
         }
 
-        groupService->AddGroup(name, specialization, year);
+        Service([&]() { groupService->AddGroup(name, specialization, year); });
         std::cout << "\nGroup added successfully!\n";
         PauseScreen();
     }
@@ -268,7 +359,7 @@ private:
         std::cout << "\n=== REMOVE GROUP ===\n";
 
         std::string name = GetStringInput("Group Name: ");
-        groupService->RemoveGroup(name);
+        Service([&]() { groupService->RemoveGroup(name); });
 
         std::cout << "\nGroup removed successfully!\n";
         PauseScreen();
@@ -279,7 +370,7 @@ private:
         std::cout << "\n=== UPDATE GROUP ===\n";
 
         std::string name = GetStringInput("Group Name: ");
-        auto group = groupService->GetGroupByName(name);
+        auto group = Service([&]() { return groupService->GetGroupByName(name); });
 
         if (!group) {
             std::cout << "Group not found!\n";
@@ -294,16 +385,73 @@ private:
         std::string specialization = GetStringInput("Specialization: ");
         int year = GetIntInput("Year (0 to keep current): ");
 
-        groupService->UpdateGroup(name, specialization, year);
+        Service([&]() { groupService->UpdateGroup(name, specialization, year); });
         std::cout << "\nGroup updated successfully!\n";
         PauseScreen();
     }
 
+    void RenameGroupMenu() {
+        ClearScreen();
+        std::cout << "\n=== RENAME GROUP ===\n";
+
+        std::string name = GetStringInput("Group Name: ");
+        std::string newName = GetStringInput("New Group Name: ");
+
+        Service([&]() { groupService->RenameGroup(name, newName); });
+        std::cout << "\nGroup renamed to '" << newName << "'.\n";
+        PauseScreen();
+    }
+
+    void AdvanceYearMenu() {
+        ClearScreen();
+        std::cout << "\n=== ADVANCE YEAR ===\n";
+
+        int year = GetIntInput("Advance groups of year (0 for all): ");
+        size_t advanced = Service([&]() {
+            return groupService->UpdateWhere(
+                [year](const BLL::Group& g) { return year == 0 || g.GetYear() == year; },
+                [](BLL::Group& g) { g.SetYear(g.GetYear() + 1); });
+        });
+
+        std::cout << "\n" << advanced << " group(s) advanced by one year.\n";
+        PauseScreen();
+    }
+
+    void GroupReportMenu() {
+        ClearScreen();
+        std::cout << "\n=== GROUP REPORT ===\n";
+        std::cout << "Aggregate by: 1. Group  2. Specialization  3. Year\n";
+
+        int choice = GetIntInput("Choice: ");
+        BLL::GroupAttribute attribute = choice == 2 ? BLL::GroupAttribute::Specialization
+                                      : choice == 3 ? BLL::GroupAttribute::Year
+                                                    : BLL::GroupAttribute::Name;
+        BLL::ThreadPool* pool = journals ? &journals->Pool() : nullptr;
+        auto rows = Service([&]() { return BLL::GroupReport::Build(*studentService, *groupService, attribute, pool); });
+
+        if (rows.empty()) {
+            std::cout << "No students or groups found.\n";
+        } else {
+            std::string heading = BLL::GroupAttributeName(attribute);
+            heading[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(heading[0])));
+            std::cout << "\n" << std::left << std::setw(24) << heading << std::right
+                      << std::setw(8) << "Groups" << std::setw(10) << "Students"
+                      << std::setw(8) << "Grades" << std::setw(10) << "Average" << "\n";
+            for (const auto& row : rows) {
+                std::cout << std::left << std::setw(24) << row.key << std::right
+                          << std::setw(8) << row.groups << std::setw(10) << row.students
+                          << std::setw(8) << row.grades << std::setw(10) << std::fixed
+                          << std::setprecision(2) << row.averageGrade << "\n";
+            }
+        }
+        PauseScreen();
+    }
+
     void ViewAllGroupsMenu() {
         ClearScreen();
         std::cout << "\n=== ALL GROUPS ===\n";
 
-        auto groups = groupService->GetAll();
+        auto groups = Service([&]() { return groupService->GetAll(); });
         if (groups.empty()) {
             std::cout << "No groups found.\n";
         } else {
@@ -319,7 +467,7 @@ private:
         std::cout << "\n=== GROUP DETAILS ===\n";
 
         std::string name = GetStringInput("Group Name: ");
-        auto group = groupService->GetGroupByName(name);
+        auto group = Service([&]() { return groupService->GetGroupByName(name); });
 
         if (!group) {
             std::cout << "Group not found!\n";
@@ -330,7 +478,7 @@ private:
         std::cout << "\n";
         DisplayGroup(*group);
 
-        auto students = studentService->FindStudentsByGroup(name);
+        auto students = Service([&]() { return studentService->FindStudentsByGroup(name); });
         std::cout << "\nStudents in group (" << students.size() << "):\n";
         if (students.empty()) {
             std::cout << "  No students in this group\n";
@@ -338,7 +486,7 @@ private:
             for (const auto& student : students) {
                 DisplayStudent(student);
             }
-            double avgGrade = studentService->CalculateGroupAverageGrade(name);
+            double avgGrade = Service([&]() { return studentService->CalculateGroupAverageGrade(name); });
             std::cout << "\nGroup Average Grade: " << std::fixed
                       << std::setprecision(2) << avgGrade << "\n";
         }
@@ -360,10 +508,10 @@ private:
 
             try {
                 switch (choice) {
-                    case 1: AddGradeMenu(); break;
-                    case 2: RemoveGradeMenu(); break;
-                    case 3: ViewStudentGradesMenu(); break;
-                    case 4: ViewGradesBySubjectMenu(); break;
+                    case 1: Profile("Add/Update Grade", [this]() { AddGradeMenu(); }); break;
+                    case 2: Profile("Remove Grade", [this]() { RemoveGradeMenu(); }); break;
+                    case 3: Profile("View Student Grades", [this]() { ViewStudentGradesMenu(); }); break;
+                    case 4: Profile("View Grades by Subject", [this]() { ViewGradesBySubjectMenu(); }); break;
                     case 0: return;
                     default: std::cout << "Invalid choice!\n"; PauseScreen();
                 }
@@ -388,7 +536,7 @@ private:
             return;
         }
 
-        studentService->AddGradeToStudent(studentId, subject, score);
+        Service([&]() { studentService->AddGradeToStudent(studentId, subject, score); });
         std::cout << "\nGrade added/updated successfully!\n";
         PauseScreen();
     }
@@ -400,7 +548,7 @@ private:
         int studentId = GetIntInput("Student ID: ");
         std::string subject = GetStringInput("Subject: ");
 
-        studentService->RemoveGradeFromStudent(studentId, subject);
+        Service([&]() { studentService->RemoveGradeFromStudent(studentId, subject); });
         std::cout << "\nGrade removed successfully!\n";
         PauseScreen();
     }
@@ -410,7 +558,7 @@ private:
         std::cout << "\n=== STUDENT GRADES ===\n";
 
         int studentId = GetIntInput("Student ID: ");
-        auto student = studentService->GetStudentById(studentId);
+        auto student = Service([&]() { return studentService->GetStudentById(studentId); });
 
         if (!student) {
             std::cout << "Student not found!\n";
@@ -426,7 +574,7 @@ private:
 
         std::string subject = GetStringInput("Subject: ");
 
-        auto students = studentService->GetAll();
+        auto students = Service([&]() { return studentService->GetAll(); });
         bool found = false;
 
         std::cout << "\nGrades for subject: " << subject << "\n";
@@ -438,7 +586,7 @@ private:
                 if (grade.GetSubject() == subject) {
                     std::cout << std::left << std::setw(25)
                               << (student.GetFirstName() + " " + student.GetLastName())
-                              << " | Group: " << std::setw(10) << student.GetGroupName()
+                              << " | Group: " << std::setw(10) << studentService->GroupName(student)
                               << " | Score: " << grade.GetScore() << "\n";
                     found = true;
                     break;
@@ -460,6 +608,7 @@ private:
             std::cout << "2. Search by Group\n";
             std::cout << "3. Search by Average Grade\n";
             std::cout << "4. Search Successful/Unsuccessful Students\n";
+            std::cout << "5. Type-ahead Name Search\n";
             std::cout << "0. Back\n";
             std::cout << "Choice: ";
 
@@ -467,10 +616,11 @@ private:
 
             try {
                 switch (choice) {
-                    case 1: SearchByNameMenu(); break;
-                    case 2: SearchByGroupMenu(); break;
-                    case 3: SearchByAverageGradeMenu(); break;
-                    case 4: SearchByPerformanceMenu(); break;
+                    case 1: Profile("Search by Name", [this]() { SearchByNameMenu(); }); break;
+                    case 2: Profile("Search by Group", [this]() { SearchByGroupMenu(); }); break;
+                    case 3: Profile("Search by Average Grade", [this]() { SearchByAverageGradeMenu(); }); break;
+                    case 4: Profile("Search by Performance", [this]() { SearchByPerformanceMenu(); }); break;
+                    case 5: Profile("Type-ahead Search", [this]() { TypeAheadSearchMenu(); }); break;
                     case 0: return;
                     default: std::cout << "Invalid choice!\n"; PauseScreen();
                 }
@@ -488,7 +638,7 @@ private:
         std::string firstName = GetStringInput("First Name (optional): ");
         std::string lastName = GetStringInput("Last Name (optional): ");
 
-        auto students = studentService->FindStudentsByName(firstName, lastName);
+        auto students = Service([&]() { return studentService->FindStudentsByName(firstName, lastName); });
 
         std::cout << "\nFound " << students.size() << " student(s):\n";
         for (const auto& student : students) {
@@ -503,7 +653,7 @@ private:
 
         std::string groupName = GetStringInput("Group Name: ");
 
-        auto students = studentService->FindStudentsByGroup(groupName);
+        auto students = Service([&]() { return studentService->FindStudentsByGroup(groupName); });
 
         std::cout << "\nFound " << students.size() << " student(s):\n";
         for (const auto& student : students) {
@@ -519,7 +669,7 @@ private:
         double minGrade = GetDoubleInput("Minimum Average Grade: ");
         double maxGrade = GetDoubleInput("Maximum Average Grade: ");
 
-        auto students = studentService->FindStudentsByAverageGrade(minGrade, maxGrade);
+        auto students = Service([&]() { return studentService->FindStudentsByAverageGrade(minGrade, maxGrade); });
 
         std::cout << "\nFound " << students.size() << " student(s):\n";
         for (const auto& student : students) {
@@ -541,12 +691,12 @@ private:
         std::vector<BLL::Student> students;
 
         if (choice == 1) {
-            students = studentService->FindStudentsByPerformance(true);
+            students = Service([&]() { return studentService->FindStudentsByPerformance(true); });
         } else if (choice == 2) {
-            students = studentService->FindStudentsByPerformance(false);
+            students = Service([&]() { return studentService->FindStudentsByPerformance(false); });
         } else if (choice == 3 || choice == 4) {
             std::string subject = GetStringInput("Subject: ");
-            students = studentService->FindStudentsByPerformance(choice == 3, subject);
+            students = Service([&]() { return studentService->FindStudentsByPerformance(choice == 3, subject); });
         } else {
             std::cout << "Invalid choice!\n";
             PauseScreen();
@@ -560,23 +710,207 @@ private:
         PauseScreen();
     }
 
+    void SwitchJournalMenu() {
+        ClearScreen();
+        std::cout << "\n=== SWITCH JOURNAL ===\n";
+
+        auto names = journals->GetNames();
+        for (size_t i = 0; i < names.size(); ++i) {
+            std::cout << (i + 1) << ". " << names[i]
+                      << (names[i] == currentJournal ? " (current)" : "") << "\n";
+        }
+
+        int choice = GetIntInput("\nJournal: ");
+        if (choice < 1 || choice > static_cast<int>(names.size())) {
+            std::cout << "Invalid choice!\n";
+            PauseScreen();
+            return;
+        }
+
+        UseJournal(journals->Get(names[choice - 1]));
+        std::cout << "\nSwitched to journal '" << currentJournal << "'\n";
+        PauseScreen();
+    }
+
+    void BackupMenu() {
+        ClearScreen();
+        std::cout << "\n=== BACKUP ===\n";
+
+        auto last = backup.Last();
+        if (last.valid()) {
+            if (backup.Running()) {
+                std::cout << "The previous backup is still being written.\n";
+                PauseScreen();
+                return;
+            }
+            try {
+                const BLL::BackupResult& result = last.get();
+                std::cout << "Last backup: " << result.path << " (" << result.students << " students, "
+                          << result.groups << " groups, " << result.bytes / 1024 << " KB; snapshot "
+                          << std::fixed << std::setprecision(1) << result.snapshotMilliseconds
+                          << " ms, write " << result.writeMilliseconds << " ms)\n";
+            } catch (const std::exception& e) {
+                std::cout << "Last backup failed: " << e.what() << "\n";
+            }
+        }
+
+        std::string path = GetStringInput("Backup file (empty for backup.json): ");
+        if (path.empty()) {
+            path = "backup.json";
+        }
+        Service([&]() { backup.Start(*journals, path); });
+        std::cout << "\nSnapshot of " << journals->Count() << " journal(s) taken; " << path
+                  << " is written in the background.\n";
+        PauseScreen();
+    }
+
+    void SearchAllJournalsMenu() {
+        ClearScreen();
+        std::cout << "\n=== SEARCH ALL JOURNALS ===\n";
+
+        std::string firstName = GetStringInput("First Name (optional): ");
+        std::string lastName = GetStringInput("Last Name (optional): ");
+
+        auto found = Service([&]() { return journals->FindByName(firstName, lastName); });
+
+        std::cout << "\nFound " << found.size() << " student(s) in "
+                  << journals->Count() << " journal(s):\n";
+        for (const auto& match : found) {
+            std::cout << "[" << match.journal << "] ";
+            DisplayStudent(match.student, match.groupName);
+        }
+        PauseScreen();
+    }
+
+    static bool EndsInPartialUtf8(const std::string& text) {
+        size_t continuation = 0;
+        for (auto it = text.rbegin(); it != text.rend(); ++it) {
+            unsigned char c = static_cast<unsigned char>(*it);
+            if ((c & 0xC0) == 0x80) {
+                ++continuation;
+                continue;
+            }
+            size_t expected = (c & 0xE0) == 0xC0 ? 1 : (c & 0xF0) == 0xE0 ? 2 : (c & 0xF8) == 0xF0 ? 3 : 0;
+            return continuation < expected;
+        }
+        return false;
+    }
+
+    void RenderTypeAheadPrompt(const std::string& query) {
+        std::cout << "\033[H\033[J"
+                  << "\n=== TYPE-AHEAD NAME SEARCH ===\n"
+                  << "Type a first and/or last name prefix. Backspace edits, Enter or Esc finishes.\n\n"
+                  << "Search: " << query << "\n" << std::flush;
+    }
+
+    void ShowTypeAheadMatches(const std::string& query, std::stop_token stop) {
+        const size_t shown = 15;
+        auto start = std::chrono::steady_clock::now();
+        auto result = studentService->FindByNamePrefix(query, shown, stop);
+        double elapsedMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+        if (stop.stop_requested()) return;
+
+        std::cout << "\n";
+        for (const auto& student : result.students) {
+            if (stop.stop_requested()) return;
+            DisplayStudent(student);
+        }
+        std::cout << "\nShowing " << result.students.size() << " of " << result.candidates
+                  << " index hits (" << std::fixed << std::setprecision(3) << elapsedMs << " ms)\n"
+                  << std::flush;
+    }
+
+    void TypeAheadSearchMenu() {
+        Service([&]() { studentService->PrepareNameIndex(); });
+
+        std::string query;
+        {
+            RawTerminal terminal;
+            std::jthread search;
+            RenderTypeAheadPrompt(query);
+            while (true) {
+                int key = WaitForInput([&terminal]() { return terminal.ReadKey(); });
+                search = std::jthread();
+
+                if (key < 0 || key == 27) {
+                    break;
+                }
+                if (key == '\n' || key == '\r') {
+                    RenderTypeAheadPrompt(query);
+                    if (!query.empty()) {
+                        ShowTypeAheadMatches(query, std::stop_token());
+                    }
+                    break;
+                }
+                if (key == 127 || key == 8) {
+                    while (!query.empty() && (static_cast<unsigned char>(query.back()) & 0xC0) == 0x80) {
+                        query.pop_back();
+                    }
+                    if (!query.empty()) query.pop_back();
+                } else if (key >= 32) {
+                    query.push_back(static_cast<char>(key));
+                } else {
+                    continue;
+                }
+                if (EndsInPartialUtf8(query)) {
+                    continue;
+                }
+
+                RenderTypeAheadPrompt(query);
+                if (!query.empty()) {
+                    search = std::jthread([this, query](std::stop_token stop) {
+                        ShowTypeAheadMatches(query, stop);
+                    });
+                }
+            }
+        }
+        PauseScreen();
+    }
+
 public:
     ConsoleInterface(std::shared_ptr<BLL::StudentService> studServ,
-                    std::shared_ptr<BLL::GroupService> grpServ)
-        : studentService(studServ), groupService(grpServ) {}
+                    std::shared_ptr<BLL::GroupService> grpServ,
+                    std::shared_ptr<Profiler> prof = nullptr)
+        : studentService(studServ), groupService(grpServ), profiler(prof) {}
+
+    ConsoleInterface(std::shared_ptr<BLL::JournalSet> journalSet,
+                    std::shared_ptr<Profiler> prof = nullptr)
+        : profiler(prof), journals(journalSet) {
+        UseJournal(journals->First());
+    }
 
     void Run() {
         while (true) {
             ClearScreen();
             std::cout << "\n=== ELECTRONIC GRADE JOURNAL ===\n";
+            if (journals) {
+                std::cout << "Journal: " << currentJournal << "\n";
+            }
             std::cout << "1. Student Management\n";
             std::cout << "2. Group Management\n";
             std::cout << "3. Grade Management\n";
             std::cout << "4. Search\n";
+            if (journals) {
+                std::cout << "5. Switch Journal\n";
+                std::cout << "6. Search All Journals\n";
+            }
+            if (Diagnostics::MetricsRegistry::AllocationProfiling()) {
+                std::cout << "7. Allocation Profile\n";
+            }
+            if (journals) {
+                std::cout << "8. Backup\n";
+            }
             std::cout << "0. Exit\n";
             std::cout << "Choice: ";
 
             int choice = GetIntInput("");
+            if (!journals && (choice == 5 || choice == 6 || choice == 8)) {
+                choice = -1;
+            }
+            if (!Diagnostics::MetricsRegistry::AllocationProfiling() && choice == 7) {
+                choice = -1;
+            }
 
             try {
                 switch (choice) {
@@ -584,8 +918,21 @@ public:
                     case 2: GroupManagementMenu(); break;
                     case 3: GradeManagementMenu(); break;
                     case 4: SearchMenu(); break;
+                    case 5: Profile("Switch Journal", [this]() { SwitchJournalMenu(); }); break;
+                    case 6: Profile("Search All Journals", [this]() { SearchAllJournalsMenu(); }); break;
+                    case 7:
+                        Diagnostics::MetricsRegistry::Instance().PrintAllocationProfiles(std::cout);
+                        PauseScreen();
+                        break;
+                    case 8: Profile("Backup", [this]() { BackupMenu(); }); break;
                     case 0:
                         std::cout << "\nGoodbye!\n";
+                        if (profiler) {
+                            profiler->PrintSummary(std::cout);
+                        }
+                        if (Diagnostics::MetricsRegistry::AllocationProfiling()) {
+                            Diagnostics::MetricsRegistry::Instance().PrintAllocationProfiles(std::cout);
+                        }
                         return;
                     default:
                         std::cout << "Invalid choice!\n";
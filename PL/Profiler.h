@@ -0,0 +1,198 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "TimedStorage.h"
+#include "AllocationCounter.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace PL {
+
+struct ActionProfile {
+    std::string name;
+    bool failed = false;
+    double wallMs = 0.0;
+    double serviceMs = 0.0;
+    double storageMs = 0.0;
+    double renderMs = 0.0;
+    uint64_t allocations = 0;
+    uint64_t allocatedBytes = 0;
+    uint64_t bytesWritten = 0;
+};
+
+// Splits the time of one console action into service, storage and rendering
+// phases. Time spent waiting for keyboard input is excluded from wall time.
+class Profiler {
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::shared_ptr<DAL::StorageTimer> storageTimer;
+    std::vector<ActionProfile> samples;
+
+    bool active = false;
+    bool pendingDisplay = false;
+    std::string actionName;
+    Clock::time_point started;
+    Clock::duration inputWait{};
+    Clock::duration serviceTime{};
+    int serviceDepth = 0;
+    std::chrono::nanoseconds storageAtStart{};
+    Diagnostics::AllocationSnapshot allocationsAtStart;
+    uint64_t bytesWrittenAtStart = 0;
+
+    static double ToMs(Clock::duration d) {
+        return std::chrono::duration<double, std::milli>(d).count();
+    }
+
+    static std::string FormatBytes(uint64_t bytes) {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(1);
+        if (bytes >= 1024 * 1024) {
+            out << bytes / (1024.0 * 1024.0) << " MB";
+        } else if (bytes >= 1024) {
+            out << bytes / 1024.0 << " KB";
+        } else {
+            out << bytes << " B";
+        }
+        return out.str();
+    }
+
+public:
+    Profiler() : storageTimer(std::make_shared<DAL::StorageTimer>()) {}
+
+    std::shared_ptr<DAL::StorageTimer> GetStorageTimer() const {
+        return storageTimer;
+    }
+
+    bool IsActive() const { return active; }
+
+    void BeginAction(const std::string& name) {
+        active = true;
+        pendingDisplay = false;
+        actionName = name;
+        inputWait = Clock::duration::zero();
+        serviceTime = Clock::duration::zero();
+        serviceDepth = 0;
+        storageAtStart = storageTimer->Total();
+        allocationsAtStart = Diagnostics::AllocationCounter::Snapshot();
+        bytesWrittenAtStart = DAL::IoStats::GetBytesWritten();
+        started = Clock::now();
+    }
+
+    void EndAction(bool failed = false) {
+        if (!active) return;
+        auto now = Clock::now();
+        active = false;
+
+        ActionProfile sample;
+        sample.name = actionName;
+        sample.failed = failed;
+        auto wall = now - started - inputWait;
+        double storageMs = std::chrono::duration<double, std::milli>(storageTimer->Total() - storageAtStart).count();
+        sample.wallMs = ToMs(wall);
+        sample.storageMs = storageMs;
+        sample.serviceMs = std::max(0.0, ToMs(serviceTime) - storageMs);
+        sample.renderMs = std::max(0.0, sample.wallMs - ToMs(serviceTime));
+        auto allocated = Diagnostics::AllocationCounter::Snapshot() - allocationsAtStart;
+        sample.allocations = allocated.allocations;
+        sample.allocatedBytes = allocated.bytes;
+        sample.bytesWritten = DAL::IoStats::GetBytesWritten() - bytesWrittenAtStart;
+
+        samples.push_back(sample);
+        pendingDisplay = true;
+    }
+
+    void AddInputWait(Clock::duration waited) {
+        if (active && serviceDepth == 0) {
+            inputWait += waited;
+        }
+    }
+
+    template<typename F>
+    decltype(auto) TimeService(F&& call) {
+        if (!active || serviceDepth > 0) {
+            return call();
+        }
+        struct Scope {
+            Profiler& profiler;
+            Clock::time_point start;
+            Scope(Profiler& p) : profiler(p), start(Clock::now()) { ++profiler.serviceDepth; }
+            ~Scope() {
+                --profiler.serviceDepth;
+                profiler.serviceTime += Clock::now() - start;
+            }
+        } scope(*this);
+        return call();
+    }
+
+    void PrintLastAction(std::ostream& out) {
+        if (!pendingDisplay || samples.empty()) return;
+        pendingDisplay = false;
+        const auto& s = samples.back();
+        out << "\n[profile] " << s.name << (s.failed ? " (failed)" : "")
+            << std::fixed << std::setprecision(3)
+            << ": wall " << s.wallMs << " ms"
+            << " | service " << s.serviceMs << " ms"
+            << " | storage " << s.storageMs << " ms"
+            << " | render " << s.renderMs << " ms\n"
+            << "[profile] ";
+        if (Diagnostics::AllocationCounter::IsInstalled()) {
+            out << s.allocations << " allocations (" << FormatBytes(s.allocatedBytes) << ")";
+        } else {
+            out << "allocations n/a";
+        }
+        out << " | " << FormatBytes(s.bytesWritten) << " written\n";
+    }
+
+    void PrintSummary(std::ostream& out, size_t slowest = 10) const {
+        out << "\n=== PROFILE SUMMARY (" << samples.size() << " actions) ===\n";
+        if (samples.empty()) return;
+
+        struct Totals { size_t count = 0; double wall = 0.0; double max = 0.0; uint64_t written = 0; };
+        std::map<std::string, Totals> byAction;
+        for (const auto& s : samples) {
+            auto& t = byAction[s.name];
+            t.count++;
+            t.wall += s.wallMs;
+            t.max = std::max(t.max, s.wallMs);
+            t.written += s.bytesWritten;
+        }
+
+        out << std::left << std::setw(28) << "Action" << std::right
+            << std::setw(7) << "Count" << std::setw(12) << "Avg ms"
+            << std::setw(12) << "Max ms" << std::setw(14) << "Written" << "\n";
+        out << std::fixed << std::setprecision(3);
+        for (const auto& pair : byAction) {
+            out << std::left << std::setw(28) << pair.first << std::right
+                << std::setw(7) << pair.second.count
+                << std::setw(12) << pair.second.wall / pair.second.count
+                << std::setw(12) << pair.second.max
+                << std::setw(14) << FormatBytes(pair.second.written) << "\n";
+        }
+
+        std::vector<const ActionProfile*> sorted;
+        for (const auto& s : samples) sorted.push_back(&s);
+        std::sort(sorted.begin(), sorted.end(),
+            [](const ActionProfile* a, const ActionProfile* b) { return a->wallMs > b->wallMs; });
+
+        out << "\nSlowest operations:\n";
+        for (size_t i = 0; i < std::min(slowest, sorted.size()); ++i) {
+            const auto& s = *sorted[i];
+            out << "  " << std::left << std::setw(26) << s.name << std::right
+                << std::setw(10) << s.wallMs << " ms  (service " << s.serviceMs
+                << ", storage " << s.storageMs << ", render " << s.renderMs << ")\n";
+        }
+    }
+
+    const std::vector<ActionProfile>& GetSamples() const { return samples; }
+};
+
+}
+
+#endif
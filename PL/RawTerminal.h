@@ -0,0 +1,61 @@
+#ifndef RAWTERMINAL_H
+#define RAWTERMINAL_H
+
+#include <cstdio>
+
+#ifdef _WIN32
+#include <conio.h>
+#else
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+namespace PL {
+
+// Switches stdin to unbuffered, unechoed key-by-key reads for the lifetime
+// of the object and restores the previous mode afterwards.
+class RawTerminal {
+private:
+#ifndef _WIN32
+    termios saved{};
+    bool restored = true;
+#endif
+
+public:
+    RawTerminal() {
+#ifndef _WIN32
+        if (tcgetattr(STDIN_FILENO, &saved) == 0) {
+            termios raw = saved;
+            raw.c_lflag &= ~(ICANON | ECHO);
+            raw.c_cc[VMIN] = 1;
+            raw.c_cc[VTIME] = 0;
+            restored = tcsetattr(STDIN_FILENO, TCSANOW, &raw) != 0;
+        }
+#endif
+    }
+
+    ~RawTerminal() {
+#ifndef _WIN32
+        if (!restored) {
+            tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+        }
+#endif
+    }
+
+    RawTerminal(const RawTerminal&) = delete;
+    RawTerminal& operator=(const RawTerminal&) = delete;
+
+    // Returns the next byte, or -1 at end of input.
+    int ReadKey() {
+#ifdef _WIN32
+        return _getch();
+#else
+        int c = std::getchar();
+        return c == EOF ? -1 : c;
+#endif
+    }
+};
+
+}
+
+#endif
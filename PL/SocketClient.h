@@ -0,0 +1,330 @@
+#ifndef SOCKETCLIENT_H
+#define SOCKETCLIENT_H
+
+#include "SocketServer.h"
+#include <vector>
+
+namespace PL {
+
+class RemoteException : public std::runtime_error {
+private:
+    Status status;
+
+public:
+    RemoteException(Status st, const std::string& message)
+        : std::runtime_error(message), status(st) {}
+
+    Status GetStatus() const { return status; }
+};
+
+// Blocking client for UnixSocketServer. Requests can be queued with Send()
+// and pushed in one gather write by Flush(); responses then arrive in
+// request order through Receive(). The typed helpers do a single round trip.
+class UnixSocketClient {
+private:
+    struct QueuedRequest {
+        FrameHeader header;
+        std::vector<uint8_t> payload;
+    };
+
+    int fd;
+    uint32_t nextRequestId;
+    std::vector<QueuedRequest> queue;
+    FrameDecoder decoder;
+    std::vector<uint8_t> readBuffer;
+
+    void WriteAll(std::vector<iovec>& vectors) {
+        size_t index = 0;
+        while (index < vectors.size()) {
+            msghdr message{};
+            message.msg_iov = vectors.data() + index;
+            message.msg_iovlen = std::min<size_t>(vectors.size() - index, 512);
+#ifdef MSG_NOSIGNAL
+            ssize_t sent = sendmsg(fd, &message, MSG_NOSIGNAL);
+#else
+            ssize_t sent = sendmsg(fd, &message, 0);
+#endif
+            if (sent < 0) {
+                if (errno == EINTR) continue;
+                throw SocketException("sendmsg failed");
+            }
+            size_t remaining = static_cast<size_t>(sent);
+            while (remaining > 0) {
+                if (remaining >= vectors[index].iov_len) {
+                    remaining -= vectors[index].iov_len;
+                    ++index;
+                } else {
+                    vectors[index].iov_base = static_cast<uint8_t*>(vectors[index].iov_base) + remaining;
+                    vectors[index].iov_len -= remaining;
+                    remaining = 0;
+                }
+            }
+        }
+    }
+
+    Response Expect(uint32_t requestId) {
+        Response response = Receive();
+        if (response.requestId != requestId) {
+            throw ProtocolException("Out-of-order response");
+        }
+        if (response.status != Status::Ok) {
+            BinaryReader reader(response.payload);
+            throw RemoteException(response.status, reader.ReadString());
+        }
+        return response;
+    }
+
+    Response Call(OpCode op, const BinaryWriter& request) {
+        uint32_t id = Send(op, request.Data());
+        Flush();
+        return Expect(id);
+    }
+
+public:
+    UnixSocketClient() : fd(-1), nextRequestId(1), readBuffer(64 * 1024) {}
+
+    explicit UnixSocketClient(const std::string& path) : UnixSocketClient() {
+        Connect(path);
+    }
+
+    ~UnixSocketClient() {
+        Close();
+    }
+
+    UnixSocketClient(const UnixSocketClient&) = delete;
+    UnixSocketClient& operator=(const UnixSocketClient&) = delete;
+
+    void Connect(const std::string& path) {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path)) {
+            throw std::invalid_argument("Socket path too long: " + path);
+        }
+        std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) {
+            throw SocketException("socket failed");
+        }
+        if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+            close(fd);
+            fd = -1;
+            throw SocketException("connect failed for " + path);
+        }
+    }
+
+    void Close() {
+        if (fd >= 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+
+    uint32_t Send(OpCode op, const std::vector<uint8_t>& payload) {
+        uint32_t id = nextRequestId++;
+        queue.push_back(QueuedRequest{FrameHeader(id, static_cast<uint8_t>(op), payload.size()), payload});
+        return id;
+    }
+
+    void Flush() {
+        if (queue.empty()) return;
+        std::vector<iovec> vectors;
+        vectors.reserve(queue.size() * 2);
+        for (auto& request : queue) {
+            vectors.push_back(iovec{request.header.bytes.data(), FrameHeaderSize});
+            if (!request.payload.empty()) {
+                vectors.push_back(iovec{request.payload.data(), request.payload.size()});
+            }
+        }
+        WriteAll(vectors);
+        queue.clear();
+    }
+
+    Response Receive() {
+        Frame frame;
+        while (!decoder.Next(frame)) {
+            ssize_t received = read(fd, readBuffer.data(), readBuffer.size());
+            if (received < 0) {
+                if (errno == EINTR) continue;
+                throw SocketException("read failed");
+            }
+            if (received == 0) {
+                throw ProtocolException("Connection closed by server");
+            }
+            decoder.Append(readBuffer.data(), static_cast<size_t>(received));
+        }
+        return Response{frame.requestId, static_cast<Status>(frame.code), std::move(frame.payload)};
+    }
+
+    void Ping() {
+        Call(OpCode::Ping, BinaryWriter());
+    }
+
+    RemoteStudent AddStudent(const std::string& firstName, const std::string& lastName,
+                            const std::string& groupName) {
+        BinaryWriter request;
+        request.WriteString(firstName);
+        request.WriteString(lastName);
+        request.WriteString(groupName);
+        Response response = Call(OpCode::AddStudent, request);
+        return BinaryReader(response.payload).ReadStudent();
+    }
+
+    void RemoveStudent(int studentId) {
+        BinaryWriter request;
+        request.WriteI32(studentId);
+        Call(OpCode::RemoveStudent, request);
+    }
+
+    void UpdateStudent(int studentId, const std::string& firstName,
+                       const std::string& lastName, const std::string& groupName) {
+        BinaryWriter request;
+        request.WriteI32(studentId);
+        request.WriteString(firstName);
+        request.WriteString(lastName);
+        request.WriteString(groupName);
+        Call(OpCode::UpdateStudent, request);
+    }
+
+    RemoteStudent GetStudent(int studentId) {
+        BinaryWriter request;
+        request.WriteI32(studentId);
+        Response response = Call(OpCode::GetStudent, request);
+        return BinaryReader(response.payload).ReadStudent();
+    }
+
+    void AddGrade(int studentId, const std::string& subject, int score) {
+        BinaryWriter request;
+        request.WriteI32(studentId);
+        request.WriteString(subject);
+        request.WriteI32(score);
+        Call(OpCode::AddGrade, request);
+    }
+
+    void RemoveGrade(int studentId, const std::string& subject) {
+        BinaryWriter request;
+        request.WriteI32(studentId);
+        request.WriteString(subject);
+        Call(OpCode::RemoveGrade, request);
+    }
+
+    std::vector<RemoteStudent> FindByName(const std::string& firstName, const std::string& lastName) {
+        BinaryWriter request;
+        request.WriteString(firstName);
+        request.WriteString(lastName);
+        Response response = Call(OpCode::FindByName, request);
+        return BinaryReader(response.payload).ReadStudents();
+    }
+
+    std::vector<RemoteStudent> FindByGroup(const std::string& groupName) {
+        BinaryWriter request;
+        request.WriteString(groupName);
+        Response response = Call(OpCode::FindByGroup, request);
+        return BinaryReader(response.payload).ReadStudents();
+    }
+
+    std::vector<RemoteStudent> FindByAverageGrade(double minAverage, double maxAverage) {
+        BinaryWriter request;
+        request.WriteDouble(minAverage);
+        request.WriteDouble(maxAverage);
+        Response response = Call(OpCode::FindByAverageGrade, request);
+        return BinaryReader(response.payload).ReadStudents();
+    }
+
+    std::vector<RemoteStudent> FindByPerformance(bool successful, const std::string& subject = "") {
+        BinaryWriter request;
+        request.WriteU8(successful ? 1 : 0);
+        request.WriteString(subject);
+        Response response = Call(OpCode::FindByPerformance, request);
+        return BinaryReader(response.payload).ReadStudents();
+    }
+
+    double GroupAverageGrade(const std::string& groupName) {
+        BinaryWriter request;
+        request.WriteString(groupName);
+        Response response = Call(OpCode::GroupAverageGrade, request);
+        return BinaryReader(response.payload).ReadDouble();
+    }
+
+    std::vector<RemoteStudent> GetAllStudents() {
+        Response response = Call(OpCode::GetAllStudents, BinaryWriter());
+        return BinaryReader(response.payload).ReadStudents();
+    }
+
+    BLL::Group AddGroup(const std::string& name, const std::string& specialization, int year) {
+        BinaryWriter request;
+        request.WriteString(name);
+        request.WriteString(specialization);
+        request.WriteI32(year);
+        Response response = Call(OpCode::AddGroup, request);
+        return BinaryReader(response.payload).ReadGroup();
+    }
+
+    void RemoveGroup(const std::string& name) {
+        BinaryWriter request;
+        request.WriteString(name);
+        Call(OpCode::RemoveGroup, request);
+    }
+
+    void UpdateGroup(const std::string& name, const std::string& specialization, int year) {
+        BinaryWriter request;
+        request.WriteString(name);
+        request.WriteString(specialization);
+        request.WriteI32(year);
+        Call(OpCode::UpdateGroup, request);
+    }
+
+    // Returns how many students are in the renamed group.
+    uint32_t RenameGroup(const std::string& name, const std::string& newName) {
+        BinaryWriter request;
+        request.WriteString(name);
+        request.WriteString(newName);
+        Response response = Call(OpCode::RenameGroup, request);
+        return BinaryReader(response.payload).ReadU32();
+    }
+
+    BLL::Group GetGroup(const std::string& name) {
+        BinaryWriter request;
+        request.WriteString(name);
+        Response response = Call(OpCode::GetGroup, request);
+        return BinaryReader(response.payload).ReadGroup();
+    }
+
+    std::vector<BLL::Group> GetAllGroups() {
+        Response response = Call(OpCode::GetAllGroups, BinaryWriter());
+        return BinaryReader(response.payload).ReadGroups();
+    }
+
+    std::vector<std::string> ListJournals() {
+        Response response = Call(OpCode::ListJournals, BinaryWriter());
+        return BinaryReader(response.payload).ReadStrings();
+    }
+
+    void SelectJournal(const std::string& name) {
+        BinaryWriter request;
+        request.WriteString(name);
+        Call(OpCode::SelectJournal, request);
+    }
+
+    std::vector<BLL::JournalStudent> FindByNameAllJournals(const std::string& firstName,
+                                                           const std::string& lastName) {
+        BinaryWriter request;
+        request.WriteString(firstName);
+        request.WriteString(lastName);
+        Response response = Call(OpCode::FindByNameAllJournals, request);
+        return BinaryReader(response.payload).ReadJournalStudents();
+    }
+
+    // Returns once the server has taken the snapshot, not when the backup
+    // file is complete.
+    // `name` is a file inside the server's backup directory.
+    void Backup(const std::string& name) {
+        BinaryWriter request;
+        request.WriteString(name);
+        Call(OpCode::Backup, request);
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,316 @@
+#ifndef SOCKETSERVER_H
+#define SOCKETSERVER_H
+
+#include "BinaryProtocol.h"
+#include <atomic>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace PL {
+
+class SocketException : public std::runtime_error {
+public:
+    explicit SocketException(const std::string& message)
+        : std::runtime_error(message + ": " + std::strerror(errno)) {}
+};
+
+// Single-threaded poll() loop serving the binary protocol on a Unix domain
+// socket. Every readable event drains all complete frames, and the replies
+// are gathered into a single sendmsg() per connection. A connection whose
+// unsent replies exceed MaxQueuedBytes is not read from until they drain,
+// so a client that never reads cannot make the server buffer without bound.
+class UnixSocketServer {
+private:
+    struct PendingResponse {
+        FrameHeader header;
+        std::vector<uint8_t> payload;
+        size_t written;
+    };
+
+    struct Connection {
+        FrameDecoder decoder;
+        std::deque<PendingResponse> outbox;
+        size_t queuedBytes = 0;
+        RequestDispatcher dispatcher;
+        bool closing = false;
+
+        explicit Connection(const RequestDispatcher& prototype)
+            : dispatcher(prototype) {}
+    };
+
+    static constexpr int MaxIovecs = 512;
+    static constexpr size_t ReadChunk = 64 * 1024;
+    static constexpr size_t MaxQueuedBytes = 1024 * 1024;
+#ifdef MSG_NOSIGNAL
+    static constexpr int SendFlags = MSG_NOSIGNAL;
+#else
+    static constexpr int SendFlags = 0;
+#endif
+
+    std::string socketPath;
+    RequestDispatcher dispatcher;
+    int listenFd;
+    std::map<int, Connection> connections;
+    std::atomic<bool> running;
+    std::vector<uint8_t> readBuffer;
+    std::shared_ptr<WorkloadCaptureWriter> capture;
+    uint32_t nextSession = 0;
+
+    static Diagnostics::Gauge& OpenConnections() {
+        static Diagnostics::Gauge& gauge = Diagnostics::MetricsRegistry::Instance().GetGauge("pl.server.connections");
+        return gauge;
+    }
+
+    static Diagnostics::Counter& PausedReads() {
+        static Diagnostics::Counter& counter = Diagnostics::MetricsRegistry::Instance().GetCounter("pl.server.reads_paused");
+        return counter;
+    }
+
+    static bool Backlogged(const Connection& connection) {
+        return connection.queuedBytes >= MaxQueuedBytes;
+    }
+
+    static void SetNonBlocking(int fd) {
+        int flags = fcntl(fd, F_GETFL, 0);
+        if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+            throw SocketException("fcntl failed");
+        }
+    }
+
+    void Listen() {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (socketPath.size() >= sizeof(address.sun_path)) {
+            throw std::invalid_argument("Socket path too long: " + socketPath);
+        }
+        std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+        listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listenFd < 0) {
+            throw SocketException("socket failed");
+        }
+        unlink(socketPath.c_str());
+        if (bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+            throw SocketException("bind failed for " + socketPath);
+        }
+        if (listen(listenFd, SOMAXCONN) < 0) {
+            throw SocketException("listen failed");
+        }
+        SetNonBlocking(listenFd);
+    }
+
+    void Accept() {
+        while (true) {
+            int fd = accept(listenFd, nullptr, nullptr);
+            if (fd < 0) {
+                return;
+            }
+            SetNonBlocking(fd);
+            auto inserted = connections.emplace(fd, dispatcher).first;
+            if (capture) {
+                inserted->second.dispatcher.SetCapture(capture, ++nextSession);
+            }
+            OpenConnections().Add(1);
+        }
+    }
+
+    void ReadRequests(int fd, Connection& connection) {
+        while (!Backlogged(connection) && !connection.closing) {
+            ssize_t received = read(fd, readBuffer.data(), readBuffer.size());
+            if (received > 0) {
+                connection.decoder.Append(readBuffer.data(), static_cast<size_t>(received));
+                DispatchRequests(connection);
+                continue;
+            }
+            if (received == 0) {
+                connection.closing = true;
+            } else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                connection.closing = true;
+            }
+            break;
+        }
+    }
+
+    // Answers buffered frames until the outbox is full; the rest stay in
+    // the decoder and are answered once the replies drain.
+    void DispatchRequests(Connection& connection) {
+        try {
+            Frame frame;
+            while (!Backlogged(connection) && connection.decoder.Next(frame)) {
+                Response response = connection.dispatcher.Dispatch(frame);
+                connection.queuedBytes += FrameHeaderSize + response.payload.size();
+                connection.outbox.push_back(PendingResponse{
+                    FrameHeader(response.requestId, static_cast<uint8_t>(response.status), response.payload.size()),
+                    std::move(response.payload),
+                    0
+                });
+            }
+        } catch (const ProtocolException&) {
+            connection.closing = true;
+            connection.decoder = FrameDecoder();
+        }
+        if (Backlogged(connection)) {
+            PausedReads().Add();
+        }
+    }
+
+    bool WriteResponses(int fd, Connection& connection) {
+        while (!connection.outbox.empty()) {
+            iovec vectors[MaxIovecs];
+            int count = 0;
+            for (auto it = connection.outbox.begin();
+                 it != connection.outbox.end() && count + 2 <= MaxIovecs; ++it) {
+                size_t offset = it->written;
+                if (offset < FrameHeaderSize) {
+                    vectors[count].iov_base = it->header.bytes.data() + offset;
+                    vectors[count].iov_len = FrameHeaderSize - offset;
+                    ++count;
+                    offset = 0;
+                } else {
+                    offset -= FrameHeaderSize;
+                }
+                if (offset < it->payload.size()) {
+                    vectors[count].iov_base = it->payload.data() + offset;
+                    vectors[count].iov_len = it->payload.size() - offset;
+                    ++count;
+                }
+            }
+
+            msghdr message{};
+            message.msg_iov = vectors;
+            message.msg_iovlen = static_cast<size_t>(count);
+            ssize_t sent = sendmsg(fd, &message, SendFlags);
+            if (sent < 0) {
+                return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+            }
+
+            size_t remaining = static_cast<size_t>(sent);
+            while (remaining > 0 && !connection.outbox.empty()) {
+                auto& front = connection.outbox.front();
+                size_t left = FrameHeaderSize + front.payload.size() - front.written;
+                if (remaining >= left) {
+                    remaining -= left;
+                    connection.queuedBytes -= left;
+                    connection.outbox.pop_front();
+                } else {
+                    front.written += remaining;
+                    connection.queuedBytes -= remaining;
+                    remaining = 0;
+                }
+            }
+        }
+        return true;
+    }
+
+public:
+    UnixSocketServer(const std::string& path,
+                     std::shared_ptr<BLL::StudentService> studServ,
+                     std::shared_ptr<BLL::GroupService> grpServ)
+        : socketPath(path),
+          dispatcher(studServ, grpServ),
+          listenFd(-1),
+          running(false),
+          readBuffer(ReadChunk) {}
+
+    UnixSocketServer(const std::string& path, std::shared_ptr<BLL::JournalSet> journals)
+        : socketPath(path),
+          dispatcher(journals),
+          listenFd(-1),
+          running(false),
+          readBuffer(ReadChunk) {}
+
+    ~UnixSocketServer() {
+        for (const auto& pair : connections) {
+            close(pair.first);
+        }
+        OpenConnections().Add(-static_cast<int64_t>(connections.size()));
+        if (listenFd >= 0) {
+            close(listenFd);
+            unlink(socketPath.c_str());
+        }
+    }
+
+    UnixSocketServer(const UnixSocketServer&) = delete;
+    UnixSocketServer& operator=(const UnixSocketServer&) = delete;
+
+    void Run() {
+        Listen();
+        running = true;
+
+        std::vector<pollfd> descriptors;
+        while (running) {
+            descriptors.clear();
+            descriptors.push_back(pollfd{listenFd, POLLIN, 0});
+            for (const auto& pair : connections) {
+                short events = Backlogged(pair.second) ? 0 : POLLIN;
+                if (!pair.second.outbox.empty()) {
+                    events |= POLLOUT;
+                }
+                descriptors.push_back(pollfd{pair.first, events, 0});
+            }
+
+            int ready = poll(descriptors.data(), descriptors.size(), 200);
+            if (ready < 0) {
+                if (errno == EINTR) continue;
+                throw SocketException("poll failed");
+            }
+            if (ready == 0) continue;
+
+            if (descriptors[0].revents & POLLIN) {
+                Accept();
+            }
+
+            for (size_t i = 1; i < descriptors.size(); ++i) {
+                int fd = descriptors[i].fd;
+                auto it = connections.find(fd);
+                if (it == connections.end()) continue;
+                Connection& connection = it->second;
+
+                if (descriptors[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+                    ReadRequests(fd, connection);
+                }
+                bool writable = WriteResponses(fd, connection);
+                if (writable && !Backlogged(connection) && connection.decoder.Pending() > 0) {
+                    DispatchRequests(connection);
+                }
+                if (!writable || (connection.closing && connection.outbox.empty())) {
+                    close(fd);
+                    connections.erase(it);
+                    OpenConnections().Add(-1);
+                }
+            }
+        }
+    }
+
+    void Stop() {
+        running = false;
+    }
+
+    // Backup requests write into this directory, created on demand.
+    void SetBackupDirectory(const std::string& directory) {
+        dispatcher.SetBackupDirectory(directory);
+    }
+
+    // Records every request of connections accepted from now on.
+    void SetCapture(std::shared_ptr<WorkloadCaptureWriter> writer) {
+        capture = std::move(writer);
+    }
+
+    size_t ConnectionCount() const {
+        return connections.size();
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,160 @@
+#ifndef WORKLOADCAPTURE_H
+#define WORKLOADCAPTURE_H
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace PL {
+
+// A capture file is the 8-byte header "GJWL" | u32 version followed by one
+// record per dispatched request (little-endian):
+//   u32 recordLength | u64 offsetNs | u32 session | u32 latencyNs | u8 opCode | u8 status | payload
+// offsetNs counts from the start of the capture; session tells connections
+// apart, because SelectJournal changes what later requests of the same
+// connection operate on. The payload is the request payload unchanged.
+
+constexpr char CaptureMagic[4] = {'G', 'J', 'W', 'L'};
+constexpr uint32_t CaptureVersion = 1;
+constexpr size_t CaptureRecordHeaderSize = 22;
+
+struct CapturedRequest {
+    uint64_t offsetNs = 0;
+    uint32_t session = 0;
+    uint32_t latencyNs = 0;
+    uint8_t code = 0;
+    uint8_t status = 0;
+    std::vector<uint8_t> payload;
+};
+
+class WorkloadCaptureWriter {
+private:
+    std::ofstream file;
+    std::mutex mutex;
+    const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    uint64_t recorded = 0;
+
+    template<typename Int>
+    static void Put(std::vector<uint8_t>& out, Int value) {
+        for (size_t i = 0; i < sizeof(Int); ++i) {
+            out.push_back(static_cast<uint8_t>(static_cast<uint64_t>(value) >> (8 * i)));
+        }
+    }
+
+public:
+    explicit WorkloadCaptureWriter(const std::string& path)
+        : file(path, std::ios::binary | std::ios::trunc) {
+        if (!file.is_open()) {
+            throw std::runtime_error("Cannot open capture file: " + path);
+        }
+        std::vector<uint8_t> header(CaptureMagic, CaptureMagic + 4);
+        Put(header, CaptureVersion);
+        file.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+    }
+
+    WorkloadCaptureWriter(const WorkloadCaptureWriter&) = delete;
+    WorkloadCaptureWriter& operator=(const WorkloadCaptureWriter&) = delete;
+
+    void Record(uint32_t session, uint8_t code, uint8_t status, const std::vector<uint8_t>& payload,
+                std::chrono::steady_clock::time_point start, std::chrono::steady_clock::duration latency) {
+        auto offset = std::chrono::duration_cast<std::chrono::nanoseconds>(start - epoch).count();
+        auto latencyNs = std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count();
+
+        std::vector<uint8_t> record;
+        record.reserve(CaptureRecordHeaderSize + payload.size());
+        Put(record, static_cast<uint32_t>(CaptureRecordHeaderSize - 4 + payload.size()));
+        Put(record, static_cast<uint64_t>(offset < 0 ? 0 : offset));
+        Put(record, session);
+        Put(record, static_cast<uint32_t>(std::min<long long>(latencyNs, UINT32_MAX)));
+        record.push_back(code);
+        record.push_back(status);
+        record.insert(record.end(), payload.begin(), payload.end());
+
+        std::lock_guard<std::mutex> lock(mutex);
+        file.write(reinterpret_cast<const char*>(record.data()), static_cast<std::streamsize>(record.size()));
+        ++recorded;
+    }
+
+    void Flush() {
+        std::lock_guard<std::mutex> lock(mutex);
+        file.flush();
+    }
+
+    uint64_t Recorded() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return recorded;
+    }
+};
+
+class WorkloadCaptureReader {
+private:
+    std::ifstream file;
+    std::string path;
+
+    template<typename Int>
+    static Int Get(const uint8_t* bytes) {
+        uint64_t value = 0;
+        for (size_t i = 0; i < sizeof(Int); ++i) {
+            value |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+        }
+        return static_cast<Int>(value);
+    }
+
+public:
+    explicit WorkloadCaptureReader(const std::string& capturePath)
+        : file(capturePath, std::ios::binary), path(capturePath) {
+        if (!file.is_open()) {
+            throw std::runtime_error("Cannot open capture file: " + path);
+        }
+        std::array<uint8_t, 8> header{};
+        file.read(reinterpret_cast<char*>(header.data()), header.size());
+        if (file.gcount() != static_cast<std::streamsize>(header.size()) ||
+            std::memcmp(header.data(), CaptureMagic, 4) != 0) {
+            throw std::runtime_error(path + " is not a workload capture");
+        }
+        if (Get<uint32_t>(header.data() + 4) != CaptureVersion) {
+            throw std::runtime_error("Unsupported capture version in " + path);
+        }
+    }
+
+    static bool IsCapture(const std::string& candidate) {
+        std::ifstream probe(candidate, std::ios::binary);
+        char magic[4] = {};
+        probe.read(magic, 4);
+        return probe.gcount() == 4 && std::memcmp(magic, CaptureMagic, 4) == 0;
+    }
+
+    // A truncated last record, left by a server that was killed, ends the
+    // stream like a clean end of file.
+    bool Next(CapturedRequest& request) {
+        std::array<uint8_t, CaptureRecordHeaderSize> header{};
+        file.read(reinterpret_cast<char*>(header.data()), header.size());
+        if (file.gcount() != static_cast<std::streamsize>(header.size())) {
+            return false;
+        }
+        uint32_t length = Get<uint32_t>(header.data());
+        if (length < CaptureRecordHeaderSize - 4) {
+            throw std::runtime_error("Corrupt record in capture " + path);
+        }
+        request.offsetNs = Get<uint64_t>(header.data() + 4);
+        request.session = Get<uint32_t>(header.data() + 12);
+        request.latencyNs = Get<uint32_t>(header.data() + 16);
+        request.code = header[20];
+        request.status = header[21];
+        request.payload.resize(length - (CaptureRecordHeaderSize - 4));
+        file.read(reinterpret_cast<char*>(request.payload.data()),
+                  static_cast<std::streamsize>(request.payload.size()));
+        return file.gcount() == static_cast<std::streamsize>(request.payload.size());
+    }
+};
+
+}
+
+#endif
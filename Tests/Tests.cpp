@@ -1,8 +1,28 @@
 #include <gtest/gtest.h>
 #include "Services.h"
 #include "DataAccess.h"
+#include "BinaryProtocol.h"
+#include "Profiler.h"
+#include "AppConfig.h"
+#include "LatencyHistogram.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include "Journal.h"
+#include "GroupReport.h"
+#include "Backup.h"
+#include "StorageFactory.h"
+#include "WALJsonStorage.h"
+#include "WALRestore.h"
+#include <atomic>
+#include <filesystem>
 #include <memory>
 #include <fstream>
+#include <shared_mutex>
+#include <thread>
+
+#ifndef _WIN32
+#include "SocketClient.h"
+#endif
 
 class MockStorage : public DAL::IDataStorage<BLL::Student> {
 private:
@@ -56,7 +76,7 @@ TEST_F(StudentServiceTest, AddStudent_ValidData_Success) {
 
     EXPECT_EQ(student.GetFirstName(), "John");
     EXPECT_EQ(student.GetLastName(), "Doe");
-    EXPECT_EQ(student.GetGroupName(), "CS-101");
+    EXPECT_EQ(service->GroupName(student), "CS-101");
     EXPECT_GT(student.GetId(), 0);
 }
 
@@ -107,7 +127,7 @@ TEST_F(StudentServiceTest, UpdateStudent_ValidData_Success) {
     auto updated = service->GetStudentById(student.GetId());
     EXPECT_EQ(updated->GetFirstName(), "Jane");
     EXPECT_EQ(updated->GetLastName(), "Smith");
-    EXPECT_EQ(updated->GetGroupName(), "CS-102");
+    EXPECT_EQ(service->GroupName(*updated), "CS-102");
 }
 
 TEST_F(StudentServiceTest, UpdateStudent_NonExisting_ThrowsException) {
@@ -253,6 +273,200 @@ TEST_F(StudentServiceTest, Count_ReturnsCorrectNumber) {
     EXPECT_EQ(service->Count(), 2);
 }
 
+TEST_F(StudentServiceTest, FindByNamePrefix_MatchesFirstOrLastName) {
+    service->AddStudent("John", "Doe", "CS-101");
+    service->AddStudent("Joanna", "Smith", "CS-102");
+    service->AddStudent("Bob", "Johnson", "CS-103");
+    service->AddStudent("Jane", "Doe", "CS-103");
+
+    auto result = service->FindByNamePrefix("jo", 10);
+
+    EXPECT_EQ(result.students.size(), 3);
+}
+
+TEST_F(StudentServiceTest, FindByNamePrefix_FirstAndLastPrefix_Narrows) {
+    service->AddStudent("John", "Doe", "CS-101");
+    service->AddStudent("John", "Smith", "CS-102");
+
+    auto result = service->FindByNamePrefix("john s", 10);
+
+    ASSERT_EQ(result.students.size(), 1);
+    EXPECT_EQ(result.students[0].GetLastName(), "Smith");
+}
+
+TEST_F(StudentServiceTest, FindByNamePrefix_CyrillicIsCaseFolded) {
+    service->AddStudent("Олена", "Шевченко", "КН-21");
+    service->AddStudent("Іван", "Петренко", "КН-21");
+
+    EXPECT_EQ(service->FindByNamePrefix("шев", 10).students.size(), 1);
+    EXPECT_EQ(service->FindByNamePrefix("ІВ", 10).students.size(), 1);
+    EXPECT_EQ(service->FindByNamePrefix("ів", 10).students.size(), 1);
+}
+
+TEST_F(StudentServiceTest, FindByNamePrefix_SeesLaterChanges) {
+    auto student = service->AddStudent("John", "Doe", "CS-101");
+    EXPECT_EQ(service->FindByNamePrefix("jo", 10).students.size(), 1);
+
+    service->UpdateStudent(student.GetId(), "Mark", "", "");
+
+    EXPECT_EQ(service->FindByNamePrefix("jo", 10).students.size(), 0);
+    EXPECT_EQ(service->FindByNamePrefix("ma", 10).students.size(), 1);
+}
+
+TEST_F(StudentServiceTest, FindByNamePrefix_StopRequested_ReturnsEarly) {
+    service->AddStudent("John", "Doe", "CS-101");
+    std::stop_source source;
+    source.request_stop();
+
+    auto result = service->FindByNamePrefix("jo", 10, source.get_token());
+
+    EXPECT_TRUE(result.students.empty());
+}
+
+TEST_F(StudentServiceTest, FindByNamePrefix_IndexDisabled_MatchesSameStudents) {
+    service->AddStudent("John", "Doe", "CS-101");
+    service->AddStudent("Jane", "Johnson", "CS-102");
+    service->AddStudent("Bob", "Smith", "CS-101");
+    auto indexed = service->FindByNamePrefix("jo", 10);
+
+    service->SetNamePrefixIndexEnabled(false);
+    auto scanned = service->FindByNamePrefix("jo", 10);
+
+    EXPECT_EQ(scanned.students.size(), indexed.students.size());
+    EXPECT_EQ(service->FindByNamePrefix("jane jo", 10).students.size(), 1);
+}
+
+TEST_F(StudentServiceTest, FindByNamePrefix_ConcurrentReadersAfterChange_SeeSameResult) {
+    for (int i = 0; i < 2000; ++i) {
+        service->AddStudent("Name" + std::to_string(i), "Last" + std::to_string(i), "CS-101");
+    }
+    for (int round = 0; round < 20; ++round) {
+        // Each update leaves the index stale, so the readers race to rebuild it.
+        service->UpdateStudent(service->GetAll()[0].GetId(), "Other" + std::to_string(round), "", "");
+        std::atomic<int> wrong{0};
+        std::vector<std::thread> readers;
+        for (int r = 0; r < 4; ++r) {
+            readers.emplace_back([&]() {
+                if (service->FindByNamePrefix("name1", 5000).candidates != 1111) ++wrong;
+            });
+        }
+        for (auto& reader : readers) {
+            reader.join();
+        }
+        EXPECT_EQ(wrong, 0);
+    }
+}
+
+TEST_F(StudentServiceTest, RemoveWhere_RemovesMatchesAndKeepsOrder) {
+    service->AddStudent("John", "Doe", "CS-101");
+    service->AddStudent("Jane", "Roe", "CS-102");
+    service->AddStudent("Bob", "Smith", "CS-101");
+    service->AddStudent("Ann", "Lee", "CS-103");
+    int groupId = service->Groups()->FindId("CS-101");
+
+    size_t removed = service->RemoveWhere([groupId](const BLL::Student& s) { return s.GetGroupId() == groupId; });
+
+    EXPECT_EQ(removed, 2);
+    auto remaining = storage->Load();
+    ASSERT_EQ(remaining.size(), 2);
+    EXPECT_EQ(remaining[0].GetFirstName(), "Jane");
+    EXPECT_EQ(remaining[1].GetFirstName(), "Ann");
+    EXPECT_TRUE(service->FindByGroup("CS-101").empty());
+    EXPECT_EQ(service->FindByGroup("CS-103").size(), 1);
+}
+
+TEST_F(StudentServiceTest, BulkOperations_FailedValidationOrSave_ChangeNothing) {
+    class FailingStorage : public MockStorage {
+    public:
+        void SaveChanges(const std::vector<BLL::Student>&, const DAL::ChangeSet<BLL::Student>&) override {
+            throw DAL::DataAccessException("disk full");
+        }
+    };
+    service->AddStudent("John", "Doe", "CS-101");
+    service->AddStudent("Jane", "Roe", "CS-102");
+    auto everyone = [](const BLL::Student&) { return true; };
+
+    EXPECT_THROW(service->UpdateWhere(everyone, [](BLL::Student& s) {
+                     s.SetFirstName(s.GetFirstName() == "Jane" ? std::string(60, 'x') : "Johnny");
+                 }),
+                 BLL::ValidationException);
+    EXPECT_EQ(service->GetAll()[0].GetFirstName(), "John");
+
+    auto failing = std::make_shared<FailingStorage>();
+    failing->Save(service->GetAll());
+    BLL::StudentService unsaved(failing, service->Groups());
+    EXPECT_THROW(unsaved.RemoveWhere([](const BLL::Student& s) { return s.GetFirstName() == "John"; }),
+                 BLL::BusinessLogicException);
+    ASSERT_EQ(unsaved.Count(), 2);
+    EXPECT_EQ(unsaved.GetAll()[0].GetFirstName(), "John");
+    EXPECT_EQ(unsaved.FindByGroup("CS-101").size(), 1);
+}
+
+// Readers share a lock and writers take it exclusively, as in LoadTest; the
+// read paths must not modify any index.
+TEST_F(StudentServiceTest, ConcurrentReadsWithWrites_SeeConsistentGroups) {
+    for (int i = 0; i < 1000; ++i) {
+        service->AddStudent("First" + std::to_string(i), "Last" + std::to_string(i), "RW-" + std::to_string(i % 8));
+    }
+    std::shared_mutex mutex;
+    std::atomic<int> inconsistent{0};
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r) {
+        readers.emplace_back([&, r]() {
+            for (int i = 0; i < 400; ++i) {
+                std::string group = "RW-" + std::to_string((i + r) % 8);
+                std::shared_lock lock(mutex);
+                for (const auto& student : service->FindByGroup(group)) {
+                    if (service->GroupName(student) != group) ++inconsistent;
+                }
+                service->CalculateGroupAverageGrade(group);
+            }
+        });
+    }
+    for (int i = 0; i < 200; ++i) {
+        std::unique_lock lock(mutex);
+        service->UpdateStudent(service->GetAll()[static_cast<size_t>(i)].GetId(), "", "", "RW-" + std::to_string((i + 3) % 8));
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(inconsistent, 0);
+    auto moved = service->FindByGroup("RW-3");
+    ASSERT_EQ(moved.size(), 125);
+    EXPECT_EQ(moved.front().GetId(), service->GetAll()[0].GetId());
+}
+
+// Single-record writes patch the membership index instead of rebuilding it;
+// the patched index must match one rebuilt by loading the same data.
+TEST_F(StudentServiceTest, MembershipIndex_PatchedBySingleWrites_MatchesReload) {
+    std::vector<int> ids;
+    for (int i = 0; i < 60; ++i) {
+        ids.push_back(service->AddStudent("First" + std::to_string(i), "Last", "M-" + std::to_string(i % 5)).GetId());
+    }
+    for (int i = 0; i < 60; i += 7) {
+        service->RemoveStudent(ids[static_cast<size_t>(i)]);
+    }
+    for (int i = 1; i < 60; i += 3) {
+        if (i % 7 != 0) {
+            service->UpdateStudent(ids[static_cast<size_t>(i)], "", "", "M-" + std::to_string((i + 2) % 6));
+        }
+    }
+    service->AddStudent("Late", "Comer", "M-0");
+
+    BLL::StudentService reloaded(storage, service->Groups());
+    for (int g = 0; g < 6; ++g) {
+        std::string group = "M-" + std::to_string(g);
+        auto patched = service->FindByGroup(group);
+        auto rebuilt = reloaded.FindByGroup(group);
+        ASSERT_EQ(patched.size(), rebuilt.size()) << group;
+        for (size_t i = 0; i < patched.size(); ++i) {
+            EXPECT_EQ(patched[i].GetId(), rebuilt[i].GetId()) << group;
+        }
+        EXPECT_EQ(service->CountInGroup(service->Groups()->FindId(group)), rebuilt.size());
+    }
+}
+
 class GroupServiceTest : public ::testing::Test {
 protected:
     std::shared_ptr<MockGroupStorage> storage;
@@ -334,6 +548,118 @@ TEST_F(GroupServiceTest, GetGroupByName_NonExisting_ReturnsNull) {
     EXPECT_EQ(group, nullptr);
 }
 
+TEST_F(GroupServiceTest, RenameGroup_WritesOnlyTheGroupRecord) {
+    class CountingStorage : public MockStorage {
+    public:
+        int saves = 0;
+        void SaveChanges(const std::vector<BLL::Student>& items, const DAL::ChangeSet<BLL::Student>& changes) override {
+            ++saves;
+            MockStorage::SaveChanges(items, changes);
+        }
+    };
+    auto studentStorage = std::make_shared<CountingStorage>();
+    auto students = std::make_shared<BLL::StudentService>(studentStorage, service);
+    int groupId = service->AddGroup("CS-101", "Computer Science", 1).GetId();
+    students->AddStudent("John", "Doe", "CS-101");
+    students->AddStudent("Jane", "Roe", "CS-101");
+    students->AddStudent("Bob", "Smith", "CS-102");
+    int saves = studentStorage->saves;
+
+    service->RenameGroup("CS-101", "CS-201");
+
+    EXPECT_EQ(studentStorage->saves, saves);
+    EXPECT_EQ(service->GetGroupByName("CS-101"), nullptr);
+    ASSERT_NE(service->GetGroupByName("CS-201"), nullptr);
+    EXPECT_EQ(service->GetGroupByName("CS-201")->GetId(), groupId);
+    EXPECT_EQ(service->GetGroupByName("CS-201")->GetSpecialization(), "Computer Science");
+    EXPECT_TRUE(students->FindByGroup("CS-101").empty());
+    EXPECT_EQ(students->FindByGroup("CS-201").size(), 2);
+    EXPECT_EQ(students->FindByGroup("CS-102").size(), 1);
+    EXPECT_EQ(students->GroupName(students->GetAll()[0]), "CS-201");
+
+    auto reloadedGroups = std::make_shared<BLL::GroupService>(storage);
+    BLL::StudentService reloaded(studentStorage, reloadedGroups);
+    EXPECT_EQ(reloaded.FindByGroup("CS-201").size(), 2);
+}
+
+TEST_F(GroupServiceTest, RenameGroup_ToExistingName_ThrowsAndKeepsMembers) {
+    auto students = std::make_shared<BLL::StudentService>(std::make_shared<MockStorage>(), service);
+    service->AddGroup("CS-101", "Computer Science", 1);
+    service->AddGroup("CS-102", "Computer Science", 1);
+    students->AddStudent("John", "Doe", "CS-101");
+
+    EXPECT_THROW(service->RenameGroup("CS-101", "CS-102"), BLL::DuplicateEntityException);
+    EXPECT_THROW(service->RenameGroup("CS-999", "CS-103"), BLL::GroupNotFoundException);
+    EXPECT_EQ(students->FindByGroup("CS-101").size(), 1);
+}
+
+TEST_F(GroupServiceTest, RemoveGroup_WithStudents_ThrowsUntilEmpty) {
+    auto students = std::make_shared<BLL::StudentService>(std::make_shared<MockStorage>(), service);
+    auto student = students->AddStudent("John", "Doe", "CS-101");
+
+    EXPECT_THROW(service->RemoveGroup("CS-101"), BLL::BusinessLogicException);
+    students->RemoveStudent(student.GetId());
+    EXPECT_NO_THROW(service->RemoveGroup("CS-101"));
+    EXPECT_EQ(service->FindId("CS-101"), -1);
+}
+
+TEST_F(GroupServiceTest, UpdateWhere_AdvancesMatchingYears) {
+    service->AddGroup("CS-101", "Computer Science", 1);
+    service->AddGroup("CS-201", "Computer Science", 2);
+    service->AddGroup("SE-101", "Software Engineering", 1);
+
+    size_t advanced = service->UpdateWhere([](const BLL::Group& g) { return g.GetYear() == 1; },
+                                           [](BLL::Group& g) { g.SetYear(g.GetYear() + 1); });
+
+    EXPECT_EQ(advanced, 2);
+    auto saved = storage->Load();
+    EXPECT_EQ(saved[0].GetYear(), 2);
+    EXPECT_EQ(saved[1].GetYear(), 2);
+    EXPECT_EQ(saved[2].GetYear(), 2);
+    EXPECT_THROW(service->UpdateWhere([](const BLL::Group&) { return true; },
+                                      [](BLL::Group& g) { g = BLL::Group("CS-999", g.GetSpecialization(), g.GetYear()); }),
+                 BLL::ValidationException);
+}
+
+TEST_F(GroupServiceTest, Report_BySpecialization_MatchesGroupAverages) {
+    service->AddGroup("CS-101", "Computer Science", 1);
+    service->AddGroup("CS-201", "Computer Science", 2);
+    service->AddGroup("SE-101", "Software Engineering", 1);
+
+    std::vector<BLL::Student> roster;
+    int groups[] = {service->FindId("CS-101"), service->FindId("CS-201"), service->FindId("SE-101"), 999};
+    for (int i = 0; i < 10000; ++i) {
+        BLL::Student student(i + 1, "First", "Last", groups[i % 4]);
+        student.AddGrade(BLL::Grade("Math", 60 + i % 41));
+        roster.push_back(student);
+    }
+    auto studentStorage = std::make_shared<MockStorage>();
+    studentStorage->Save(roster);
+    BLL::StudentService students(studentStorage, service);
+
+    auto rows = BLL::GroupReport::Build(students, *service, BLL::GroupAttribute::Specialization);
+    ASSERT_EQ(rows.size(), 3);
+    EXPECT_EQ(rows[0].key, "Computer Science");
+    EXPECT_EQ(rows[0].groups, 2);
+    EXPECT_EQ(rows[0].students, 5000);
+    EXPECT_NEAR(rows[1].averageGrade, students.CalculateGroupAverageGrade("SE-101"), 1e-9);
+    EXPECT_EQ(rows[2].key, BLL::UnknownGroupKey);
+    EXPECT_EQ(rows[2].students, 2500);
+
+    BLL::ThreadPool pool(4);
+    auto parallel = BLL::GroupReport::Build(students, *service, BLL::GroupAttribute::Year, &pool);
+    auto serial = BLL::GroupReport::Build(students, *service, BLL::GroupAttribute::Year);
+    ASSERT_EQ(parallel.size(), serial.size());
+    for (size_t i = 0; i < serial.size(); ++i) {
+        EXPECT_EQ(parallel[i].key, serial[i].key);
+        EXPECT_EQ(parallel[i].students, serial[i].students);
+        EXPECT_EQ(parallel[i].grades, serial[i].grades);
+        EXPECT_NEAR(parallel[i].averageGrade, serial[i].averageGrade, 1e-9);
+    }
+    EXPECT_EQ(serial[0].key, "1");
+    EXPECT_EQ(serial[0].students, 5000);
+}
+
 class GradeTest : public ::testing::Test {};
 
 TEST_F(GradeTest, Constructor_InitializesCorrectly) {
@@ -376,23 +702,904 @@ TEST_F(GradeTest, Constructor_InvalidScore_ThrowsException) {
 class StudentTest : public ::testing::Test {};
 
 TEST_F(StudentTest, GetFullName_ReturnsCorrectFormat) {
-    BLL::Student student(1, "John", "Doe", "CS-101");
+    BLL::Student student(1, "John", "Doe", 1);
     EXPECT_EQ(student.GetFullName(), "John Doe");
 }
 
 TEST_F(StudentTest, HasGrade_ExistingSubject_ReturnsTrue) {
-    BLL::Student student(1, "John", "Doe", "CS-101");
+    BLL::Student student(1, "John", "Doe", 1);
     student.AddGrade(BLL::Grade("Math", 85));
 
     EXPECT_TRUE(student.HasGrade("Math"));
 }
 
 TEST_F(StudentTest, HasGrade_NonExistingSubject_ReturnsFalse) {
-    BLL::Student student(1, "John", "Doe", "CS-101");
+    BLL::Student student(1, "John", "Doe", 1);
 
     EXPECT_FALSE(student.HasGrade("Math"));
 }
 
+TEST_F(StudentTest, GroupId_SerializedAndLegacyNamesMigratedOnLoad) {
+    BLL::Student student(1, "John", "Doe", 7);
+    EXPECT_EQ(student.ToJson()["groupId"], 7);
+    EXPECT_EQ(BLL::Student::FromJson(student.ToJson()).GetGroupId(), 7);
+
+    auto groupStorage = std::make_shared<MockGroupStorage>();
+    groupStorage->Save({BLL::Group(5, "CS-101", "Computer Science", 1),
+                        BLL::Group::FromJson({{"name", "CS-102"}, {"specialization", ""}, {"year", 2}})});
+    auto storage = std::make_shared<MockStorage>();
+    storage->Save({BLL::Student::FromJson({{"id", 1}, {"firstName", "Jane"}, {"lastName", "Roe"},
+                                           {"groupName", "CS-101"}}),
+                   BLL::Student::FromJson({{"id", 2}, {"firstName", "Bob"}, {"lastName", "Smith"},
+                                           {"groupName", "CS-103"}})});
+    auto groups = std::make_shared<BLL::GroupService>(groupStorage);
+    BLL::StudentService service(storage, groups);
+
+    EXPECT_EQ(groupStorage->Load()[1].GetId(), 6);
+    EXPECT_EQ(storage->Load()[0].GetGroupId(), 5);
+    EXPECT_EQ(storage->Load()[1].GetGroupId(), groups->FindId("CS-103"));
+    EXPECT_EQ(service.FindByGroup("CS-101").size(), 1);
+    EXPECT_EQ(groupStorage->Load().size(), 3);
+}
+
+class BinaryProtocolTest : public ::testing::Test {
+protected:
+    std::shared_ptr<BLL::StudentService> studentService;
+    std::shared_ptr<BLL::GroupService> groupService;
+
+    void SetUp() override {
+        groupService = std::make_shared<BLL::GroupService>(std::make_shared<MockGroupStorage>());
+        studentService = std::make_shared<BLL::StudentService>(std::make_shared<MockStorage>(), groupService);
+    }
+};
+
+TEST_F(BinaryProtocolTest, Student_RoundTrip_PreservesFields) {
+    BLL::Student student(7, "John", "Doe", 3);
+    student.AddGrade(BLL::Grade("Math", 85));
+    student.AddGrade(BLL::Grade("Physics", 90));
+
+    PL::BinaryWriter writer;
+    writer.WriteStudent(student, "CS-101");
+    PL::BinaryReader reader(writer.Data());
+    auto decoded = reader.ReadStudent();
+
+    EXPECT_EQ(decoded.student.GetId(), 7);
+    EXPECT_EQ(decoded.student.GetFullName(), "John Doe");
+    EXPECT_EQ(decoded.groupName, "CS-101");
+    EXPECT_EQ(decoded.student.GetGrades().size(), 2);
+    EXPECT_TRUE(reader.AtEnd());
+}
+
+TEST_F(BinaryProtocolTest, FrameDecoder_SplitAndPipelinedFrames_DecodesAll) {
+    auto first = PL::EncodeFrame(1, static_cast<uint8_t>(PL::OpCode::Ping), {});
+    auto second = PL::EncodeFrame(2, static_cast<uint8_t>(PL::OpCode::GetStudent), {1, 0, 0, 0});
+    std::vector<uint8_t> stream(first);
+    stream.insert(stream.end(), second.begin(), second.end());
+
+    PL::FrameDecoder decoder;
+    PL::Frame frame;
+    decoder.Append(stream.data(), 5);
+    EXPECT_FALSE(decoder.Next(frame));
+
+    decoder.Append(stream.data() + 5, stream.size() - 5);
+    ASSERT_TRUE(decoder.Next(frame));
+    EXPECT_EQ(frame.requestId, 1);
+    ASSERT_TRUE(decoder.Next(frame));
+    EXPECT_EQ(frame.requestId, 2);
+    EXPECT_EQ(frame.payload.size(), 4);
+    EXPECT_FALSE(decoder.Next(frame));
+}
+
+TEST_F(BinaryProtocolTest, Dispatch_MissingStudent_ReturnsNotFound) {
+    PL::RequestDispatcher dispatcher(studentService, groupService);
+    PL::BinaryWriter payload;
+    payload.WriteI32(999);
+
+    auto response = dispatcher.Dispatch(PL::Frame{3, static_cast<uint8_t>(PL::OpCode::GetStudent), payload.Release()});
+
+    EXPECT_EQ(response.requestId, 3);
+    EXPECT_EQ(response.status, PL::Status::NotFound);
+}
+
+TEST_F(BinaryProtocolTest, Dispatch_TruncatedPayload_ReturnsBadRequest) {
+    PL::RequestDispatcher dispatcher(studentService, groupService);
+
+    auto response = dispatcher.Dispatch(PL::Frame{4, static_cast<uint8_t>(PL::OpCode::RemoveStudent), {1, 2}});
+
+    EXPECT_EQ(response.status, PL::Status::BadRequest);
+}
+
+TEST_F(BinaryProtocolTest, Capture_RecordsRequestsAndReadsThemBack) {
+    std::string path = (std::filesystem::temp_directory_path() / "gradejournal_capture_test.bin").string();
+    {
+        auto capture = std::make_shared<PL::WorkloadCaptureWriter>(path);
+        PL::RequestDispatcher dispatcher(studentService, groupService);
+        dispatcher.SetCapture(capture, 7);
+        PL::BinaryWriter add;
+        add.WriteString("John");
+        add.WriteString("Doe");
+        add.WriteString("CS-101");
+        dispatcher.Dispatch(PL::Frame{1, static_cast<uint8_t>(PL::OpCode::AddStudent), add.Release()});
+        dispatcher.Dispatch(PL::Frame{2, static_cast<uint8_t>(PL::OpCode::GetStudent), {99, 0, 0, 0}});
+        capture->Flush();
+        EXPECT_EQ(capture->Recorded(), 2);
+    }
+    std::ofstream(path, std::ios::binary | std::ios::app) << "torn";
+
+    ASSERT_TRUE(PL::WorkloadCaptureReader::IsCapture(path));
+    PL::WorkloadCaptureReader reader(path);
+    PL::CapturedRequest first, second, extra;
+    ASSERT_TRUE(reader.Next(first));
+    ASSERT_TRUE(reader.Next(second));
+    EXPECT_FALSE(reader.Next(extra));
+    std::filesystem::remove(path);
+
+    EXPECT_EQ(first.session, 7);
+    EXPECT_EQ(first.code, static_cast<uint8_t>(PL::OpCode::AddStudent));
+    EXPECT_EQ(first.status, static_cast<uint8_t>(PL::Status::Ok));
+    EXPECT_EQ(second.status, static_cast<uint8_t>(PL::Status::NotFound));
+    EXPECT_EQ(second.payload, (std::vector<uint8_t>{99, 0, 0, 0}));
+    EXPECT_GE(second.offsetNs, first.offsetNs);
+}
+
+class ProfilerTest : public ::testing::Test {};
+
+TEST_F(ProfilerTest, TimedStorage_CountsStorageCalls) {
+    auto timer = std::make_shared<DAL::StorageTimer>();
+    auto storage = std::make_shared<DAL::TimedStorage<BLL::Student>>(std::make_shared<MockStorage>(), timer);
+    BLL::StudentService service(storage);
+
+    service.AddStudent("John", "Doe", "CS-101");
+
+    EXPECT_EQ(timer->calls.load(), 2);
+}
+
+TEST_F(ProfilerTest, EndAction_RecordsPhases) {
+    PL::Profiler profiler;
+    auto storage = std::make_shared<DAL::TimedStorage<BLL::Student>>(
+        std::make_shared<MockStorage>(), profiler.GetStorageTimer());
+    BLL::StudentService service(storage);
+
+    profiler.BeginAction("Add Student");
+    profiler.TimeService([&]() { return service.AddStudent("John", "Doe", "CS-101"); });
+    profiler.EndAction();
+
+    ASSERT_EQ(profiler.GetSamples().size(), 1);
+    const auto& sample = profiler.GetSamples().front();
+    EXPECT_EQ(sample.name, "Add Student");
+    EXPECT_FALSE(sample.failed);
+    EXPECT_GE(sample.wallMs, sample.storageMs);
+    EXPECT_FALSE(profiler.IsActive());
+}
+
+class AppConfigTest : public ::testing::Test {};
+
+TEST_F(AppConfigTest, Load_OverridesReplaceFileValues) {
+    json root = {{"storage", {{"students", {{"backend", "wal"}, {"compactAfter", 50}}}}}, {"threads", 2}};
+
+    PL::AppConfig::ApplyOverride(root, "storage.students.compactAfter=500");
+    PL::AppConfig::ApplyOverride(root, "storage.students.fsync=always");
+    PL::AppConfig::ApplyOverride(root, "indexes.namePrefix=false");
+    PL::AppConfig::ApplyOverride(root, "storage.groups.backend=wal");
+    auto config = PL::AppConfig::FromJson(root);
+
+    EXPECT_EQ(config.students.type, DAL::StorageType::WAL);
+    EXPECT_EQ(config.students.compactAfter, 500);
+    EXPECT_EQ(config.students.fsync, DAL::FsyncMode::Always);
+    EXPECT_EQ(config.groups.type, DAL::StorageType::WAL);
+    EXPECT_EQ(config.threads, 2);
+    EXPECT_FALSE(config.namePrefixIndex);
+}
+
+TEST_F(AppConfigTest, FromJson_InvalidSettings_ThrowsException) {
+    json root = json::object();
+
+    EXPECT_THROW(PL::AppConfig::FromJson({{"storage", {{"groups", {{"backend", "sqlite"}}}}}}), PL::ConfigException);
+    EXPECT_THROW(PL::AppConfig::FromJson({{"storage", {{"students", {{"compactAfter", 0}}}}}}), PL::ConfigException);
+    EXPECT_THROW(PL::AppConfig::FromJson({{"thread", 4}}), PL::ConfigException);
+    EXPECT_THROW(PL::AppConfig::ApplyOverride(root, "threads"), PL::ConfigException);
+}
+
+class LatencyHistogramTest : public ::testing::Test {};
+
+TEST_F(LatencyHistogramTest, Percentile_WithinOnePercent) {
+    Diagnostics::LatencyHistogram histogram;
+    for (uint64_t value = 1; value <= 100000; ++value) {
+        histogram.Record(value * 1000);
+    }
+
+    EXPECT_EQ(histogram.Count(), 100000);
+    EXPECT_NEAR(static_cast<double>(histogram.Percentile(50)), 50000000.0, 500000.0);
+    EXPECT_NEAR(static_cast<double>(histogram.Percentile(99.9)), 99900000.0, 999000.0);
+    EXPECT_EQ(histogram.Percentile(100), histogram.Max());
+    EXPECT_EQ(histogram.Min(), 1000);
+}
+
+TEST_F(LatencyHistogramTest, Merge_CombinesCounts) {
+    Diagnostics::LatencyHistogram fast;
+    Diagnostics::LatencyHistogram slow;
+    for (int i = 0; i < 90; ++i) fast.Record(100);
+    for (int i = 0; i < 10; ++i) slow.Record(1000000);
+
+    fast.Merge(slow);
+
+    EXPECT_EQ(fast.Count(), 100);
+    EXPECT_EQ(fast.Percentile(90), 100);
+    EXPECT_GE(fast.Percentile(99), 990000);
+    EXPECT_EQ(fast.Max(), 1000000);
+}
+
+class MetricsTest : public ::testing::Test {};
+
+TEST_F(MetricsTest, Counter_SumsShardsAcrossThreads) {
+    Diagnostics::Counter& counter = Diagnostics::MetricsRegistry::Instance().GetCounter("test.counter.sharded");
+    uint64_t before = counter.Value();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&counter]() {
+            for (int i = 0; i < 1000; ++i) counter.Add();
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    EXPECT_EQ(counter.Value() - before, 4000);
+    EXPECT_EQ(&counter, &Diagnostics::MetricsRegistry::Instance().GetCounter("test.counter.sharded"));
+}
+
+TEST_F(MetricsTest, ScopedOperation_RecordsLatencyAndErrors) {
+    Diagnostics::OperationSite site("test.scoped");
+    { Diagnostics::ScopedOperation operation(site); }
+    try {
+        Diagnostics::ScopedOperation operation(site);
+        throw std::runtime_error("failed");
+    } catch (const std::runtime_error&) {}
+
+    EXPECT_EQ(site.latency.Snapshot().Count(), 2);
+    EXPECT_EQ(site.errors.Value(), 1);
+
+    auto snapshot = Diagnostics::MetricsRegistry::Instance().ToJson();
+    EXPECT_EQ(snapshot["operations"]["test.scoped"]["count"], 2);
+    EXPECT_EQ(snapshot["counters"]["test.scoped.errors"], 1);
+    std::string text = Diagnostics::MetricsRegistry::Instance().ToPrometheus();
+    EXPECT_NE(text.find("gradejournal_operation_seconds_count{op=\"test.scoped\"} 2"), std::string::npos);
+    EXPECT_NE(text.find("gradejournal_test_scoped_errors_total 1"), std::string::npos);
+}
+
+TEST_F(MetricsTest, AllocationProfile_SplitsSelfFromNested) {
+    Diagnostics::OperationSite outer("test.alloc.outer");
+    Diagnostics::OperationSite inner("test.alloc.inner");
+    Diagnostics::MetricsRegistry::SetAllocationProfiling(true);
+    {
+        Diagnostics::ScopedOperation outerOperation(outer);
+        Diagnostics::AllocationCounter::RecordAllocation(100);
+        {
+            Diagnostics::ScopedOperation innerOperation(inner);
+            Diagnostics::AllocationCounter::RecordAllocation(40);
+            Diagnostics::AllocationCounter::RecordAllocation(60);
+        }
+    }
+    Diagnostics::MetricsRegistry::SetAllocationProfiling(false);
+
+    EXPECT_EQ(outer.allocations.calls, 1);
+    EXPECT_EQ(outer.allocations.allocations, 3);
+    EXPECT_EQ(outer.allocations.bytes, 200);
+    EXPECT_EQ(outer.allocations.selfAllocations, 1);
+    EXPECT_EQ(outer.allocations.selfBytes, 100);
+    EXPECT_EQ(inner.allocations.selfBytes, 100);
+    EXPECT_EQ(inner.allocations.bytes, 100);
+}
+
+TEST_F(MetricsTest, Trace_RecordsSpansOnlyWhileEnabled) {
+    auto countSpans = [](const std::string& name) {
+        auto trace = Diagnostics::Tracer::Instance().ToChromeJson();
+        return std::count_if(trace["traceEvents"].begin(), trace["traceEvents"].end(),
+            [&name](const json& event) { return event["ph"] == "X" && event["name"] == name; });
+    };
+    Diagnostics::OperationSite site("test.traced");
+
+    { Diagnostics::TraceSpan span("test.span"); }
+    Diagnostics::Tracer::SetEnabled(true);
+    { Diagnostics::TraceSpan span("test.span"); }
+    std::thread([&site]() { Diagnostics::ScopedOperation operation(site); }).join();
+    Diagnostics::Tracer::SetEnabled(false);
+    { Diagnostics::TraceSpan span("test.span"); }
+
+    EXPECT_EQ(countSpans("test.span"), 1);
+    EXPECT_EQ(countSpans("test.traced"), 1);
+}
+
+class JournalSetTest : public ::testing::Test {
+protected:
+    std::shared_ptr<BLL::JournalSet> journals;
+
+    std::shared_ptr<BLL::StudentService> AddJournal(const std::string& name) {
+        auto groups = std::make_shared<BLL::GroupService>(std::make_shared<MockGroupStorage>());
+        auto students = std::make_shared<BLL::StudentService>(std::make_shared<MockStorage>(), groups);
+        journals->Add(name, students);
+        return students;
+    }
+
+    void SetUp() override {
+        journals = std::make_shared<BLL::JournalSet>(std::make_shared<BLL::ThreadPool>(2));
+    }
+};
+
+TEST_F(JournalSetTest, FindByName_FansOutAcrossJournals) {
+    AddJournal("physics")->AddStudent("John", "Doe", "PH-1");
+    auto math = AddJournal("math");
+    math->AddStudent("John", "Smith", "MA-1");
+    math->AddStudent("Jane", "Roe", "MA-1");
+
+    auto found = journals->FindByName("John", "");
+
+    ASSERT_EQ(found.size(), 2);
+    EXPECT_EQ(found[0].journal, "math");
+    EXPECT_EQ(found[1].journal, "physics");
+    EXPECT_EQ(journals->TotalStudents(), 3);
+}
+
+TEST_F(JournalSetTest, Get_UnknownJournal_ThrowsException) {
+    AddJournal("math");
+
+    EXPECT_THROW(journals->Get("history"), BLL::JournalNotFoundException);
+    EXPECT_THROW(AddJournal("math"), BLL::DuplicateEntityException);
+}
+
+TEST_F(JournalSetTest, Open_LoadsEverySubdirectory) {
+    namespace fs = std::filesystem;
+    fs::path root = fs::temp_directory_path() / ("gradejournal_journals_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()));
+    fs::remove_all(root);
+    BLL::StorageProvider<BLL::Student> studentStorage = [](const std::string& path) {
+        return DAL::StorageFactory<BLL::Student>::Create(DAL::StorageType::Simple, path);
+    };
+    BLL::StorageProvider<BLL::Group> groupStorage = [](const std::string& path) {
+        return std::make_shared<DAL::JsonStorage<BLL::Group>>(path);
+    };
+    for (std::string name : {"alpha", "beta", "gamma"}) {
+        fs::create_directories(root / name);
+        auto groups = std::make_shared<BLL::GroupService>(groupStorage((root / name / "groups.json").string()));
+        BLL::StudentService students(studentStorage((root / name / "students.json").string()), groups);
+        students.AddStudent("Student", name, "G-1");
+    }
+
+    auto opened = BLL::JournalSet::Open(root.string(), studentStorage, groupStorage);
+
+    EXPECT_EQ(opened->GetNames(), (std::vector<std::string>{"alpha", "beta", "gamma"}));
+    EXPECT_EQ(opened->Get("beta")->students->GetAll().front().GetLastName(), "beta");
+    EXPECT_EQ(opened->FindByName("Student", "").size(), 3);
+    EXPECT_EQ(opened->FindByGroup("G-1").size(), 3);
+    EXPECT_EQ(opened->FindByName("Student", "").front().groupName, "G-1");
+    fs::remove_all(root);
+}
+
+TEST_F(JournalSetTest, Dispatch_SelectJournal_SwitchesServices) {
+    AddJournal("math")->AddStudent("John", "Smith", "MA-1");
+    AddJournal("physics");
+    PL::RequestDispatcher dispatcher(journals);
+    PL::BinaryWriter select;
+    select.WriteString("physics");
+
+    auto before = dispatcher.Dispatch(PL::Frame{1, static_cast<uint8_t>(PL::OpCode::GetAllStudents), {}});
+    auto selected = dispatcher.Dispatch(PL::Frame{2, static_cast<uint8_t>(PL::OpCode::SelectJournal), select.Release()});
+    auto after = dispatcher.Dispatch(PL::Frame{3, static_cast<uint8_t>(PL::OpCode::GetAllStudents), {}});
+
+    EXPECT_EQ(selected.status, PL::Status::Ok);
+    EXPECT_EQ(PL::BinaryReader(before.payload).ReadStudents().size(), 1);
+    EXPECT_TRUE(PL::BinaryReader(after.payload).ReadStudents().empty());
+}
+
+TEST_F(JournalSetTest, Dispatch_Backup_OnlyWritesInsideBackupDirectory) {
+    AddJournal("math")->AddStudent("John", "Smith", "MA-1");
+    std::filesystem::path directory = std::filesystem::temp_directory_path() /
+        ("gradejournal_backups_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()));
+    auto request = [](const std::string& name) {
+        PL::BinaryWriter writer;
+        writer.WriteString(name);
+        return PL::Frame{1, static_cast<uint8_t>(PL::OpCode::Backup), writer.Release()};
+    };
+    {
+        PL::RequestDispatcher dispatcher(journals);
+        EXPECT_EQ(dispatcher.Dispatch(request("nightly.json")).status, PL::Status::BadRequest);
+
+        dispatcher.SetBackupDirectory(directory.string());
+        EXPECT_EQ(dispatcher.Dispatch(request("../escaped.json")).status, PL::Status::Invalid);
+        EXPECT_EQ(dispatcher.Dispatch(request("daily/../../escaped.json")).status, PL::Status::Invalid);
+        EXPECT_EQ(dispatcher.Dispatch(request((directory / "absolute.json").string())).status, PL::Status::Invalid);
+        EXPECT_EQ(dispatcher.Dispatch(request("daily/nightly.json")).status, PL::Status::Ok);
+    }
+    EXPECT_TRUE(std::filesystem::exists(directory / "daily" / "nightly.json"));
+    EXPECT_FALSE(std::filesystem::exists(directory.parent_path() / "escaped.json"));
+    EXPECT_FALSE(std::filesystem::exists(directory / "absolute.json"));
+    std::filesystem::remove_all(directory);
+}
+
+TEST_F(JournalSetTest, Backup_CapturesSnapshotPointWhileWritesContinue) {
+    auto math = AddJournal("math");
+    journals->Get("math")->groups->AddGroup("MA-1", "Mathematics", 1);
+    math->AddStudent("John", "Smith", "MA-1");
+    math->AddGradeToStudent(1, "Algebra", 90);
+    AddJournal("physics")->AddStudent("Jane", "Roe", "PH-1");
+    std::string path = (std::filesystem::temp_directory_path() /
+        ("gradejournal_backup_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()) + ".json")).string();
+
+    BLL::OnlineBackup backup;
+    auto pending = backup.Start(*journals, path);
+    math->AddStudent("Bob", "Late", "MA-1");
+    BLL::BackupResult result = pending.get();
+
+    EXPECT_EQ(result.journals, 2);
+    EXPECT_EQ(result.students, 2);
+    EXPECT_EQ(result.groups, 2);
+    auto restored = BLL::OnlineBackup::Read(path);
+    ASSERT_EQ(restored.size(), 2);
+    EXPECT_EQ(restored[0].name, "math");
+    ASSERT_EQ(restored[0].students.size(), 1);
+    EXPECT_EQ(restored[0].students[0].GetGradeCount(), 1);
+    EXPECT_EQ(restored[0].groups[0].GetSpecialization(), "Mathematics");
+    ASSERT_EQ(restored[1].groups.size(), 1);
+    EXPECT_EQ(restored[1].groups[0].GetName(), "PH-1");
+    EXPECT_EQ(restored[1].students[0].GetGroupId(), restored[1].groups[0].GetId());
+    EXPECT_FALSE(std::filesystem::exists(path + ".tmp"));
+    std::filesystem::remove(path);
+}
+
+class WALRecoveryTest : public ::testing::Test {
+protected:
+    std::filesystem::path dataPath;
+
+    void SetUp() override {
+        dataPath = std::filesystem::temp_directory_path() /
+                   ("gradejournal_wal_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()) + ".json");
+        TearDown();
+    }
+
+    void TearDown() override {
+        for (std::string suffix : {"", ".wal", ".tmp", ".idx", ".bloom", ".delta-1", ".delta-2", ".delta-3",
+                                   ".groups", ".groups.wal", ".groups.idx", ".groups.bloom"}) {
+            std::filesystem::remove(dataPath.string() + suffix);
+        }
+        std::filesystem::remove_all(dataPath.string() + ".archive");
+    }
+};
+
+TEST_F(WALRecoveryTest, TornTail_IsDiscardedAndNextAppendSurvives) {
+    {
+        DAL::WALJsonStorage<BLL::Student> storage(dataPath.string());
+        storage.Insert(BLL::Student(1, "John", "Doe", 1));
+    }
+    {
+        std::ofstream wal(dataPath.string() + ".wal", std::ios::app);
+        wal << "{\"type\":0,\"id\":2,\"timest";
+    }
+
+    DAL::WALJsonStorage<BLL::Student> recovered(dataPath.string());
+    EXPECT_EQ(recovered.LoadAll().size(), 1);
+    recovered.Insert(BLL::Student(3, "Jane", "Roe", 1));
+
+    DAL::WALJsonStorage<BLL::Student> reopened(dataPath.string());
+    EXPECT_TRUE(reopened.Exists(1));
+    EXPECT_TRUE(reopened.Exists(3));
+    EXPECT_EQ(reopened.GetCount(), 2);
+}
+
+TEST_F(WALRecoveryTest, Compact_ReplacesDataFileAndClearsWal) {
+    DAL::WALJsonStorage<BLL::Student> storage(dataPath.string(), 2);
+    storage.Insert(BLL::Student(1, "John", "Doe", 1));
+    storage.Insert(BLL::Student(2, "Jane", "Roe", 1));
+
+    EXPECT_FALSE(std::filesystem::exists(dataPath.string() + ".tmp"));
+    EXPECT_EQ(std::filesystem::file_size(dataPath.string() + ".wal"), 0);
+    EXPECT_EQ(DAL::WALJsonStorage<BLL::Student>(dataPath.string()).LoadAll().size(), 2);
+}
+
+TEST_F(WALRecoveryTest, ApplyBatch_WritesOneLineAndReplaysIt) {
+    {
+        DAL::WALJsonStorage<BLL::Student> storage(dataPath.string());
+        storage.Insert(BLL::Student(1, "John", "Doe", 1));
+        storage.Insert(BLL::Student(2, "Jane", "Roe", 1));
+
+        DAL::ChangeSet<BLL::Student> changes;
+        changes.upserts.push_back(BLL::Student(1, "John", "Doe", 2));
+        changes.upserts.push_back(BLL::Student(3, "Bob", "Smith", 2));
+        changes.removals.push_back(2);
+        storage.ApplyBatch(changes);
+    }
+
+    std::ifstream wal(dataPath.string() + ".wal");
+    size_t lines = 0;
+    for (std::string line; std::getline(wal, line);) ++lines;
+    EXPECT_EQ(lines, 3);
+
+    DAL::WALJsonStorage<BLL::Student> reopened(dataPath.string());
+    EXPECT_EQ(reopened.GetCount(), 0);
+    EXPECT_EQ(reopened.LoadById(1).GetGroupId(), 2);
+    EXPECT_TRUE(reopened.Exists(3));
+    EXPECT_FALSE(reopened.Exists(2));
+}
+
+TEST_F(WALRecoveryTest, Archive_RestoresToPastLsnWithinRetention) {
+    {
+        DAL::WALJsonStorage<BLL::Student> storage(dataPath.string(), 3);
+        storage.EnableArchive(2, 1);
+        std::vector<BLL::Student> items;
+        for (int id = 1; id <= 10; ++id) {
+            items.push_back(BLL::Student(id, "First", "Last" + std::to_string(id), 1));
+            storage.Save(items);
+        }
+        items.erase(items.begin());
+        storage.Save(items);
+        EXPECT_EQ(storage.GetLastLsn(), 11);
+    }
+
+    // Compactions at LSN 3, 6 and 9; only the two newest bases are kept,
+    // together with the segment after the older of them.
+    std::string archive = dataPath.string() + ".archive";
+    auto bases = DAL::WALArchive::ListBases(archive);
+    ASSERT_EQ(bases.size(), 2);
+    EXPECT_EQ(bases[0].lsn, 6);
+    EXPECT_EQ(bases[1].lsn, 9);
+    ASSERT_EQ(DAL::WALArchive::ListSegments(archive).size(), 1);
+
+    std::map<int, BLL::Student> state;
+    DAL::RestoreTarget target;
+    target.lsn = 7;
+    auto report = DAL::WALRestore<BLL::Student>::Restore(dataPath.string(), target, state, 2);
+    EXPECT_EQ(report.baseLsn, 6);
+    EXPECT_EQ(report.lastLsn, 7);
+    EXPECT_EQ(state.size(), 7);
+
+    report = DAL::WALRestore<BLL::Student>::Restore(dataPath.string(), DAL::RestoreTarget{}, state);
+    EXPECT_EQ(report.lastLsn, 11);
+    EXPECT_EQ(state.size(), 9);
+    EXPECT_EQ(state.count(1), 0);
+
+    target.lsn = 3;
+    EXPECT_THROW(DAL::WALRestore<BLL::Student>::Restore(dataPath.string(), target, state), DAL::DataAccessException);
+
+    DAL::WALJsonStorage<BLL::Student> reopened(dataPath.string(), 3);
+    reopened.EnableArchive(2, 1);
+    EXPECT_EQ(reopened.GetLastLsn(), 11);
+    EXPECT_EQ(reopened.GetCount(), 9);
+}
+
+TEST_F(WALRecoveryTest, DeltaCheckpoints_WriteChangesOnlyAndMergeInBackground) {
+    DAL::WALJsonStorage<BLL::Student> storage(dataPath.string(), 1000);
+    std::vector<BLL::Student> items;
+    for (int id = 1; id <= 200; ++id) {
+        items.push_back(BLL::Student(id, "First", "Last" + std::to_string(id), 1));
+    }
+    storage.Save(items);
+    storage.EnableDeltaCheckpoints(2);
+
+    storage.Update(BLL::Student(5, "Changed", "Last5", 2));
+    storage.ForceCheckpoint();
+    std::string delta = dataPath.string() + ".delta-1";
+    ASSERT_TRUE(std::filesystem::exists(delta));
+    EXPECT_LT(std::filesystem::file_size(delta) * 50, std::filesystem::file_size(dataPath));
+    EXPECT_EQ(std::filesystem::file_size(dataPath.string() + ".wal"), 0);
+    {
+        DAL::WALJsonStorage<BLL::Student> reopened(dataPath.string(), 1000);
+        EXPECT_EQ(reopened.LoadById(5).GetFirstName(), "Changed");
+        EXPECT_EQ(reopened.GetCount(), 200);
+    }
+
+    storage.Delete(7);
+    storage.ForceCheckpoint();
+    storage.WaitForMerge();
+    EXPECT_EQ(storage.GetDeltaCount(), 0);
+    EXPECT_FALSE(std::filesystem::exists(delta));
+    EXPECT_FALSE(std::filesystem::exists(dataPath.string() + ".delta-2"));
+
+    DAL::WALJsonStorage<BLL::Student> merged(dataPath.string(), 1000);
+    EXPECT_EQ(merged.LoadById(5).GetGroupId(), 2);
+    EXPECT_FALSE(merged.Exists(7));
+    EXPECT_EQ(merged.LoadAll().size(), 199);
+}
+
+TEST_F(WALRecoveryTest, GroupService_KeepsIdsAcrossRenameAndReopen) {
+    std::string groupsPath = dataPath.string() + ".groups";
+    auto open = [&]() {
+        auto groups = std::make_shared<BLL::GroupService>(
+            DAL::StorageFactory<BLL::Group>::Create(DAL::StorageType::WAL, groupsPath));
+        return std::make_shared<BLL::StudentService>(
+            DAL::StorageFactory<BLL::Student>::Create(DAL::StorageType::WAL, dataPath.string()), groups);
+    };
+    int groupId = 0;
+    {
+        auto students = open();
+        students->AddStudent("John", "Doe", "G-1");
+        students->AddStudent("Jane", "Roe", "G-2");
+        groupId = students->Groups()->FindId("G-1");
+        students->Groups()->RenameGroup("G-1", "G-3");
+    }
+
+    auto reopened = open();
+    EXPECT_EQ(reopened->Groups()->FindId("G-3"), groupId);
+    EXPECT_EQ(reopened->Groups()->FindId("G-1"), -1);
+    ASSERT_EQ(reopened->FindByGroup("G-3").size(), 1);
+    EXPECT_EQ(reopened->FindByGroup("G-3")[0].GetFirstName(), "John");
+    EXPECT_EQ(reopened->AddStudent("Bob", "Smith", "G-4").GetGroupId(), 3);
+}
+
+TEST_F(WALRecoveryTest, DeltaCheckpoints_ServiceMutationsWriteDeltas) {
+    DAL::StorageOptions options;
+    options.compactAfter = 3;
+    options.deltaCheckpoints = 4;
+    {
+        BLL::StudentService service(DAL::StorageFactory<BLL::Student>::Create(options, dataPath.string()));
+        auto student = service.AddStudent("John", "Doe", "G-1");
+        service.AddStudent("Jane", "Roe", "G-1");
+        service.AddGradeToStudent(student.GetId(), "Math", 90);
+
+        EXPECT_TRUE(std::filesystem::exists(dataPath.string() + ".delta-1"));
+        EXPECT_FALSE(std::filesystem::exists(dataPath));
+
+        service.RemoveStudent(student.GetId());
+    }
+
+    BLL::StudentService reopened(DAL::StorageFactory<BLL::Student>::Create(options, dataPath.string()));
+    ASSERT_EQ(reopened.Count(), 1);
+    EXPECT_EQ(reopened.GetAll()[0].GetFirstName(), "Jane");
+}
+
+TEST_F(WALRecoveryTest, IdIndex_AnswersPointLookupsWithoutLoading) {
+    {
+        DAL::WALJsonStorage<BLL::Student> storage(dataPath.string(), 1000);
+        std::vector<BLL::Student> items;
+        for (int id = 1; id <= 500; ++id) {
+            items.push_back(BLL::Student(id, "First", "Last" + std::to_string(id), 1));
+        }
+        storage.Save(items);
+        storage.Update(BLL::Student(42, "Changed", "Last42", 2));
+        storage.Delete(43);
+    }
+
+    DAL::WALJsonStorage<BLL::Student> reader(dataPath.string(), 1000);
+    EXPECT_EQ(reader.LoadById(250).GetLastName(), "Last250");
+    EXPECT_EQ(reader.LoadById(42).GetGroupId(), 2);
+    EXPECT_THROW(reader.LoadById(43), std::runtime_error);
+    EXPECT_THROW(reader.LoadById(501), std::runtime_error);
+    EXPECT_EQ(reader.GetCount(), 0);
+
+    // A data file rewritten without its index falls back to a full load.
+    {
+        std::ofstream data(dataPath, std::ios::app);
+        data << "\n";
+    }
+    DAL::WALJsonStorage<BLL::Student> fallback(dataPath.string(), 1000);
+    EXPECT_EQ(fallback.LoadById(250).GetLastName(), "Last250");
+    EXPECT_EQ(fallback.GetCount(), 499);
+}
+
+TEST_F(WALRecoveryTest, BloomFilters_RejectAbsentIdsAndKeysWithoutLoading) {
+    DAL::WALJsonStorage<BLL::Student> writer(dataPath.string(), 1000);
+    std::vector<BLL::Student> items;
+    for (int id = 1; id <= 1000; ++id) {
+        items.push_back(BLL::Student(id, "First", "Last" + std::to_string(id), 1));
+    }
+    writer.Save(items);
+    writer.Insert(BLL::Student(5000, "Late", "Arrival", 2));
+
+    DAL::WALJsonStorage<BLL::Student> reader(dataPath.string(), 1000);
+    int found = 0;
+    for (int id = 1001; id <= 3000; ++id) {
+        found += reader.Exists(id) ? 1 : 0;
+    }
+    EXPECT_EQ(found, 0);
+    EXPECT_TRUE(reader.Exists(500));
+    EXPECT_TRUE(reader.Exists(5000));
+    EXPECT_EQ(reader.GetCount(), 0);
+
+    const auto& ids = reader.GetIdFilterStats();
+    EXPECT_EQ(ids.checks, 2002);
+    EXPECT_EQ(ids.negatives + ids.falsePositives, 2000);
+    EXPECT_LT(ids.FalsePositiveRate(), 0.05);
+
+    EXPECT_FALSE(reader.ContainsKey(BLL::Student::DuplicateKey("First", "Last10", 2)));
+    EXPECT_EQ(reader.GetCount(), 0);
+    EXPECT_TRUE(reader.ContainsKey(BLL::Student::DuplicateKey("Late", "Arrival", 2)));
+    EXPECT_EQ(reader.GetKeyFilterStats().negatives, 1);
+}
+
+TEST_F(WALRecoveryTest, StudentService_DuplicateCheckUsesTheStorageKeyIndex) {
+    auto wal = std::make_shared<DAL::WALJsonStorage<BLL::Student>>(dataPath.string(), 1000);
+    auto storage = std::make_shared<DAL::UniversalStorageAdapter<BLL::Student>>(DAL::StorageType::WAL, wal);
+    BLL::StudentService service(storage);
+    auto ann = service.AddStudent("Ann", "Lee", "K-1");
+    service.AddStudent("Bob", "Ray", "K-1");
+    int group = service.Groups()->FindId("K-1");
+
+    EXPECT_THROW(service.AddStudent("Ann", "Lee", "K-1"), BLL::DuplicateEntityException);
+    EXPECT_EQ(storage->ContainsKey(BLL::Student::DuplicateKey("Bob", "Ray", group)), std::optional<bool>(true));
+
+    // The key index follows renames and removals.
+    service.UpdateStudent(ann.GetId(), "Anna", "", "");
+    EXPECT_FALSE(wal->ContainsKey(BLL::Student::DuplicateKey("Ann", "Lee", group)));
+    EXPECT_TRUE(wal->ContainsKey(BLL::Student::DuplicateKey("Anna", "Lee", group)));
+    service.AddStudent("Ann", "Lee", "K-1");
+    service.RemoveStudent(ann.GetId());
+    EXPECT_FALSE(wal->ContainsKey(BLL::Student::DuplicateKey("Anna", "Lee", group)));
+    service.AddStudent("Anna", "Lee", "K-1");
+    EXPECT_THROW(service.AddStudent("Anna", "Lee", "K-1"), BLL::DuplicateEntityException);
+}
+
+TEST_F(WALRecoveryTest, CacheBudget_EvictsColdRecordsAndReloadsThem) {
+    std::vector<BLL::Student> items;
+    for (int id = 1; id <= 2000; ++id) {
+        items.push_back(BLL::Student(id, "First", "Last" + std::to_string(id), 1));
+    }
+    DAL::WALJsonStorage<BLL::Student>(dataPath.string(), 1000).Save(items);
+
+    const size_t budget = 32 * 1024;
+    DAL::WALJsonStorage<BLL::Student> storage(dataPath.string(), 1000);
+    storage.EnableCacheBudget(budget);
+    EXPECT_EQ(storage.LoadRange(1990, 20).size(), 10);
+    EXPECT_EQ(storage.GetCount(), 2000);
+    EXPECT_EQ(storage.GetCacheStats().residentRecords, 0);
+
+    EXPECT_EQ(storage.LoadById(5).GetLastName(), "Last5");
+    EXPECT_EQ(storage.LoadById(5).GetLastName(), "Last5");
+    EXPECT_EQ(storage.GetCacheStats().misses, 1);
+    EXPECT_EQ(storage.GetCacheStats().hits, 1);
+
+    for (int id = 1; id <= 400; ++id) {
+        storage.Update(BLL::Student(id, "Changed", "Last" + std::to_string(id), 2));
+    }
+    storage.Delete(1500);
+    EXPECT_GT(storage.GetCacheStats().residentBytes, budget);
+    storage.ForceCompact();
+    auto stats = storage.GetCacheStats();
+    EXPECT_LE(stats.residentBytes, budget);
+    EXPECT_GT(stats.evictions, 0);
+    EXPECT_EQ(stats.residentRecords + stats.evictedRecords, 1999);
+    EXPECT_EQ(storage.LoadById(300).GetFirstName(), "Changed");
+
+    auto budgeted = storage.LoadAll();
+    DAL::WALJsonStorage<BLL::Student> unbudgeted(dataPath.string(), 1000);
+    auto all = unbudgeted.LoadAll();
+    ASSERT_EQ(all.size(), 1999);
+    EXPECT_EQ(budgeted, all);
+    EXPECT_EQ(all[299].GetGroupId(), 2);
+    EXPECT_EQ(all[1000].GetFirstName(), "First");
+}
+
+TEST_F(WALRecoveryTest, CacheBudget_ThroughStudentService_BoundsOnlyTheStorage) {
+    std::vector<BLL::Student> items;
+    for (int id = 1; id <= 2000; ++id) {
+        items.push_back(BLL::Student(id, "First", "Last" + std::to_string(id), 1));
+    }
+    DAL::WALJsonStorage<BLL::Student>(dataPath.string(), 1000).Save(items);
+
+    const size_t budget = 32 * 1024;
+    auto wal = std::make_shared<DAL::WALJsonStorage<BLL::Student>>(dataPath.string(), 100);
+    wal->EnableCacheBudget(budget);
+    auto groupStorage = std::make_shared<MockGroupStorage>();
+    groupStorage->Save({BLL::Group(1, "G-1", "", 1)});
+    BLL::StudentService service(std::make_shared<DAL::UniversalStorageAdapter<BLL::Student>>(DAL::StorageType::WAL, wal),
+                                std::make_shared<BLL::GroupService>(groupStorage));
+    // The service still holds every record; only the storage is bounded.
+    EXPECT_EQ(service.Count(), 2000);
+    EXPECT_EQ(wal->GetCacheStats().residentRecords, 0);
+
+    for (int i = 0; i < 300; ++i) {
+        int id = service.View()[static_cast<size_t>(i)].GetId();
+        service.UpdateStudent(id, "Changed", "", "G-2");
+        service.AddGradeToStudent(id, "Math", 80);
+    }
+    auto stats = wal->GetCacheStats();
+    EXPECT_LE(stats.residentBytes, budget);
+    EXPECT_GT(stats.evictions, 0);
+    EXPECT_EQ(stats.residentRecords + stats.evictedRecords, 2000);
+
+    BLL::StudentService reopened(DAL::StorageFactory<BLL::Student>::Create(DAL::StorageType::WAL, dataPath.string()),
+                                 std::make_shared<BLL::GroupService>(groupStorage));
+    ASSERT_EQ(reopened.Count(), 2000);
+    EXPECT_EQ(reopened.FindByGroup("G-2").size(), 300);
+    EXPECT_EQ(reopened.View()[299].GetGradeCount(), 1);
+}
+
+#ifndef _WIN32
+TEST_F(WALRecoveryTest, CrashPoint_KillBeforeDataRename_RecoversFromWal) {
+    DAL::WALJsonStorage<BLL::Student> storage(dataPath.string(), 1000);
+    storage.Save({BLL::Student(1, "Ann", "Lee", 1)});
+    storage.Insert(BLL::Student(2, "Bob", "Ray", 1));
+
+    EXPECT_EXIT({
+        setenv("GRADEJOURNAL_CRASH_AT", "data:1", 1);
+        storage.ForceCompact();
+    }, ::testing::ExitedWithCode(DAL::CrashPointExitCode), "");
+
+    EXPECT_TRUE(std::filesystem::exists(dataPath.string() + ".tmp"));
+    DAL::WALJsonStorage<BLL::Student> recovered(dataPath.string(), 1000);
+    auto students = recovered.LoadAll();
+    ASSERT_EQ(students.size(), 2);
+    EXPECT_EQ(students[1].GetLastName(), "Ray");
+}
+
+TEST_F(BinaryProtocolTest, SocketServer_PipelinedRequests_AnsweredInOrder) {
+    std::string path = "/tmp/gradejournal_test_" + std::to_string(getpid()) + ".sock";
+    PL::UnixSocketServer server(path, studentService, groupService);
+    std::thread serverThread([&server]() { server.Run(); });
+
+    PL::UnixSocketClient client;
+    for (int attempt = 0; attempt < 100; ++attempt) {
+        try {
+            client.Connect(path);
+            break;
+        } catch (const PL::SocketException&) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+
+    auto added = client.AddStudent("John", "Doe", "CS-101");
+    EXPECT_EQ(added.groupName, "CS-101");
+    for (int i = 0; i < 50; ++i) {
+        PL::BinaryWriter request;
+        request.WriteI32(added.student.GetId());
+        client.Send(PL::OpCode::GetStudent, request.Data());
+    }
+    client.Flush();
+    uint32_t previousId = 0;
+    for (int i = 0; i < 50; ++i) {
+        auto response = client.Receive();
+        EXPECT_EQ(response.status, PL::Status::Ok);
+        EXPECT_GT(response.requestId, previousId);
+        previousId = response.requestId;
+    }
+    EXPECT_THROW(client.GetStudent(999), PL::RemoteException);
+
+    client.Close();
+    server.Stop();
+    serverThread.join();
+}
+
+TEST_F(BinaryProtocolTest, SocketServer_ClientNotReading_PausesReadsAndAnswersEverything) {
+    for (int i = 0; i < 100; ++i) {
+        studentService->AddStudent("First" + std::to_string(i), "Last" + std::to_string(i), "CS-101");
+    }
+    std::string path = "/tmp/gradejournal_backlog_" + std::to_string(getpid()) + ".sock";
+    PL::UnixSocketServer server(path, studentService, groupService);
+    std::thread serverThread([&server]() { server.Run(); });
+
+    PL::UnixSocketClient client;
+    for (int attempt = 0; attempt < 100; ++attempt) {
+        try {
+            client.Connect(path);
+            break;
+        } catch (const PL::SocketException&) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+
+    auto& paused = Diagnostics::MetricsRegistry::Instance().GetCounter("pl.server.reads_paused");
+    uint64_t pausedBefore = paused.Value();
+    const int requests = 2000;
+    for (int i = 0; i < requests; ++i) {
+        client.Send(PL::OpCode::GetAllStudents, {});
+    }
+    // The server stops reading once its replies back up, so the flush only
+    // completes while responses are being received.
+    std::thread sender([&client]() { client.Flush(); });
+    for (int wait = 0; wait < 200 && paused.Value() == pausedBefore; ++wait) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_GT(paused.Value(), pausedBefore);
+
+    uint32_t previousId = 0;
+    for (int i = 0; i < requests; ++i) {
+        auto response = client.Receive();
+        ASSERT_EQ(response.status, PL::Status::Ok);
+        ASSERT_GT(response.requestId, previousId);
+        previousId = response.requestId;
+    }
+    sender.join();
+
+    client.Close();
+    server.Stop();
+    serverThread.join();
+}
+#endif
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,219 @@
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Compares two Google Benchmark JSON reports (--benchmark_out). With
+// repetitions, a benchmark only counts as regressed when its median slowed
+// down by more than the tolerance AND a one-sided Mann-Whitney U test says
+// the slowdown is unlikely to be noise. Exits with 1 on any regression.
+
+using json = nlohmann::json;
+
+namespace {
+
+struct Options {
+    std::string baselinePath;
+    std::string currentPath;
+    double tolerance = 0.10;
+    double alpha = 0.05;
+    std::string metric = "real_time";
+    std::string track = ".*";
+};
+
+void PrintUsage() {
+    std::cout << "Usage: BenchCompare --baseline <file.json> --current <file.json>\n"
+                 "                    [--tolerance FRACTION] [--alpha P] [--metric real_time|cpu_time]\n"
+                 "                    [--track REGEX]\n";
+}
+
+Options ParseOptions(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Missing value for " + arg);
+            }
+            return argv[++i];
+        };
+        if (arg == "--baseline") options.baselinePath = next();
+        else if (arg == "--current") options.currentPath = next();
+        else if (arg == "--tolerance") options.tolerance = std::stod(next());
+        else if (arg == "--alpha") options.alpha = std::stod(next());
+        else if (arg == "--metric") options.metric = next();
+        else if (arg == "--track") options.track = next();
+        else throw std::invalid_argument("Unknown option: " + arg);
+    }
+    if (options.baselinePath.empty() || options.currentPath.empty()) {
+        throw std::invalid_argument("--baseline and --current are required");
+    }
+    if (options.metric != "real_time" && options.metric != "cpu_time") {
+        throw std::invalid_argument("--metric must be real_time or cpu_time");
+    }
+    if (options.tolerance < 0 || options.alpha <= 0 || options.alpha >= 1) {
+        throw std::invalid_argument("--tolerance must be >= 0 and --alpha between 0 and 1");
+    }
+    return options;
+}
+
+double ToNanoseconds(double value, const std::string& unit) {
+    if (unit == "us") return value * 1e3;
+    if (unit == "ms") return value * 1e6;
+    if (unit == "s") return value * 1e9;
+    return value;
+}
+
+// Samples per benchmark, in nanoseconds: one per repetition.
+std::map<std::string, std::vector<double>> LoadSamples(const std::string& path, const std::string& metric) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    json report;
+    try {
+        file >> report;
+    } catch (const json::exception& e) {
+        throw std::runtime_error("Invalid benchmark JSON in " + path + ": " + e.what());
+    }
+
+    std::map<std::string, std::vector<double>> samples;
+    for (const auto& entry : report.value("benchmarks", json::array())) {
+        if (entry.value("run_type", "iteration") != "iteration" || entry.contains("error_occurred")) {
+            continue;
+        }
+        std::string name = entry.value("run_name", entry.value("name", ""));
+        samples[name].push_back(ToNanoseconds(entry.value(metric, 0.0), entry.value("time_unit", "ns")));
+    }
+    return samples;
+}
+
+double Median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    size_t middle = values.size() / 2;
+    return values.size() % 2 ? values[middle] : (values[middle - 1] + values[middle]) / 2.0;
+}
+
+// One-sided p-value for "current samples are larger than baseline samples",
+// normal approximation with tie and continuity correction.
+double MannWhitneyGreater(const std::vector<double>& baseline, const std::vector<double>& current) {
+    struct Sample { double value; bool isCurrent; };
+    std::vector<Sample> all;
+    for (double v : baseline) all.push_back({v, false});
+    for (double v : current) all.push_back({v, true});
+    std::sort(all.begin(), all.end(), [](const Sample& a, const Sample& b) { return a.value < b.value; });
+
+    double n1 = static_cast<double>(current.size());
+    double n2 = static_cast<double>(baseline.size());
+    double n = n1 + n2;
+    double rankSum = 0;
+    double tieTerm = 0;
+    for (size_t i = 0; i < all.size();) {
+        size_t j = i;
+        while (j < all.size() && all[j].value == all[i].value) ++j;
+        double averageRank = (static_cast<double>(i + 1) + static_cast<double>(j)) / 2.0;
+        for (size_t k = i; k < j; ++k) {
+            if (all[k].isCurrent) rankSum += averageRank;
+        }
+        double ties = static_cast<double>(j - i);
+        tieTerm += ties * ties * ties - ties;
+        i = j;
+    }
+
+    double u = rankSum - n1 * (n1 + 1) / 2.0;
+    double mean = n1 * n2 / 2.0;
+    double variance = n1 * n2 / 12.0 * ((n + 1) - tieTerm / (n * (n - 1)));
+    if (variance <= 0) {
+        return u > mean ? 0.0 : 1.0;
+    }
+    double z = (u - mean - 0.5) / std::sqrt(variance);
+    return 0.5 * std::erfc(z / std::sqrt(2.0));
+}
+
+std::string FormatTime(double ns) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1);
+    if (ns >= 1e9) out << std::setprecision(2) << ns / 1e9 << " s";
+    else if (ns >= 1e6) out << std::setprecision(2) << ns / 1e6 << " ms";
+    else if (ns >= 1e3) out << std::setprecision(1) << ns / 1e3 << " us";
+    else out << ns << " ns";
+    return out.str();
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        Options options = ParseOptions(argc, argv);
+        auto baseline = LoadSamples(options.baselinePath, options.metric);
+        auto current = LoadSamples(options.currentPath, options.metric);
+        std::regex tracked(options.track);
+
+        int regressions = 0, improvements = 0, compared = 0, unverified = 0;
+        std::cout << std::left << std::setw(58) << "Benchmark" << std::right
+                  << std::setw(12) << "Baseline" << std::setw(12) << "Current"
+                  << std::setw(9) << "Change" << std::setw(9) << "p" << "  Verdict\n";
+
+        for (const auto& [name, samples] : current) {
+            if (!std::regex_search(name, tracked)) continue;
+            auto base = baseline.find(name);
+            if (base == baseline.end()) {
+                std::cout << std::left << std::setw(58) << name << std::right << "  (new, no baseline)\n";
+                continue;
+            }
+            ++compared;
+            double before = Median(base->second);
+            double after = Median(samples);
+            double change = before > 0 ? (after - before) / before : 0.0;
+            bool enoughSamples = base->second.size() >= 3 && samples.size() >= 3;
+            double slower = enoughSamples ? MannWhitneyGreater(base->second, samples) : 0.0;
+            double faster = enoughSamples ? MannWhitneyGreater(samples, base->second) : 0.0;
+
+            std::string verdict = "ok";
+            if (change > options.tolerance && slower < options.alpha) {
+                verdict = "REGRESSION";
+                ++regressions;
+            } else if (change < -options.tolerance && faster < options.alpha) {
+                verdict = "faster";
+                ++improvements;
+            } else if (std::abs(change) > options.tolerance) {
+                verdict = "noise";
+            }
+            if (!enoughSamples) ++unverified;
+
+            std::cout << std::left << std::setw(58) << name << std::right
+                      << std::setw(12) << FormatTime(before) << std::setw(12) << FormatTime(after)
+                      << std::setw(8) << std::fixed << std::setprecision(1) << change * 100.0 << "%"
+                      << std::setw(9) << std::setprecision(3);
+            if (enoughSamples) std::cout << (change >= 0 ? slower : faster);
+            else std::cout << "-";
+            std::cout << "  " << verdict << "\n";
+        }
+        for (const auto& [name, samples] : baseline) {
+            if (std::regex_search(name, tracked) && current.count(name) == 0) {
+                std::cout << std::left << std::setw(58) << name << std::right << "  (missing from current run)\n";
+            }
+        }
+
+        std::cout << "\nCompared " << compared << " benchmarks: " << regressions << " regressed, "
+                  << improvements << " faster (tolerance " << std::setprecision(1) << options.tolerance * 100.0
+                  << "%, alpha " << std::setprecision(3) << options.alpha << ")\n";
+        if (unverified > 0) {
+            std::cout << unverified << " benchmarks had fewer than 3 repetitions; "
+                         "only the tolerance was applied to them.\n";
+        }
+        return regressions == 0 ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        PrintUsage();
+        return 2;
+    }
+}
@@ -0,0 +1,470 @@
+#include "Models.h"
+#include "WALJsonStorage.h"
+#include <chrono>
+#include <csignal>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Forks a writer that mutates a WALJsonStorage and acknowledges every
+// completed call over a pipe, kills it, reopens the files and checks that
+// every acknowledged operation survived. The single operation in flight at
+// the time of the kill may or may not be present. Half the trials SIGKILL
+// the writer at a random moment; the rest make it exit at a kill point
+// between a checkpoint file's temporary write and its rename (see
+// DAL::CrashPoint), which random kills almost never hit. Every trial set
+// runs once per storage configuration.
+
+namespace {
+
+namespace fs = std::filesystem;
+using BLL::Student;
+
+struct Options {
+    int trials = 100;
+    int baseRecords = 2000;
+    int maxOps = 1500;
+    int compactAfter = 400;
+    uint64_t seed = 1;
+    std::string directory = (fs::temp_directory_path() / "gradejournal-crash").string();
+    std::vector<std::string> configs = {"default", "delta", "archive", "sidecar", "budget"};
+};
+
+void PrintUsage() {
+    std::cout << "Usage: CrashHarness [--trials N] [--base-records N] [--max-ops N]\n"
+                 "                    [--compact-after N] [--seed N] [--dir PATH]\n"
+                 "                    [--configs default,delta,archive,sidecar,budget]\n";
+}
+
+std::vector<std::string> SplitList(const std::string& text) {
+    std::vector<std::string> parts;
+    std::stringstream stream(text);
+    std::string part;
+    while (std::getline(stream, part, ',')) {
+        if (!part.empty()) parts.push_back(part);
+    }
+    return parts;
+}
+
+// Storage options per configuration. "sidecar" keeps the defaults but
+// checks point lookups through the id index and Bloom filters before the
+// full recovery load.
+void Configure(DAL::WALJsonStorage<Student>& storage, const std::string& config) {
+    if (config == "delta") storage.EnableDeltaCheckpoints(2);
+    else if (config == "archive") storage.EnableArchive(3, 2);
+    else if (config == "budget") storage.EnableCacheBudget(64 * 1024);
+}
+
+std::vector<std::string> KillPoints(const std::string& config) {
+    if (config == "delta") return {"delta", "data", "index", "filter"};
+    if (config == "archive") return {"data", "index", "filter", "checkpoint", "base"};
+    return {"data", "index", "filter", "checkpoint"};
+}
+
+Options ParseOptions(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Missing value for " + arg);
+            }
+            return argv[++i];
+        };
+        if (arg == "--trials") options.trials = std::stoi(next());
+        else if (arg == "--base-records") options.baseRecords = std::stoi(next());
+        else if (arg == "--max-ops") options.maxOps = std::stoi(next());
+        else if (arg == "--compact-after") options.compactAfter = std::stoi(next());
+        else if (arg == "--seed") options.seed = std::stoull(next());
+        else if (arg == "--dir") options.directory = next();
+        else if (arg == "--configs") options.configs = SplitList(next());
+        else throw std::invalid_argument("Unknown option: " + arg);
+    }
+    if (options.trials <= 0 || options.maxOps <= 0 || options.compactAfter <= 0 || options.baseRecords < 0) {
+        throw std::invalid_argument("Counts must be positive");
+    }
+    for (const auto& config : options.configs) {
+        if (config != "default" && config != "delta" && config != "archive" && config != "sidecar" && config != "budget") {
+            throw std::invalid_argument("Unknown configuration: " + config);
+        }
+    }
+    if (options.configs.empty()) {
+        throw std::invalid_argument("No configurations given");
+    }
+    return options;
+}
+
+enum class MutationType { Insert, Update, Delete };
+
+struct Mutation {
+    MutationType type;
+    Student student;
+};
+
+// Deterministic for a given seed, so the parent can replay exactly the
+// sequence the killed child executed. The stream tracks the expected state
+// itself: after Next() returns, State() includes that mutation.
+class MutationStream {
+private:
+    static constexpr const char* FirstNames[] = {"Olena", "Taras", "Iryna", "Andrii", "Sofiia", "Maksym"};
+    static constexpr const char* LastNames[] = {"Koval", "Shevchenko", "Bondar", "Melnyk", "Tkachenko"};
+    static constexpr const char* Subjects[] = {"Mathematics", "Physics", "Programming", "History", "Databases"};
+
+    std::mt19937_64 random;
+    std::map<int, Student> state;
+    std::vector<int> ids;
+    int nextId = 1;
+
+    template<size_t N>
+    const char* Pick(const char* const (&names)[N]) {
+        return names[random() % N];
+    }
+
+    Student MakeStudent() {
+        Student student(nextId++, Pick(FirstNames), Pick(LastNames), static_cast<int>(random() % 20) + 1);
+        for (int i = 0; i < 3; ++i) {
+            student.AddGrade(BLL::Grade(Pick(Subjects), static_cast<int>(random() % 101)));
+        }
+        return student;
+    }
+
+    size_t PickIndex() {
+        return static_cast<size_t>(random() % ids.size());
+    }
+
+public:
+    MutationStream(uint64_t seed, int baseRecords) : random(seed) {
+        for (int i = 0; i < baseRecords; ++i) {
+            Student student = MakeStudent();
+            ids.push_back(student.GetId());
+            state.emplace(student.GetId(), std::move(student));
+        }
+    }
+
+    Mutation Next() {
+        unsigned roll = static_cast<unsigned>(random() % 100);
+        if (ids.empty() || roll < 25) {
+            Student student = MakeStudent();
+            ids.push_back(student.GetId());
+            state[student.GetId()] = student;
+            return {MutationType::Insert, student};
+        }
+        size_t index = PickIndex();
+        if (roll < 85) {
+            Student& student = state[ids[index]];
+            student.AddGrade(BLL::Grade(Pick(Subjects), static_cast<int>(random() % 101)));
+            return {MutationType::Update, student};
+        }
+        Mutation mutation{MutationType::Delete, state[ids[index]]};
+        state.erase(ids[index]);
+        ids[index] = ids.back();
+        ids.pop_back();
+        return mutation;
+    }
+
+    std::vector<Student> State() const {
+        std::vector<Student> result;
+        result.reserve(state.size());
+        for (const auto& pair : state) result.push_back(pair.second);
+        return result;
+    }
+};
+
+json ToJson(const std::vector<Student>& students) {
+    json j = json::array();
+    for (const auto& student : students) j.push_back(student.ToJson());
+    return j;
+}
+
+[[noreturn]] void RunWriter(const Options& options, const std::string& config, uint64_t seed,
+                           const std::string& dataPath, int ackFd) {
+    try {
+        MutationStream stream(seed, options.baseRecords);
+        DAL::WALJsonStorage<Student> storage(dataPath, options.compactAfter);
+        Configure(storage, config);
+        const char ack = 1;
+        for (int op = 0; op < options.maxOps; ++op) {
+            Mutation mutation = stream.Next();
+            switch (mutation.type) {
+                case MutationType::Insert: storage.Insert(mutation.student); break;
+                case MutationType::Update: storage.Update(mutation.student); break;
+                case MutationType::Delete: storage.Delete(mutation.student.GetId()); break;
+            }
+            if (write(ackFd, &ack, 1) != 1) _exit(3);
+        }
+        // A background merge is still a window a kill can land in.
+        storage.WaitForMerge();
+        _exit(0);
+    } catch (...) {
+        _exit(2);
+    }
+}
+
+struct WalShape {
+    size_t lines = 0;
+    uintmax_t bytes = 0;
+    bool tornTail = false;
+};
+
+WalShape InspectWal(const std::string& walPath) {
+    WalShape shape;
+    std::ifstream file(walPath, std::ios::binary);
+    if (!file.is_open()) return shape;
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    shape.bytes = content.size();
+    shape.lines = static_cast<size_t>(std::count(content.begin(), content.end(), '\n'));
+    shape.tornTail = !content.empty() && content.back() != '\n';
+    return shape;
+}
+
+struct TrialResult {
+    int acknowledged = 0;
+    bool killed = false;
+    // The kill point the writer exited at; empty for a SIGKILL or when the
+    // point was not reached.
+    std::string killPoint;
+    bool duringCompaction = false;
+    bool inFlightApplied = false;
+    WalShape wal;
+    double recoveryMs = 0;
+    std::string failure;
+};
+
+// Point lookups through the sidecar id index and filters, before anything
+// loads the index; the in-flight record is skipped since either version of
+// it is acceptable.
+std::string CheckSidecarLookups(const Options& options, const std::string& dataPath,
+                                const std::vector<Student>& expected, int inFlightId) {
+    DAL::WALJsonStorage<Student> indexed(dataPath, options.compactAfter);
+    for (size_t i = 0; i < expected.size(); i += std::max<size_t>(1, expected.size() / 50)) {
+        const Student& student = expected[i];
+        if (student.GetId() == inFlightId) continue;
+        if (!indexed.Exists(student.GetId())) {
+            return "indexed lookup lost record " + std::to_string(student.GetId());
+        }
+        if (indexed.LoadById(student.GetId()).ToJson() != student.ToJson()) {
+            return "indexed lookup returned a stale record " + std::to_string(student.GetId());
+        }
+    }
+    int absent = expected.empty() ? 1 : expected.back().GetId() + 1000;
+    if (absent != inFlightId && indexed.Exists(absent)) {
+        return "indexed lookup found absent record " + std::to_string(absent);
+    }
+    for (size_t i = 0; i < expected.size(); i += std::max<size_t>(1, expected.size() / 10)) {
+        if (expected[i].GetId() != inFlightId && !indexed.ContainsKey(expected[i].DuplicateKey())) {
+            return "key lookup lost record " + std::to_string(expected[i].GetId());
+        }
+    }
+    return {};
+}
+
+TrialResult RunTrial(const Options& options, const std::string& config, int trial) {
+    uint64_t seed = options.seed * 1000003 + static_cast<uint64_t>(trial);
+    std::mt19937_64 chaos(seed ^ 0x9e3779b97f4a7c15ULL);
+
+    fs::path directory = fs::path(options.directory) / (config + "-" + std::to_string(trial));
+    fs::remove_all(directory);
+    fs::create_directories(directory);
+    std::string dataPath = (directory / "students.json").string();
+
+    {
+        MutationStream stream(seed, options.baseRecords);
+        DAL::WALJsonStorage<Student> storage(dataPath, options.compactAfter);
+        Configure(storage, config);
+        storage.Save(stream.State());
+    }
+
+    std::string crashAt;
+    if (chaos() % 2 == 0) {
+        std::vector<std::string> points = KillPoints(config);
+        crashAt = points[chaos() % points.size()] + ":" + std::to_string(chaos() % 2 + 1);
+    }
+
+    int pipeFds[2];
+    if (pipe(pipeFds) != 0) throw std::runtime_error("pipe failed");
+    pid_t child = fork();
+    if (child < 0) throw std::runtime_error("fork failed");
+    if (child == 0) {
+        close(pipeFds[0]);
+        if (!crashAt.empty()) {
+            setenv("GRADEJOURNAL_CRASH_AT", crashAt.c_str(), 1);
+        }
+        RunWriter(options, config, seed, dataPath, pipeFds[1]);
+    }
+    close(pipeFds[1]);
+
+    TrialResult result;
+    char buffer[4096];
+    if (crashAt.empty()) {
+        int killAfter = static_cast<int>(chaos() % static_cast<uint64_t>(options.maxOps));
+        while (result.acknowledged < killAfter) {
+            ssize_t received = read(pipeFds[0], buffer, sizeof(buffer));
+            if (received <= 0) break;
+            result.acknowledged += static_cast<int>(received);
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(chaos() % 2000));
+        result.killed = kill(child, SIGKILL) == 0;
+    }
+
+    int status = 0;
+    waitpid(child, &status, 0);
+    ssize_t received;
+    while ((received = read(pipeFds[0], buffer, sizeof(buffer))) > 0) {
+        result.acknowledged += static_cast<int>(received);
+    }
+    close(pipeFds[0]);
+    if (WIFEXITED(status) && WEXITSTATUS(status) == DAL::CrashPointExitCode && !crashAt.empty()) {
+        result.killed = true;
+        result.killPoint = crashAt.substr(0, crashAt.find(':'));
+    } else if (WIFEXITED(status) && WEXITSTATUS(status) != 0) {
+        result.failure = "writer failed with exit code " + std::to_string(WEXITSTATUS(status));
+        return result;
+    } else {
+        result.killed = result.killed && WIFSIGNALED(status);
+    }
+
+    result.duringCompaction = fs::exists(dataPath + ".tmp");
+    result.wal = InspectWal(dataPath + ".wal");
+
+    MutationStream replay(seed, options.baseRecords);
+    for (int i = 0; i < result.acknowledged; ++i) replay.Next();
+    std::vector<Student> acknowledgedState = replay.State();
+    json acknowledged = ToJson(acknowledgedState);
+    json withInFlight = acknowledged;
+    int inFlightId = 0;
+    if (result.acknowledged < options.maxOps) {
+        inFlightId = replay.Next().student.GetId();
+        withInFlight = ToJson(replay.State());
+    }
+
+    if (config == "sidecar") {
+        result.failure = CheckSidecarLookups(options, dataPath, acknowledgedState, inFlightId);
+        if (!result.failure.empty()) {
+            return result;
+        }
+    }
+
+    auto started = std::chrono::steady_clock::now();
+    DAL::WALJsonStorage<Student> recovered(dataPath, options.compactAfter);
+    Configure(recovered, config);
+    std::vector<Student> students = recovered.LoadAll();
+    result.recoveryMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+
+    json actual = ToJson(students);
+    if (actual == withInFlight && actual != acknowledged) {
+        result.inFlightApplied = true;
+    } else if (actual != acknowledged) {
+        result.failure = "recovered " + std::to_string(students.size()) +
+                         " records that match neither the acknowledged state nor the in-flight one";
+        return result;
+    }
+
+    // A torn tail must not swallow the first write after recovery.
+    Student probe(1000000000, "Probe", "Record", 1);
+    recovered.Insert(probe);
+    // The probe may start a delta merge; the files are only settled for
+    // another reader once it is done.
+    recovered.WaitForMerge();
+    DAL::WALJsonStorage<Student> reopened(dataPath, options.compactAfter);
+    Configure(reopened, config);
+    if (!reopened.Exists(probe.GetId())) {
+        result.failure = "write after recovery was lost";
+    }
+    return result;
+}
+
+void PrintRecoveryTable(const std::vector<TrialResult>& results, int compactAfter) {
+    size_t width = static_cast<size_t>(std::max(1, compactAfter / 8));
+    std::map<size_t, std::vector<double>> buckets;
+    double sumX = 0, sumY = 0, sumXY = 0, sumXX = 0;
+    for (const auto& result : results) {
+        if (!result.failure.empty()) continue;
+        buckets[result.wal.lines / width].push_back(result.recoveryMs);
+        double x = static_cast<double>(result.wal.lines);
+        sumX += x;
+        sumY += result.recoveryMs;
+        sumXY += x * result.recoveryMs;
+        sumXX += x * x;
+    }
+
+    std::cout << "\n" << std::setw(16) << "WAL lines" << std::setw(8) << "trials"
+              << std::setw(12) << "mean ms" << std::setw(12) << "max ms" << "\n";
+    for (const auto& [bucket, times] : buckets) {
+        double total = 0, worst = 0;
+        for (double t : times) {
+            total += t;
+            worst = std::max(worst, t);
+        }
+        std::string range = std::to_string(bucket * width) + "-" + std::to_string((bucket + 1) * width - 1);
+        std::cout << std::setw(16) << range << std::setw(8) << times.size()
+                  << std::setw(12) << total / times.size() << std::setw(12) << worst << "\n";
+    }
+
+    double n = 0;
+    for (const auto& [bucket, times] : buckets) n += static_cast<double>(times.size());
+    double denominator = n * sumXX - sumX * sumX;
+    if (n >= 2 && denominator > 0) {
+        double slope = (n * sumXY - sumX * sumY) / denominator;
+        double intercept = (sumY - slope * sumX) / n;
+        std::cout << "\nRecovery ~ " << intercept << " ms + " << slope * 1000.0 << " us per WAL line\n";
+    }
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        Options options = ParseOptions(argc, argv);
+        std::cout << std::fixed << std::setprecision(3);
+
+        int totalFailures = 0;
+        for (const auto& config : options.configs) {
+            std::vector<TrialResult> results;
+            std::map<std::string, int> pointKills;
+            int failures = 0, kills = 0, compactionKills = 0, tornTails = 0, inFlight = 0;
+            for (int trial = 0; trial < options.trials; ++trial) {
+                TrialResult result = RunTrial(options, config, trial);
+                kills += result.killed;
+                compactionKills += result.duringCompaction;
+                tornTails += result.wal.tornTail;
+                inFlight += result.inFlightApplied;
+                if (!result.killPoint.empty()) {
+                    ++pointKills[result.killPoint];
+                }
+                if (!result.failure.empty()) {
+                    ++failures;
+                    std::cout << "[" << config << "] Trial " << trial << " FAILED after " << result.acknowledged
+                              << " acknowledged ops" << (result.killPoint.empty() ? "" : " at " + result.killPoint)
+                              << ": " << result.failure << "\n";
+                }
+                results.push_back(std::move(result));
+            }
+            totalFailures += failures;
+
+            std::cout << "\nConfiguration:         " << config << "\n"
+                      << "Trials:                " << options.trials << "\n"
+                      << "Killed mid-run:        " << kills << "\n"
+                      << "Killed in compaction:  " << compactionKills << "\n";
+            for (const auto& [point, count] : pointKills) {
+                std::cout << "Killed at " << std::left << std::setw(13) << (point + ":") << std::right << count << "\n";
+            }
+            std::cout << "Torn WAL tails:        " << tornTails << "\n"
+                      << "In-flight op survived: " << inFlight << "\n"
+                      << "Failures:              " << failures << "\n";
+            PrintRecoveryTable(results, options.compactAfter);
+        }
+        fs::remove_all(options.directory);
+        return totalFailures == 0 ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        PrintUsage();
+        return 1;
+    }
+}
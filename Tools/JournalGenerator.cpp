@@ -0,0 +1,179 @@
+#include "SyntheticJournal.h"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+enum class Format { Json, Wal };
+
+struct Options {
+    std::string outputDirectory;
+    Format format = Format::Json;
+    size_t threads = 0;
+    Synthetic::Options model;
+};
+
+void PrintUsage() {
+    std::cout << "Usage: JournalGenerator --out <directory> [--students N] [--seed N]\n"
+                 "                        [--format json|wal] [--grades MEAN] [--group-size MEAN]\n"
+                 "                        [--latin-share FRACTION] [--threads N]\n";
+}
+
+Options ParseOptions(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Missing value for " + arg);
+            }
+            return argv[++i];
+        };
+        if (arg == "--out") options.outputDirectory = next();
+        else if (arg == "--students") options.model.students = std::stoull(next());
+        else if (arg == "--seed") options.model.seed = std::stoull(next());
+        else if (arg == "--grades") options.model.meanGrades = std::stod(next());
+        else if (arg == "--group-size") options.model.meanGroupSize = std::stod(next());
+        else if (arg == "--latin-share") options.model.latinShare = std::stod(next());
+        else if (arg == "--threads") options.threads = std::stoull(next());
+        else if (arg == "--format") {
+            std::string format = next();
+            if (format == "json") options.format = Format::Json;
+            else if (format == "wal") options.format = Format::Wal;
+            else throw std::invalid_argument("--format must be json or wal");
+        }
+        else throw std::invalid_argument("Unknown option: " + arg);
+    }
+    if (options.outputDirectory.empty()) {
+        throw std::invalid_argument("--out is required");
+    }
+    if (options.model.students == 0 || options.model.students > 100000000) {
+        throw std::invalid_argument("--students must be between 1 and 100000000");
+    }
+    if (options.model.meanGrades < 0 || options.model.meanGroupSize < 5) {
+        throw std::invalid_argument("--grades must be >= 0 and --group-size >= 5");
+    }
+    if (options.model.latinShare < 0 || options.model.latinShare > 1) {
+        throw std::invalid_argument("--latin-share must be between 0 and 1");
+    }
+    if (options.threads == 0) {
+        options.threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return options;
+}
+
+void WriteGroups(const Synthetic::JournalModel& model, const std::string& path) {
+    json groups = json::array();
+    for (const auto& plan : model.Groups()) {
+        groups.push_back(plan.group.ToJson());
+    }
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    file << groups.dump(4);
+}
+
+// JSON: one array, the format JsonStorage and WALJsonStorage compaction read.
+// WAL: one INSERT operation per line and no data file, so the journal is
+// rebuilt entirely by WAL replay on first load.
+std::string RenderChunk(const Synthetic::JournalModel& model, Format format, size_t begin, size_t end) {
+    std::string out;
+    out.reserve((end - begin) * 512);
+    Synthetic::StudentRecord record;
+    for (size_t index = begin; index < end; ++index) {
+        model.Generate(index, record);
+        if (format == Format::Json) {
+            if (index > 0) out += ",\n";
+            Synthetic::AppendStudentJson(out, record);
+        } else {
+            out += "{\"type\":0,\"id\":";
+            Synthetic::AppendNumber(out, record.id);
+            out += ",\"timestamp\":1767225600,\"data\":";
+            Synthetic::AppendStudentJson(out, record);
+            out += "}\n";
+        }
+    }
+    return out;
+}
+
+uint64_t WriteStudents(const Synthetic::JournalModel& model, const Options& options, const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+
+    const size_t chunk = 16384;
+    const size_t total = model.StudentCount();
+    uint64_t written = 0;
+    auto put = [&](const std::string& text) {
+        if (std::fwrite(text.data(), 1, text.size(), file) != text.size()) {
+            std::fclose(file);
+            throw std::runtime_error("Write failed for " + path);
+        }
+        written += text.size();
+    };
+
+    if (options.format == Format::Json) put("[\n");
+    for (size_t wave = 0; wave < total; wave += chunk * options.threads) {
+        std::vector<std::future<std::string>> pending;
+        for (size_t begin = wave; begin < total && begin < wave + chunk * options.threads; begin += chunk) {
+            size_t end = std::min(total, begin + chunk);
+            pending.push_back(std::async(std::launch::async, RenderChunk,
+                                         std::cref(model), options.format, begin, end));
+        }
+        for (auto& future : pending) {
+            put(future.get());
+        }
+    }
+    if (options.format == Format::Json) put("\n]\n");
+
+    if (std::fclose(file) != 0) {
+        throw std::runtime_error("Close failed for " + path);
+    }
+    return written;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        Options options = ParseOptions(argc, argv);
+        namespace fs = std::filesystem;
+        fs::create_directories(options.outputDirectory);
+
+        auto started = std::chrono::steady_clock::now();
+        Synthetic::JournalModel model(options.model);
+
+        fs::path directory(options.outputDirectory);
+        std::string studentsPath = (directory / "students.json").string();
+        if (options.format == Format::Wal) {
+            fs::remove(studentsPath);
+            studentsPath += ".wal";
+        } else {
+            fs::remove(studentsPath + ".wal");
+        }
+        WriteGroups(model, (directory / "groups.json").string());
+        uint64_t bytes = WriteStudents(model, options, studentsPath);
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+        std::cout << std::fixed << std::setprecision(2)
+                  << "Students:   " << model.StudentCount() << " in " << model.Groups().size() << " groups\n"
+                  << "Seed:       " << options.model.seed << "\n"
+                  << "Output:     " << studentsPath << " (" << bytes / (1024.0 * 1024.0) << " MiB)\n"
+                  << "Elapsed:    " << elapsed << " s ("
+                  << static_cast<double>(model.StudentCount()) / elapsed << " records/s)\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        PrintUsage();
+        return 1;
+    }
+    return 0;
+}
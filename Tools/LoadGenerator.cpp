@@ -0,0 +1,157 @@
+#include "LatencyHistogram.h"
+#include "SocketClient.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+namespace {
+
+struct Options {
+    std::string socketPath;
+    int requests = 100000;
+    int depth = 32;
+    int writePercent = 10;
+    int seedStudents = 1000;
+};
+
+void PrintUsage() {
+    std::cout << "Usage: LoadGenerator --socket <path> [--requests N] [--depth N]"
+                 " [--writes PERCENT] [--students N]\n";
+}
+
+Options ParseOptions(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Missing value for " + arg);
+            }
+            return argv[++i];
+        };
+        if (arg == "--socket") options.socketPath = next();
+        else if (arg == "--requests") options.requests = std::stoi(next());
+        else if (arg == "--depth") options.depth = std::stoi(next());
+        else if (arg == "--writes") options.writePercent = std::stoi(next());
+        else if (arg == "--students") options.seedStudents = std::stoi(next());
+        else throw std::invalid_argument("Unknown option: " + arg);
+    }
+    if (options.socketPath.empty()) {
+        throw std::invalid_argument("--socket is required");
+    }
+    if (options.requests <= 0 || options.depth <= 0 || options.seedStudents <= 0) {
+        throw std::invalid_argument("Counts must be positive");
+    }
+    if (options.writePercent < 0 || options.writePercent > 100) {
+        throw std::invalid_argument("--writes must be between 0 and 100");
+    }
+    return options;
+}
+
+std::vector<int> SeedStudents(PL::UnixSocketClient& client, int count, int depth) {
+    std::vector<int> ids;
+    ids.reserve(count);
+    for (int start = 0; start < count; start += depth) {
+        int batch = std::min(depth, count - start);
+        for (int i = 0; i < batch; ++i) {
+            PL::BinaryWriter request;
+            request.WriteString("Load" + std::to_string(start + i));
+            request.WriteString("Student");
+            request.WriteString("LG-" + std::to_string((start + i) % 20));
+            client.Send(PL::OpCode::AddStudent, request.Data());
+        }
+        client.Flush();
+        for (int i = 0; i < batch; ++i) {
+            auto response = client.Receive();
+            if (response.status == PL::Status::Ok) {
+                PL::BinaryReader reader(response.payload);
+                ids.push_back(reader.ReadStudent().student.GetId());
+            }
+        }
+    }
+
+    if (ids.empty()) {
+        for (const auto& remote : client.GetAllStudents()) {
+            ids.push_back(remote.student.GetId());
+        }
+    }
+    if (ids.empty()) {
+        throw std::runtime_error("Server has no students to query");
+    }
+    return ids;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        Options options = ParseOptions(argc, argv);
+        PL::UnixSocketClient client(options.socketPath);
+
+        std::cout << "Seeding " << options.seedStudents << " students...\n";
+        std::vector<int> ids = SeedStudents(client, options.seedStudents, options.depth);
+
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<size_t> pickId(0, ids.size() - 1);
+        std::uniform_int_distribution<int> pickPercent(0, 99);
+        std::uniform_int_distribution<int> pickScore(0, 100);
+
+        using Clock = std::chrono::steady_clock;
+        Diagnostics::LatencyHistogram latency;
+        int errors = 0;
+
+        auto started = Clock::now();
+        for (int done = 0; done < options.requests; ) {
+            int batch = std::min(options.depth, options.requests - done);
+            for (int i = 0; i < batch; ++i) {
+                PL::BinaryWriter request;
+                int roll = pickPercent(rng);
+                if (roll < options.writePercent) {
+                    request.WriteI32(ids[pickId(rng)]);
+                    request.WriteString("Subject" + std::to_string(roll % 8));
+                    request.WriteI32(pickScore(rng));
+                    client.Send(PL::OpCode::AddGrade, request.Data());
+                } else if (roll % 10 == 0) {
+                    request.WriteString("LG-" + std::to_string(roll % 20));
+                    client.Send(PL::OpCode::FindByGroup, request.Data());
+                } else {
+                    request.WriteI32(ids[pickId(rng)]);
+                    client.Send(PL::OpCode::GetStudent, request.Data());
+                }
+            }
+
+            auto sent = Clock::now();
+            client.Flush();
+            for (int i = 0; i < batch; ++i) {
+                auto response = client.Receive();
+                if (response.status != PL::Status::Ok) {
+                    ++errors;
+                }
+                latency.Record(static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - sent).count()));
+            }
+            done += batch;
+        }
+        double elapsed = std::chrono::duration<double>(Clock::now() - started).count();
+
+        auto us = [&latency](double percentile) { return latency.Percentile(percentile) / 1000.0; };
+        std::cout << std::fixed << std::setprecision(1)
+                  << "Requests:     " << options.requests << " (pipeline depth " << options.depth
+                  << ", " << options.writePercent << "% writes)\n"
+                  << "Errors:       " << errors << "\n"
+                  << "Elapsed:      " << elapsed << " s\n"
+                  << "Throughput:   " << options.requests / elapsed << " ops/sec\n"
+                  << "Latency (us): p50 " << us(50)
+                  << " | p90 " << us(90)
+                  << " | p99 " << us(99)
+                  << " | p999 " << us(99.9)
+                  << " | max " << latency.Max() / 1000.0 << "\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        PrintUsage();
+        return 1;
+    }
+    return 0;
+}
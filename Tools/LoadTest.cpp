@@ -0,0 +1,373 @@
+#include "LatencyHistogram.h"
+#include "Services.h"
+#include "StorageFactory.h"
+#include "SyntheticJournal.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <set>
+#include <shared_mutex>
+#include <thread>
+
+#ifndef _WIN32
+#include "SocketClient.h"
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+enum Op { GetStudent, FindByGroup, FindByName, AddGrade, UpdateStudent, OpCount };
+
+const std::array<const char*, OpCount> OpNames = {
+    "GetStudent", "FindByGroup", "FindByName", "AddGrade", "UpdateStudent"
+};
+
+struct Options {
+    std::string target = "inproc";
+    std::string socketPath;
+    std::string dataDirectory;
+    size_t students = 10000;
+    int threads = 4;
+    int writePercent = 10;
+    double durationSeconds = 10.0;
+    double rate = 0.0;
+};
+
+void PrintUsage() {
+    std::cout << "Usage: LoadTest [--target inproc|socket] [--socket <path>] [--data <directory>]\n"
+                 "                [--students N] [--threads N] [--writes PERCENT]\n"
+                 "                [--duration SECONDS] [--rate OPS_PER_SEC]\n"
+                 "  inproc drives StudentService directly: --data loads <directory>/students.json\n"
+                 "  through WAL storage, otherwise --students synthetic records are held in memory.\n"
+                 "  --rate selects open-loop mode (latency measured from the scheduled start);\n"
+                 "  without it every thread runs closed-loop.\n";
+}
+
+Options ParseOptions(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Missing value for " + arg);
+            }
+            return argv[++i];
+        };
+        if (arg == "--target") options.target = next();
+        else if (arg == "--socket") options.socketPath = next();
+        else if (arg == "--data") options.dataDirectory = next();
+        else if (arg == "--students") options.students = std::stoull(next());
+        else if (arg == "--threads") options.threads = std::stoi(next());
+        else if (arg == "--writes") options.writePercent = std::stoi(next());
+        else if (arg == "--duration") options.durationSeconds = std::stod(next());
+        else if (arg == "--rate") options.rate = std::stod(next());
+        else throw std::invalid_argument("Unknown option: " + arg);
+    }
+    if (options.target != "inproc" && options.target != "socket") {
+        throw std::invalid_argument("--target must be inproc or socket");
+    }
+    if (options.target == "socket" && options.socketPath.empty()) {
+        throw std::invalid_argument("--socket is required for the socket target");
+    }
+    if (options.threads <= 0 || options.students == 0 || options.durationSeconds <= 0 || options.rate < 0) {
+        throw std::invalid_argument("Counts, duration and rate must be positive");
+    }
+    if (options.writePercent < 0 || options.writePercent > 100) {
+        throw std::invalid_argument("--writes must be between 0 and 100");
+    }
+    return options;
+}
+
+// Keys the workload draws from; taken once from the journal before the run.
+struct Workload {
+    std::vector<int> ids;
+    std::vector<std::string> groups;
+    std::vector<std::string> lastNames;
+
+    // `students` holds (student, group name) pairs.
+    template<typename Students>
+    void Collect(const Students& students) {
+        std::set<std::string> groupSet;
+        std::set<std::string> nameSet;
+        for (const auto& [student, groupName] : students) {
+            ids.push_back(student.GetId());
+            groupSet.insert(groupName);
+            nameSet.insert(student.GetLastName());
+        }
+        groups.assign(groupSet.begin(), groupSet.end());
+        lastNames.assign(nameSet.begin(), nameSet.end());
+        if (ids.empty()) {
+            throw std::runtime_error("The journal has no students to drive load against");
+        }
+    }
+};
+
+class Target {
+public:
+    virtual ~Target() = default;
+    virtual void Execute(Op op, const Workload& workload, std::mt19937_64& random) = 0;
+};
+
+template<typename T>
+const T& Pick(const std::vector<T>& values, std::mt19937_64& random) {
+    return values[random() % values.size()];
+}
+
+// StudentService is not thread-safe; readers share the lock and writers
+// take it exclusively, as a multi-threaded host would have to.
+class SharedJournal {
+public:
+    std::shared_mutex mutex;
+    std::shared_ptr<BLL::StudentService> service;
+};
+
+class InProcessTarget : public Target {
+private:
+    SharedJournal& journal;
+
+public:
+    explicit InProcessTarget(SharedJournal& shared) : journal(shared) {}
+
+    void Execute(Op op, const Workload& workload, std::mt19937_64& random) override {
+        switch (op) {
+            case GetStudent: {
+                int id = Pick(workload.ids, random);
+                std::shared_lock lock(journal.mutex);
+                auto student = journal.service->GetStudentById(id);
+                if (!student) throw BLL::StudentNotFoundException("missing " + std::to_string(id));
+                break;
+            }
+            case FindByGroup: {
+                const auto& group = Pick(workload.groups, random);
+                std::shared_lock lock(journal.mutex);
+                journal.service->FindByGroup(group);
+                break;
+            }
+            case FindByName: {
+                const auto& name = Pick(workload.lastNames, random);
+                std::shared_lock lock(journal.mutex);
+                journal.service->FindByName("", name);
+                break;
+            }
+            case AddGrade: {
+                int id = Pick(workload.ids, random);
+                int score = static_cast<int>(random() % 101);
+                std::unique_lock lock(journal.mutex);
+                journal.service->AddGradeToStudent(id, "Load Test", score);
+                break;
+            }
+            case UpdateStudent: {
+                int id = Pick(workload.ids, random);
+                const auto& group = Pick(workload.groups, random);
+                std::unique_lock lock(journal.mutex);
+                journal.service->UpdateStudent(id, "", "", group);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+};
+
+#ifndef _WIN32
+class SocketTarget : public Target {
+private:
+    PL::UnixSocketClient client;
+
+public:
+    explicit SocketTarget(const std::string& path) : client(path) {}
+
+    void Execute(Op op, const Workload& workload, std::mt19937_64& random) override {
+        switch (op) {
+            case GetStudent: client.GetStudent(Pick(workload.ids, random)); break;
+            case FindByGroup: client.FindByGroup(Pick(workload.groups, random)); break;
+            case FindByName: client.FindByName("", Pick(workload.lastNames, random)); break;
+            case AddGrade:
+                client.AddGrade(Pick(workload.ids, random), "Load Test", static_cast<int>(random() % 101));
+                break;
+            case UpdateStudent:
+                client.UpdateStudent(Pick(workload.ids, random), "", "", Pick(workload.groups, random));
+                break;
+            default:
+                break;
+        }
+    }
+};
+#endif
+
+// Reads: 60% GetStudent, 25% FindByGroup, 15% FindByName.
+// Writes: 80% AddGrade, 20% UpdateStudent.
+Op ChooseOp(int writePercent, std::mt19937_64& random) {
+    int roll = static_cast<int>(random() % 100);
+    int split = static_cast<int>(random() % 100);
+    if (roll < writePercent) {
+        return split < 80 ? AddGrade : UpdateStudent;
+    }
+    return split < 60 ? GetStudent : split < 85 ? FindByGroup : FindByName;
+}
+
+struct ThreadResult {
+    std::array<Diagnostics::LatencyHistogram, OpCount> latency;
+    std::array<uint64_t, OpCount> errors{};
+};
+
+void RunWorker(int index, const Options& options, const Workload& workload, Target& target,
+               Clock::time_point start, Clock::time_point stop, ThreadResult& result) {
+    std::mt19937_64 random(0x5EED0000ull + static_cast<uint64_t>(index));
+    bool openLoop = options.rate > 0;
+    auto interval = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(openLoop ? options.threads / options.rate : 0.0));
+    auto scheduled = start + interval * index / options.threads;
+
+    while (true) {
+        Clock::time_point begin;
+        if (openLoop) {
+            if (scheduled >= stop) break;
+            std::this_thread::sleep_until(scheduled);
+            begin = scheduled;
+            scheduled += interval;
+        } else {
+            begin = Clock::now();
+            if (begin >= stop) break;
+        }
+
+        Op op = ChooseOp(options.writePercent, random);
+        try {
+            target.Execute(op, workload, random);
+        } catch (const std::exception&) {
+            ++result.errors[op];
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin);
+        result.latency[op].Record(static_cast<uint64_t>(elapsed.count()));
+    }
+}
+
+void PrintRow(const std::string& name, const Diagnostics::LatencyHistogram& histogram,
+              uint64_t errors, double seconds) {
+    auto us = [](uint64_t ns) { return static_cast<double>(ns) / 1000.0; };
+    std::cout << std::left << std::setw(14) << name << std::right
+              << std::setw(10) << histogram.Count()
+              << std::setw(8) << errors
+              << std::setw(12) << static_cast<double>(histogram.Count()) / seconds
+              << std::setw(10) << us(histogram.Percentile(50))
+              << std::setw(10) << us(histogram.Percentile(99))
+              << std::setw(10) << us(histogram.Percentile(99.9))
+              << std::setw(12) << us(histogram.Max()) << "\n";
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        Options options = ParseOptions(argc, argv);
+        Workload workload;
+        SharedJournal journal;
+        std::function<std::unique_ptr<Target>()> makeTarget;
+
+        if (options.target == "inproc") {
+            std::shared_ptr<DAL::IDataStorage<BLL::Student>> storage;
+            std::shared_ptr<DAL::IDataStorage<BLL::Group>> groupStorage;
+            if (!options.dataDirectory.empty()) {
+                storage = DAL::StorageFactory<BLL::Student>::Create(
+                    DAL::StorageType::WAL, options.dataDirectory + "/students.json");
+                groupStorage = DAL::StorageFactory<BLL::Group>::Create(
+                    DAL::StorageType::Simple, options.dataDirectory + "/groups.json");
+            } else {
+                class MemoryStorage : public DAL::IDataStorage<BLL::Student> {
+                public:
+                    std::vector<BLL::Student> data;
+                    void Save(const std::vector<BLL::Student>&) override {}
+                    std::vector<BLL::Student> Load() override { return data; }
+                    void Clear() override { data.clear(); }
+                };
+                auto memory = std::make_shared<MemoryStorage>();
+                Synthetic::Options model;
+                model.students = options.students;
+                Synthetic::JournalModel generator(model);
+                Synthetic::StudentRecord record;
+                memory->data.reserve(options.students);
+                for (size_t i = 0; i < options.students; ++i) {
+                    generator.Generate(i, record);
+                    memory->data.push_back(record.ToStudent());
+                }
+                storage = memory;
+                std::vector<BLL::Group> groups;
+                for (const auto& plan : generator.Groups()) {
+                    groups.push_back(plan.group);
+                }
+                groupStorage = std::make_shared<DAL::MemoryStorage<BLL::Group>>(std::move(groups));
+            }
+            journal.service = std::make_shared<BLL::StudentService>(
+                storage, std::make_shared<BLL::GroupService>(groupStorage));
+            std::vector<std::pair<BLL::Student, std::string>> students;
+            for (const auto& student : journal.service->View()) {
+                students.emplace_back(student, journal.service->GroupName(student));
+            }
+            workload.Collect(students);
+            makeTarget = [&journal]() { return std::make_unique<InProcessTarget>(journal); };
+        } else {
+#ifndef _WIN32
+            PL::UnixSocketClient probe(options.socketPath);
+            workload.Collect(probe.GetAllStudents());
+            makeTarget = [&options]() { return std::make_unique<SocketTarget>(options.socketPath); };
+#else
+            throw std::invalid_argument("The socket target is not supported on this platform");
+#endif
+        }
+
+        std::vector<std::unique_ptr<Target>> targets;
+        for (int i = 0; i < options.threads; ++i) {
+            targets.push_back(makeTarget());
+        }
+
+        std::cout << "Driving " << workload.ids.size() << " students with " << options.threads
+                  << " thread(s), " << options.writePercent << "% writes, "
+                  << (options.rate > 0 ? "open loop at " + std::to_string(static_cast<long>(options.rate)) + " ops/s"
+                                       : std::string("closed loop"))
+                  << " for " << options.durationSeconds << " s\n";
+
+        std::vector<ThreadResult> results(options.threads);
+        auto start = Clock::now() + std::chrono::milliseconds(50);
+        auto stop = start + std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(options.durationSeconds));
+        {
+            std::vector<std::jthread> workers;
+            for (int i = 0; i < options.threads; ++i) {
+                workers.emplace_back(RunWorker, i, std::cref(options), std::cref(workload),
+                                     std::ref(*targets[i]), start, stop, std::ref(results[i]));
+            }
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        Diagnostics::LatencyHistogram overall;
+        uint64_t overallErrors = 0;
+        std::cout << "\n" << std::left << std::setw(14) << "Operation" << std::right
+                  << std::setw(10) << "Count" << std::setw(8) << "Errors" << std::setw(12) << "Ops/sec"
+                  << std::setw(10) << "p50 us" << std::setw(10) << "p99 us" << std::setw(10) << "p999 us"
+                  << std::setw(12) << "max us" << "\n" << std::fixed << std::setprecision(1);
+        for (int op = 0; op < OpCount; ++op) {
+            Diagnostics::LatencyHistogram merged;
+            uint64_t errors = 0;
+            for (const auto& result : results) {
+                merged.Merge(result.latency[op]);
+                errors += result.errors[op];
+            }
+            if (merged.Count() == 0) continue;
+            PrintRow(OpNames[op], merged, errors, seconds);
+            overall.Merge(merged);
+            overallErrors += errors;
+        }
+        PrintRow("Total", overall, overallErrors, seconds);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        PrintUsage();
+        return 1;
+    }
+    return 0;
+}
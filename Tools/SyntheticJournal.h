@@ -0,0 +1,341 @@
+#ifndef SYNTHETICJOURNAL_H
+#define SYNTHETICJOURNAL_H
+
+#include "Models.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+// Reproducible synthetic journals. Every random draw comes from
+// std::mt19937_64 (fully specified by the standard) and hand-written
+// transforms, so the same seed gives the same journal on every platform.
+// Student i depends only on the seed and i, which lets chunks be generated
+// in parallel without changing the output.
+namespace Synthetic {
+
+class Random {
+private:
+    std::mt19937_64 engine;
+    double spareNormal = 0.0;
+    bool hasSpare = false;
+
+public:
+    explicit Random(uint64_t seed) : engine(seed) {}
+
+    static uint64_t Mix(uint64_t value) {
+        value += 0x9E3779B97F4A7C15ull;
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+        return value ^ (value >> 31);
+    }
+
+    static Random ForStream(uint64_t seed, uint64_t stream) {
+        return Random(Mix(seed ^ Mix(stream)));
+    }
+
+    double Uniform() {
+        return static_cast<double>(engine() >> 11) * 0x1.0p-53;
+    }
+
+    size_t Below(size_t bound) {
+        return static_cast<size_t>(Uniform() * static_cast<double>(bound));
+    }
+
+    bool Chance(double probability) {
+        return Uniform() < probability;
+    }
+
+    double Normal(double mean, double deviation) {
+        if (hasSpare) {
+            hasSpare = false;
+            return mean + deviation * spareNormal;
+        }
+        double u = 0.0;
+        while (u <= 0.0) u = Uniform();
+        double v = Uniform();
+        double radius = std::sqrt(-2.0 * std::log(u));
+        spareNormal = radius * std::sin(2.0 * 3.14159265358979323846 * v);
+        hasSpare = true;
+        return mean + deviation * radius * std::cos(2.0 * 3.14159265358979323846 * v);
+    }
+
+    int ClampedNormal(double mean, double deviation, int low, int high) {
+        long value = std::lround(Normal(mean, deviation));
+        return static_cast<int>(std::clamp<long>(value, low, high));
+    }
+};
+
+// Rank r (0-based) is drawn with probability proportional to 1 / (r + 1)^s.
+class Zipf {
+private:
+    std::vector<double> cumulative;
+
+public:
+    Zipf(size_t count, double exponent) : cumulative(count) {
+        double total = 0.0;
+        for (size_t rank = 0; rank < count; ++rank) {
+            total += 1.0 / std::pow(static_cast<double>(rank + 1), exponent);
+            cumulative[rank] = total;
+        }
+        for (auto& value : cumulative) {
+            value /= total;
+        }
+    }
+
+    size_t Sample(Random& random) const {
+        auto it = std::lower_bound(cumulative.begin(), cumulative.end(), random.Uniform());
+        return std::min<size_t>(it - cumulative.begin(), cumulative.size() - 1);
+    }
+};
+
+struct Specialization {
+    std::string code;
+    std::string title;
+    std::vector<std::string> core;
+    std::vector<std::string> electives;
+};
+
+struct Options {
+    size_t students = 10000;
+    uint64_t seed = 1;
+    double meanGrades = 8.0;
+    double meanGroupSize = 25.0;
+    double latinShare = 0.15;
+};
+
+struct GroupPlan {
+    BLL::Group group;
+    size_t specialization;
+    size_t firstStudent;
+    size_t size;
+};
+
+struct StudentRecord {
+    int id = 0;
+    const std::string* firstName = nullptr;
+    const std::string* lastName = nullptr;
+    int groupId = 0;
+    std::vector<std::pair<const std::string*, int>> grades;
+
+    BLL::Student ToStudent() const {
+        BLL::Student student(id, *firstName, *lastName, groupId);
+        for (const auto& grade : grades) {
+            student.AddGrade(BLL::Grade(*grade.first, grade.second));
+        }
+        return student;
+    }
+};
+
+class JournalModel {
+private:
+    Options options;
+    std::vector<Specialization> specializations;
+    std::vector<std::string> cyrillicFirst;
+    std::vector<std::string> cyrillicLast;
+    std::vector<std::string> latinFirst;
+    std::vector<std::string> latinLast;
+    Zipf cyrillicFirstRank;
+    Zipf cyrillicLastRank;
+    Zipf latinFirstRank;
+    Zipf latinLastRank;
+    std::vector<Zipf> electiveRanks;
+    std::vector<GroupPlan> groups;
+    std::vector<size_t> groupStarts;
+
+    static std::vector<Specialization> DefaultSpecializations() {
+        return {
+            {"КН", "Комп'ютерні науки",
+             {"Вища математика", "Програмування", "Алгоритми", "Бази даних", "Англійська мова"},
+             {"Машинне навчання", "Веб-технології", "Комп'ютерна графіка", "Хмарні обчислення", "Філософія"}},
+            {"ІПЗ", "Інженерія програмного забезпечення",
+             {"Програмування", "Об'єктно-орієнтоване програмування", "Тестування ПЗ", "Дискретна математика", "Англійська мова"},
+             {"Архітектура ПЗ", "DevOps", "Мобільна розробка", "Управління проєктами", "Психологія"}},
+            {"КІ", "Комп'ютерна інженерія",
+             {"Вища математика", "Фізика", "Схемотехніка", "Комп'ютерні мережі", "Операційні системи"},
+             {"Вбудовані системи", "Кібербезпека", "Цифрова обробка сигналів", "Економіка"}},
+            {"ЕК", "Економіка",
+             {"Мікроекономіка", "Макроекономіка", "Статистика", "Бухгалтерський облік", "Англійська мова"},
+             {"Фінанси", "Маркетинг", "Економетрика", "Правознавство", "Історія України"}},
+            {"AV", "Aviation Engineering",
+             {"Mathematics", "Physics", "Aerodynamics", "Materials Science", "English"},
+             {"Avionics", "Flight Mechanics", "Composite Structures", "History"}},
+            {"CS", "Computer Science (English track)",
+             {"Calculus", "Programming", "Data Structures", "Databases", "Networks"},
+             {"Machine Learning", "Compilers", "Distributed Systems", "Security"}}
+        };
+    }
+
+    // Tiers of popularity follow the Zipf rank order of each list.
+    static std::vector<std::string> CyrillicFirstNames() {
+        return {"Олександр", "Анна", "Максим", "Марія", "Дмитро", "Софія", "Андрій", "Анастасія",
+                "Іван", "Вікторія", "Артем", "Катерина", "Богдан", "Юлія", "Назар", "Дарина",
+                "Владислав", "Олена", "Тарас", "Ірина", "Денис", "Ольга", "Євген", "Христина",
+                "Ярослав", "Тетяна", "Остап", "Ґражина", "Єлизавета", "Святослав"};
+    }
+
+    static std::vector<std::string> CyrillicLastNames() {
+        return {"Мельник", "Шевченко", "Коваленко", "Бондаренко", "Бойко", "Ткаченко", "Кравченко",
+                "Ковальчук", "Коваль", "Олійник", "Шевчук", "Поліщук", "Ткачук", "Савченко",
+                "Бондар", "Марченко", "Руденко", "Мороз", "Лисенко", "Петренко", "Клименко",
+                "Павленко", "Кравчук", "Кузьменко", "Пономаренко", "Савчук", "Василенко",
+                "Левченко", "Харченко", "Карпенко", "Гончаренко", "Романенко", "Ґудзь", "Єрмоленко"};
+    }
+
+    static std::vector<std::string> LatinFirstNames() {
+        return {"John", "Maria", "David", "Anna", "Michael", "Sofia", "James", "Emma", "Ahmed",
+                "Li", "Carlos", "Fatima", "Lukas", "Olivia", "Wei", "Noah", "Amir", "Elena"};
+    }
+
+    static std::vector<std::string> LatinLastNames() {
+        return {"Smith", "Garcia", "Kowalski", "Muller", "Nguyen", "Wang", "Johnson", "Hassan",
+                "Novak", "Rossi", "Brown", "Kim", "Silva", "Schmidt", "Lopez", "Khan"};
+    }
+
+    void PlanGroups() {
+        Random random = Random::ForStream(options.seed, 0xC0FFEEull);
+        Zipf specializationRank(specializations.size(), 0.9);
+        std::vector<std::vector<int>> counters(specializations.size(), std::vector<int>(7, 0));
+
+        size_t assigned = 0;
+        while (assigned < options.students) {
+            size_t specialization = specializationRank.Sample(random);
+            int year = 1 + static_cast<int>(std::min<size_t>(random.Below(100) / 22, 4));
+            int high = static_cast<int>(options.meanGroupSize * 2);
+            size_t size = random.ClampedNormal(options.meanGroupSize, options.meanGroupSize * 0.2, 5, std::max(5, high));
+            size = std::min(size, options.students - assigned);
+
+            int number = ++counters[specialization][year];
+            std::string name = specializations[specialization].code + "-" +
+                               std::to_string(26 - year) + "-" + std::to_string(number);
+            int id = static_cast<int>(groups.size()) + 1;
+            groups.push_back(GroupPlan{BLL::Group(id, name, specializations[specialization].title, year),
+                                       specialization, assigned, size});
+            groupStarts.push_back(assigned);
+            assigned += size;
+        }
+    }
+
+public:
+    explicit JournalModel(const Options& opts)
+        : options(opts),
+          specializations(DefaultSpecializations()),
+          cyrillicFirst(CyrillicFirstNames()),
+          cyrillicLast(CyrillicLastNames()),
+          latinFirst(LatinFirstNames()),
+          latinLast(LatinLastNames()),
+          cyrillicFirstRank(cyrillicFirst.size(), 1.0),
+          cyrillicLastRank(cyrillicLast.size(), 0.8),
+          latinFirstRank(latinFirst.size(), 1.0),
+          latinLastRank(latinLast.size(), 0.8) {
+        for (const auto& specialization : specializations) {
+            electiveRanks.emplace_back(specialization.electives.size(), 0.7);
+        }
+        PlanGroups();
+    }
+
+    const std::vector<GroupPlan>& Groups() const {
+        return groups;
+    }
+
+    size_t StudentCount() const {
+        return options.students;
+    }
+
+    // Fills `record` with student number `index` (0-based, id = index + 1).
+    void Generate(size_t index, StudentRecord& record) const {
+        Random random = Random::ForStream(options.seed, index + 1);
+        size_t groupIndex = std::upper_bound(groupStarts.begin(), groupStarts.end(), index) - groupStarts.begin() - 1;
+        const GroupPlan& plan = groups[groupIndex];
+        const Specialization& specialization = specializations[plan.specialization];
+
+        record.id = static_cast<int>(index + 1);
+        record.groupId = plan.group.GetId();
+        if (random.Chance(options.latinShare)) {
+            record.firstName = &latinFirst[latinFirstRank.Sample(random)];
+            record.lastName = &latinLast[latinLastRank.Sample(random)];
+        } else {
+            record.firstName = &cyrillicFirst[cyrillicFirstRank.Sample(random)];
+            record.lastName = &cyrillicLast[cyrillicLastRank.Sample(random)];
+        }
+
+        size_t available = specialization.core.size() + specialization.electives.size();
+        size_t count = static_cast<size_t>(random.ClampedNormal(options.meanGrades, options.meanGrades / 4.0,
+                                                               0, static_cast<int>(available)));
+        double ability = random.Normal(72.0, 11.0);
+
+        record.grades.clear();
+        for (size_t i = 0; i < count && i < specialization.core.size(); ++i) {
+            double difficulty = static_cast<double>(i % 4) * 3.0;
+            record.grades.emplace_back(&specialization.core[i],
+                                       random.ClampedNormal(ability - difficulty, 9.0, 0, 100));
+        }
+        if (count > specialization.core.size()) {
+            uint64_t taken = 0;
+            while (record.grades.size() < count) {
+                size_t elective = electiveRanks[plan.specialization].Sample(random);
+                if (taken & (1ull << elective)) continue;
+                taken |= 1ull << elective;
+                record.grades.emplace_back(&specialization.electives[elective],
+                                           random.ClampedNormal(ability + 4.0, 8.0, 0, 100));
+            }
+        }
+    }
+};
+
+inline void AppendEscaped(std::string& out, const std::string& text) {
+    out.push_back('"');
+    for (char c : text) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                    out += buffer;
+                } else {
+                    out.push_back(c);
+                }
+        }
+    }
+    out.push_back('"');
+}
+
+inline void AppendNumber(std::string& out, long long value) {
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+// Same fields as BLL::Student::ToJson(), written without building a DOM.
+inline void AppendStudentJson(std::string& out, const StudentRecord& record) {
+    out += "{\"id\":";
+    AppendNumber(out, record.id);
+    out += ",\"firstName\":";
+    AppendEscaped(out, *record.firstName);
+    out += ",\"lastName\":";
+    AppendEscaped(out, *record.lastName);
+    out += ",\"groupId\":";
+    AppendNumber(out, record.groupId);
+    out += ",\"grades\":[";
+    for (size_t i = 0; i < record.grades.size(); ++i) {
+        if (i > 0) out.push_back(',');
+        out += "{\"subject\":";
+        AppendEscaped(out, *record.grades[i].first);
+        out += ",\"score\":";
+        AppendNumber(out, record.grades[i].second);
+        out.push_back('}');
+    }
+    out += "]}";
+}
+
+}
+
+#endif
@@ -0,0 +1,397 @@
+#include "AppConfig.h"
+#include "BinaryProtocol.h"
+#include "LatencyHistogram.h"
+#include "WALJsonStorage.h"
+#include "WorkloadCapture.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Replays recorded traffic against a freshly opened backend and reports
+// throughput and latency per operation. Two inputs are understood:
+//   - a capture written by "GradeJournal --serve <socket> --capture <file>":
+//     every request, reads included, goes through a RequestDispatcher per
+//     captured connection, exactly as the server ran it;
+//   - a students.json.wal: each logged operation or batch is persisted
+//     through IDataStorage::SaveChanges, the way a service persists a change.
+// The backend comes from the usual --config/--set settings, so the same
+// recording can be replayed against json and wal storage and compared.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string input;
+    std::string configPath;
+    std::vector<std::string> overrides;
+    std::string dataDirectory;
+    std::string workDirectory;
+    std::string reportPath;
+    double speed = 0.0;
+    bool keep = false;
+};
+
+void PrintUsage() {
+    std::cout << "Usage: WorkloadReplay --input <capture|students.json.wal> [--speed max|original|FACTOR]\n"
+                 "                      [--config <file>] [--set <key.path>=<value>]... [--data <directory>]\n"
+                 "                      [--workdir <directory>] [--keep] [--json <report.json>]\n"
+                 "  --data is copied into the work directory before the replay; a directory with\n"
+                 "  subdirectories is opened as a journal set, otherwise as a single journal.\n"
+                 "  --speed original keeps the recorded gaps between requests (FACTOR scales\n"
+                 "  them, 2 replays twice as fast); max issues the next request immediately.\n";
+}
+
+Options ParseOptions(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Missing value for " + arg);
+            }
+            return argv[++i];
+        };
+        if (arg == "--input") options.input = next();
+        else if (arg == "--config") options.configPath = next();
+        else if (arg == "--set") options.overrides.push_back(next());
+        else if (arg == "--data") options.dataDirectory = next();
+        else if (arg == "--workdir") options.workDirectory = next();
+        else if (arg == "--json") options.reportPath = next();
+        else if (arg == "--keep") options.keep = true;
+        else if (arg == "--speed") {
+            std::string value = next();
+            if (value == "max") options.speed = 0.0;
+            else if (value == "original") options.speed = 1.0;
+            else options.speed = std::stod(value);
+            if (options.speed < 0) {
+                throw std::invalid_argument("--speed must be max, original or a positive factor");
+            }
+        } else throw std::invalid_argument("Unknown option: " + arg);
+    }
+    if (options.input.empty()) {
+        throw std::invalid_argument("--input is required");
+    }
+    return options;
+}
+
+struct OperationStats {
+    Diagnostics::LatencyHistogram latency;
+    Diagnostics::LatencyHistogram recorded;
+    uint64_t errors = 0;
+};
+
+struct ReplayResult {
+    std::map<std::string, OperationStats> operations;
+    Diagnostics::LatencyHistogram lag;
+    uint64_t statusMismatches = 0;
+    double seconds = 0;
+};
+
+// Paces the replay. At a finite speed each request is due at its recorded
+// offset divided by the speed; latency is then measured from that due time,
+// so a backend that falls behind shows it as queueing delay instead of
+// silently issuing fewer requests per second.
+class Schedule {
+private:
+    double speed;
+    Clock::time_point start = Clock::now();
+    bool haveFirst = false;
+    uint64_t firstOffsetNs = 0;
+
+public:
+    explicit Schedule(double replaySpeed) : speed(replaySpeed) {}
+
+    Clock::time_point Wait(uint64_t offsetNs) {
+        if (speed <= 0) {
+            return Clock::now();
+        }
+        if (!haveFirst) {
+            haveFirst = true;
+            firstOffsetNs = offsetNs;
+        }
+        uint64_t relative = offsetNs > firstOffsetNs ? offsetNs - firstOffsetNs : 0;
+        auto due = start + std::chrono::nanoseconds(static_cast<int64_t>(static_cast<double>(relative) / speed));
+        std::this_thread::sleep_until(due);
+        return due;
+    }
+
+    Clock::time_point Start() const { return start; }
+};
+
+uint64_t Since(Clock::time_point from) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - from).count());
+}
+
+std::shared_ptr<BLL::JournalSet> OpenJournals(const PL::AppConfig& config, const std::string& directory) {
+    BLL::StorageProvider<BLL::Student> studentStorage = [config](const std::string& path) {
+        return DAL::StorageFactory<BLL::Student>::Create(config.students, path);
+    };
+    BLL::StorageProvider<BLL::Group> groupStorage = [config](const std::string& path) {
+        return DAL::StorageFactory<BLL::Group>::Create(config.groups, path);
+    };
+
+    bool hasJournals = false;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        hasJournals = hasJournals || entry.is_directory();
+    }
+    auto pool = std::make_shared<BLL::ThreadPool>(config.threads);
+    if (hasJournals) {
+        return BLL::JournalSet::Open(directory, studentStorage, groupStorage, pool);
+    }
+    auto journals = std::make_shared<BLL::JournalSet>(pool);
+    auto groups = std::make_shared<BLL::GroupService>(groupStorage(directory + "/groups.json"));
+    journals->Add("default", std::make_shared<BLL::StudentService>(studentStorage(directory + "/students.json"), groups));
+    return journals;
+}
+
+ReplayResult ReplayCapture(const Options& options, const PL::AppConfig& config, const std::string& directory) {
+    auto journals = OpenJournals(config, directory);
+    for (const auto& name : journals->GetNames()) {
+        journals->Get(name)->students->SetNamePrefixIndexEnabled(config.namePrefixIndex);
+    }
+    PL::RequestDispatcher prototype(journals);
+    std::map<uint32_t, PL::RequestDispatcher> sessions;
+
+    ReplayResult result;
+    PL::WorkloadCaptureReader reader(options.input);
+    PL::CapturedRequest request;
+    Schedule schedule(options.speed);
+    uint32_t requestId = 0;
+    while (reader.Next(request)) {
+        auto session = sessions.find(request.session);
+        if (session == sessions.end()) {
+            session = sessions.emplace(request.session, prototype).first;
+        }
+        auto due = schedule.Wait(request.offsetNs);
+        auto issued = Clock::now();
+        result.lag.Record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(issued - due).count()));
+
+        PL::Response response = session->second.Dispatch(PL::Frame{++requestId, request.code, request.payload});
+        uint64_t latency = Since(due);
+
+        OperationStats& stats = result.operations[PL::OpCodeName(request.code)];
+        stats.latency.Record(latency);
+        stats.recorded.Record(request.latencyNs);
+        if (response.status != PL::Status::Ok) ++stats.errors;
+        if (static_cast<uint8_t>(response.status) != request.status) ++result.statusMismatches;
+    }
+    result.seconds = std::chrono::duration<double>(Clock::now() - schedule.Start()).count();
+    return result;
+}
+
+ReplayResult ReplayWal(const Options& options, const PL::AppConfig& config, const std::string& directory) {
+    auto storage = DAL::StorageFactory<BLL::Student>::Create(config.students, directory + "/students.json");
+    std::map<int, BLL::Student> current;
+    for (const auto& student : storage->Load()) {
+        current[student.GetId()] = student;
+    }
+
+    std::ifstream wal(options.input, std::ios::binary);
+    if (!wal.is_open()) {
+        throw std::runtime_error("Cannot open " + options.input);
+    }
+
+    ReplayResult result;
+    Schedule schedule(options.speed);
+    std::vector<BLL::Student> snapshot;
+    std::string line;
+    int64_t firstTimestamp = -1;
+    while (std::getline(wal, line)) {
+        if (wal.eof() || line.empty()) {
+            continue;
+        }
+        json entry;
+        std::vector<DAL::Operation<BLL::Student>> ops;
+        try {
+            entry = json::parse(line);
+            if (entry["type"].get<int>() == static_cast<int>(DAL::OperationType::BATCH)) {
+                for (const auto& element : entry["ops"]) {
+                    ops.push_back(DAL::Operation<BLL::Student>::FromJson(element));
+                }
+            } else {
+                ops.push_back(DAL::Operation<BLL::Student>::FromJson(entry));
+            }
+        } catch (const std::exception&) {
+            continue;
+        }
+        int64_t timestamp = entry.value("timestamp", int64_t{0});
+        if (firstTimestamp < 0) firstTimestamp = timestamp;
+        auto due = schedule.Wait(static_cast<uint64_t>(std::max<int64_t>(timestamp - firstTimestamp, 0)) * 1000000000ull);
+        auto issued = Clock::now();
+        result.lag.Record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(issued - due).count()));
+
+        std::string name = ops.size() == 1 ? "wal.insert" : "wal.batch";
+        bool failed = false;
+        DAL::ChangeSet<BLL::Student> changes;
+        for (const auto& op : ops) {
+            switch (op.type) {
+                case DAL::OperationType::UPDATE:
+                    if (ops.size() == 1) name = "wal.update";
+                    failed = failed || current.count(op.id) == 0;
+                    [[fallthrough]];
+                case DAL::OperationType::INSERT:
+                    current[op.id] = op.data;
+                    changes.upserts.push_back(op.data);
+                    break;
+                case DAL::OperationType::DELETE:
+                    if (ops.size() == 1) name = "wal.delete";
+                    failed = failed || current.erase(op.id) == 0;
+                    changes.removals.push_back(op.id);
+                    break;
+                case DAL::OperationType::BATCH:
+                    break;
+            }
+        }
+        snapshot.clear();
+        for (const auto& pair : current) {
+            snapshot.push_back(pair.second);
+        }
+        try {
+            storage->SaveChanges(snapshot, changes);
+        } catch (const std::exception&) {
+            failed = true;
+        }
+
+        OperationStats& stats = result.operations[name];
+        stats.latency.Record(Since(due));
+        if (failed) ++stats.errors;
+    }
+    result.seconds = std::chrono::duration<double>(Clock::now() - schedule.Start()).count();
+    return result;
+}
+
+void PrintRow(const std::string& name, const OperationStats& stats, double seconds, bool withRecorded) {
+    auto us = [](uint64_t ns) { return static_cast<double>(ns) / 1000.0; };
+    std::cout << std::left << std::setw(26) << name << std::right
+              << std::setw(9) << stats.latency.Count()
+              << std::setw(8) << stats.errors
+              << std::setw(11) << static_cast<double>(stats.latency.Count()) / seconds
+              << std::setw(10) << us(stats.latency.Percentile(50))
+              << std::setw(10) << us(stats.latency.Percentile(99))
+              << std::setw(10) << us(stats.latency.Percentile(99.9))
+              << std::setw(12) << us(stats.latency.Max());
+    if (withRecorded) {
+        std::cout << std::setw(12) << us(stats.recorded.Percentile(50))
+                  << std::setw(12) << us(stats.recorded.Percentile(99));
+    }
+    std::cout << "\n";
+}
+
+json ToJson(const ReplayResult& result, const Options& options, const PL::AppConfig& config, bool capture) {
+    auto us = [](uint64_t ns) { return static_cast<double>(ns) / 1000.0; };
+    json operations = json::object();
+    uint64_t total = 0;
+    for (const auto& [name, stats] : result.operations) {
+        total += stats.latency.Count();
+        operations[name] = {
+            {"count", stats.latency.Count()}, {"errors", stats.errors},
+            {"p50Us", us(stats.latency.Percentile(50))}, {"p99Us", us(stats.latency.Percentile(99))},
+            {"p999Us", us(stats.latency.Percentile(99.9))}, {"maxUs", us(stats.latency.Max())}
+        };
+    }
+    return {
+        {"input", options.input},
+        {"kind", capture ? "capture" : "wal"},
+        {"speed", options.speed},
+        {"storage", config.ToJson()["storage"]},
+        {"seconds", result.seconds},
+        {"requests", total},
+        {"opsPerSecond", result.seconds > 0 ? static_cast<double>(total) / result.seconds : 0.0},
+        {"statusMismatches", result.statusMismatches},
+        {"scheduleLagP99Us", us(result.lag.Percentile(99))},
+        {"operations", operations}
+    };
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        Options options = ParseOptions(argc, argv);
+        PL::AppConfig config = PL::AppConfig::Load(options.configPath, options.overrides);
+        bool capture = PL::WorkloadCaptureReader::IsCapture(options.input);
+
+        namespace fs = std::filesystem;
+        bool temporary = options.workDirectory.empty();
+        fs::path directory = temporary
+            ? fs::temp_directory_path() / ("gradejournal-replay-" + std::to_string(
+                  std::chrono::steady_clock::now().time_since_epoch().count()))
+            : fs::path(options.workDirectory);
+        if (fs::exists(directory) && !fs::is_empty(directory)) {
+            throw std::invalid_argument("Work directory is not empty: " + directory.string());
+        }
+        fs::create_directories(directory);
+        if (!options.dataDirectory.empty()) {
+            fs::copy(options.dataDirectory, directory, fs::copy_options::recursive);
+        }
+
+        std::cout << "Replaying " << (capture ? "capture " : "WAL ") << options.input << " on "
+                  << config.ToJson()["storage"]["students"]["backend"].get<std::string>() << " storage at ";
+        if (options.speed > 0) {
+            std::cout << options.speed << "x recorded speed\n";
+        } else {
+            std::cout << "max speed\n";
+        }
+
+        ReplayResult result = capture ? ReplayCapture(options, config, directory.string())
+                                      : ReplayWal(options, config, directory.string());
+
+        Diagnostics::LatencyHistogram overall;
+        OperationStats total;
+        std::cout << "\n" << std::left << std::setw(26) << "Operation" << std::right
+                  << std::setw(9) << "Count" << std::setw(8) << "Errors" << std::setw(11) << "Ops/sec"
+                  << std::setw(10) << "p50 us" << std::setw(10) << "p99 us" << std::setw(10) << "p999 us"
+                  << std::setw(12) << "max us";
+        if (capture) {
+            std::cout << std::setw(12) << "rec p50 us" << std::setw(12) << "rec p99 us";
+        }
+        std::cout << "\n" << std::fixed << std::setprecision(1);
+        for (const auto& [name, stats] : result.operations) {
+            PrintRow(name, stats, result.seconds, capture);
+            total.latency.Merge(stats.latency);
+            total.recorded.Merge(stats.recorded);
+            total.errors += stats.errors;
+        }
+        PrintRow("Total", total, result.seconds, capture);
+
+        std::cout << "\n" << total.latency.Count() << " requests in " << std::setprecision(3) << result.seconds
+                  << " s";
+        if (options.speed > 0) {
+            std::cout << ", schedule lag p99 " << std::setprecision(1)
+                      << static_cast<double>(result.lag.Percentile(99)) / 1000.0 << " us";
+        }
+        std::cout << "\n";
+        if (capture && result.statusMismatches > 0) {
+            std::cout << result.statusMismatches << " requests finished with a different status than recorded;"
+                         " replay on a copy of the original data (--data) to reproduce them exactly.\n";
+        }
+
+        if (!options.reportPath.empty()) {
+            std::ofstream report(options.reportPath, std::ios::trunc);
+            if (!report.is_open()) {
+                throw std::runtime_error("Cannot write report " + options.reportPath);
+            }
+            report << ToJson(result, options, config, capture).dump(2) << "\n";
+        }
+
+        if (temporary && !options.keep) {
+            std::error_code error;
+            fs::remove_all(directory, error);
+        } else {
+            std::cout << "Replayed data left in " << directory.string() << "\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        PrintUsage();
+        return 1;
+    }
+    return 0;
+}
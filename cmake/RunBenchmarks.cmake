@@ -0,0 +1,95 @@
+# Runs the benchmark suites, stores their JSON reports under
+# RESULTS_DIR/<commit>/ and compares them with RESULTS_DIR/baseline/.
+# Invoked by the bench-check and bench-baseline targets:
+#
+#   cmake -DBENCH_DIR=<dir with the suites> -DCOMPARE=<BenchCompare>
+#         -DRESULTS_DIR=<dir> -DSOURCE_DIR=<repo> [-DUPDATE_BASELINE=ON]
+#         [-DREPETITIONS=5] [-DTOLERANCE=0.10] [-DALPHA=0.05]
+#         [-D<Suite>_FILTER=<regex>]
+#         -P RunBenchmarks.cmake
+
+foreach(required BENCH_DIR COMPARE RESULTS_DIR SOURCE_DIR)
+    if(NOT DEFINED ${required})
+        message(FATAL_ERROR "RunBenchmarks.cmake: ${required} is not set")
+    endif()
+endforeach()
+
+if(NOT DEFINED REPETITIONS)
+    set(REPETITIONS 5)
+endif()
+if(NOT DEFINED TOLERANCE)
+    set(TOLERANCE 0.10)
+endif()
+if(NOT DEFINED ALPHA)
+    set(ALPHA 0.05)
+endif()
+
+# Tracked subset: mid-sized journals keep a full run to a few minutes.
+if(NOT DEFINED StorageBenchmarks_FILTER)
+    set(StorageBenchmarks_FILTER "records:10000/")
+endif()
+if(NOT DEFINED ServiceBenchmarks_FILTER)
+    set(ServiceBenchmarks_FILTER "students:10000$|BM_ScopedOperation|BM_Import/2000")
+endif()
+
+execute_process(
+    COMMAND git rev-parse --short HEAD
+    WORKING_DIRECTORY ${SOURCE_DIR}
+    OUTPUT_VARIABLE commit
+    OUTPUT_STRIP_TRAILING_WHITESPACE
+    RESULT_VARIABLE gitResult)
+if(NOT gitResult EQUAL 0 OR commit STREQUAL "")
+    set(commit "unknown")
+endif()
+execute_process(
+    COMMAND git status --porcelain --untracked-files=no
+    WORKING_DIRECTORY ${SOURCE_DIR}
+    OUTPUT_VARIABLE dirty
+    OUTPUT_STRIP_TRAILING_WHITESPACE)
+if(NOT dirty STREQUAL "")
+    set(commit "${commit}-dirty")
+endif()
+
+set(runDir ${RESULTS_DIR}/${commit})
+file(MAKE_DIRECTORY ${runDir})
+message(STATUS "Benchmark results: ${runDir}")
+
+set(failed FALSE)
+foreach(suite StorageBenchmarks ServiceBenchmarks)
+    set(report ${runDir}/${suite}.json)
+    message(STATUS "Running ${suite} (${REPETITIONS} repetitions)")
+    execute_process(
+        COMMAND ${BENCH_DIR}/${suite}
+                --benchmark_filter=${${suite}_FILTER}
+                --benchmark_repetitions=${REPETITIONS}
+                --benchmark_enable_random_interleaving=true
+                --benchmark_out=${report}
+                --benchmark_out_format=json
+        OUTPUT_QUIET
+        ERROR_FILE ${runDir}/${suite}.log
+        RESULT_VARIABLE runResult)
+    if(NOT runResult EQUAL 0)
+        message(FATAL_ERROR "${suite} failed with exit code ${runResult}, see ${runDir}/${suite}.log")
+    endif()
+
+    set(baseline ${RESULTS_DIR}/baseline/${suite}.json)
+    if(UPDATE_BASELINE)
+        file(COPY ${report} DESTINATION ${RESULTS_DIR}/baseline)
+        file(WRITE ${RESULTS_DIR}/baseline/COMMIT "${commit}\n")
+        message(STATUS "${suite}: baseline updated from ${commit}")
+    elseif(NOT EXISTS ${baseline})
+        message(WARNING "${suite}: no baseline yet; build the bench-baseline target first")
+    else()
+        execute_process(
+            COMMAND ${COMPARE} --baseline ${baseline} --current ${report}
+                    --tolerance ${TOLERANCE} --alpha ${ALPHA}
+            RESULT_VARIABLE compareResult)
+        if(NOT compareResult EQUAL 0)
+            set(failed TRUE)
+        endif()
+    endif()
+endforeach()
+
+if(failed)
+    message(FATAL_ERROR "Benchmark regression against baseline (see tables above)")
+endif()
@@ -1,21 +1,185 @@
+#include "AppConfig.h"
 #include "ConsoleInterface.h"
+#include "Journal.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include <chrono>
+#include <filesystem>
 #include <iostream>
 #include <memory>
+#include <optional>
+#include <string>
+#include <vector>
 
 #include "StorageFactory.h"
+#include "TimedStorage.h"
 
-int main() {
+#ifndef _WIN32
+#include "SocketServer.h"
+#include <csignal>
+
+namespace {
+PL::UnixSocketServer* activeServer = nullptr;
+
+void StopServer(int) {
+    if (activeServer) {
+        activeServer->Stop();
+    }
+}
+
+void RequestMetricsDump(int) {
+    Diagnostics::MetricsDumper::Request();
+}
+
+void ToggleTracing(int) {
+    Diagnostics::Tracer::Toggle();
+}
+}
+#endif
+
+int main(int argc, char* argv[]) {
     try {
-        auto groupRepo = std::make_shared<DAL::JsonStorage<BLL::Group>>("groups.json");
+        std::string socketPath;
+        std::string journalsDirectory;
+        std::string configPath = std::filesystem::exists("gradejournal.json") ? "gradejournal.json" : "";
+        std::string tracePath;
+        std::string capturePath;
+        std::vector<std::string> overrides;
+        bool profile = false;
+        bool printConfig = false;
+        bool allocationProfile = false;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--serve" && i + 1 < argc) {
+                socketPath = argv[++i];
+            } else if (arg == "--journals" && i + 1 < argc) {
+                journalsDirectory = argv[++i];
+            } else if (arg == "--config" && i + 1 < argc) {
+                configPath = argv[++i];
+            } else if (arg == "--set" && i + 1 < argc) {
+                overrides.push_back(argv[++i]);
+            } else if (arg == "--print-config") {
+                printConfig = true;
+            } else if (arg == "--profile") {
+                profile = true;
+            } else if (arg == "--alloc-profile") {
+                allocationProfile = true;
+            } else if (arg == "--trace" && i + 1 < argc) {
+                tracePath = argv[++i];
+            } else if (arg == "--capture" && i + 1 < argc) {
+                capturePath = argv[++i];
+            } else {
+                std::cerr << "Usage: GradeJournal [--config <file>] [--set <key.path>=<value>]...\n"
+                          << "                    [--journals <directory>] [--serve <socket-path>]\n"
+                          << "                    [--capture <file>] [--profile] [--alloc-profile] [--trace <file>]\n"
+                          << "                    [--print-config]" << std::endl;
+                return 1;
+            }
+        }
+        if (!capturePath.empty() && socketPath.empty()) {
+            std::cerr << "--capture records server requests and needs --serve" << std::endl;
+            return 1;
+        }
+
+        // The trace is written when the session goes out of scope; SIGUSR2
+        // pauses and resumes recording in between.
+        std::unique_ptr<Diagnostics::TraceSession> trace;
+        if (!tracePath.empty()) {
+            trace = std::make_unique<Diagnostics::TraceSession>(tracePath);
+#ifndef _WIN32
+            std::signal(SIGUSR2, ToggleTracing);
+#endif
+        }
+        std::optional<Diagnostics::TraceSpan> startup;
+        startup.emplace("startup");
+
+        PL::AppConfig config = PL::AppConfig::Load(configPath, overrides);
+        if (!journalsDirectory.empty()) {
+            config.journalsDirectory = journalsDirectory;
+        }
+        if (printConfig) {
+            std::cout << config.ToJson().dump(2) << std::endl;
+            return 0;
+        }
+
+        Diagnostics::MetricsRegistry::SetEnabled(config.metricsEnabled);
+        Diagnostics::MetricsRegistry::SetAllocationProfiling(allocationProfile);
+        if (allocationProfile && !Diagnostics::AllocationCounter::IsInstalled()) {
+            std::cerr << "--alloc-profile needs a build configured with -DGRADEJOURNAL_ALLOC_HOOKS=ON" << std::endl;
+        }
+        std::unique_ptr<Diagnostics::MetricsDumper> metricsDumper;
+        if (!config.metricsFile.empty()) {
+            metricsDumper = std::make_unique<Diagnostics::MetricsDumper>(
+                config.metricsFile, std::chrono::seconds(config.metricsIntervalSeconds));
+#ifndef _WIN32
+            std::signal(SIGUSR1, RequestMetricsDump);
+#endif
+        }
+
+        std::shared_ptr<PL::Profiler> profiler;
+        if (profile) {
+            profiler = std::make_shared<PL::Profiler>();
+        }
+
+        BLL::StorageProvider<BLL::Student> studentStorage = [profiler, config](const std::string& path) {
+            auto storage = DAL::StorageFactory<BLL::Student>::Create(config.students, path);
+            if (profiler) {
+                storage = std::make_shared<DAL::TimedStorage<BLL::Student>>(storage, profiler->GetStorageTimer());
+            }
+            return storage;
+        };
+        BLL::StorageProvider<BLL::Group> groupStorage = [profiler, config](const std::string& path) {
+            auto storage = DAL::StorageFactory<BLL::Group>::Create(config.groups, path);
+            if (profiler) {
+                storage = std::make_shared<DAL::TimedStorage<BLL::Group>>(storage, profiler->GetStorageTimer());
+            }
+            return storage;
+        };
+
+        auto pool = std::make_shared<BLL::ThreadPool>(config.threads);
+        std::shared_ptr<BLL::JournalSet> journals;
+        if (!config.journalsDirectory.empty()) {
+            journals = BLL::JournalSet::Open(config.journalsDirectory, studentStorage, groupStorage, pool);
+        } else {
+            journals = std::make_shared<BLL::JournalSet>(pool);
+            auto groups = std::make_shared<BLL::GroupService>(groupStorage("groups.json"));
+            journals->Add("default", std::make_shared<BLL::StudentService>(studentStorage("students.json"), groups));
+        }
+        for (const auto& name : journals->GetNames()) {
+            journals->Get(name)->students->SetNamePrefixIndexEnabled(config.namePrefixIndex);
+        }
+
+        startup.reset();
 
-        auto storage = DAL::StorageFactory<BLL::Student>::Create(
-            DAL::StorageType::WAL,
-            "students.json"
-        );
-        auto studentService = std::make_shared<BLL::StudentService>(storage);
-        auto groupService = std::make_shared<BLL::GroupService>(groupRepo);
+        if (!socketPath.empty()) {
+#ifndef _WIN32
+            PL::UnixSocketServer server(socketPath, journals);
+            server.SetBackupDirectory(!config.backupDirectory.empty()
+                ? config.backupDirectory
+                : (std::filesystem::path(config.journalsDirectory) / "backups").string());
+            std::shared_ptr<PL::WorkloadCaptureWriter> capture;
+            if (!capturePath.empty()) {
+                capture = std::make_shared<PL::WorkloadCaptureWriter>(capturePath);
+                server.SetCapture(capture);
+            }
+            activeServer = &server;
+            std::signal(SIGINT, StopServer);
+            std::signal(SIGTERM, StopServer);
+            std::cout << "Serving on " << socketPath << " (Ctrl+C to stop)" << std::endl;
+            server.Run();
+            activeServer = nullptr;
+            if (capture) {
+                capture->Flush();
+                std::cout << "Captured " << capture->Recorded() << " requests to " << capturePath << std::endl;
+            }
+            return 0;
+#else
+            std::cerr << "--serve is not supported on this platform" << std::endl;
+            return 1;
+#endif
+        }
 
-        PL::ConsoleInterface interface(studentService, groupService);
+        PL::ConsoleInterface interface(journals, profiler);
         interface.Run();
 
     } catch (const std::exception& e) {